@@ -0,0 +1,294 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmarks of the Bitmap blit primitives.
+ *
+ * Every case is run until it took at least --min-time ms and the time per
+ * destination pixel is reported. Timings depend on the host, so the
+ * baseline is written on the reference machine with --write-baseline and
+ * later runs are compared against it with --baseline. The exit code is 1
+ * when a case got slower than --threshold percent.
+ */
+
+// Headers
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bitmap.h"
+#include "color.h"
+#include "font.h"
+#include "rect.h"
+#include "text.h"
+#include "tone.h"
+
+namespace {
+	struct Options {
+		std::string baseline;
+		std::string write_baseline;
+		std::string filter;
+		double threshold = 20.0;
+		int min_time = 200;
+	};
+
+	struct Case {
+		std::string name;
+		/** Destination pixels touched by one run */
+		int64_t pixels;
+		std::function<void()> run;
+	};
+
+	struct Format {
+		const char* name;
+		DynamicFormat format;
+	};
+
+	/** Screen formats of the backends, 16 bit uses the fallback paths */
+	const Format formats[] = {
+		{ "abgr8888", DynamicFormat(32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000, PF::NoAlpha) },
+		{ "argb8888", DynamicFormat(32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000, PF::NoAlpha) },
+		{ "rgb565", DynamicFormat(16, 0xF800, 0x07E0, 0x001F, 0, PF::NoAlpha) }
+	};
+
+	/** Opaque picture with some structure so no path can shortcut it */
+	BitmapRef MakeOpaque(int width, int height) {
+		BitmapRef bitmap = Bitmap::Create(width, height, false);
+		for (int y = 0; y < height; y += 8) {
+			for (int x = 0; x < width; x += 8) {
+				bitmap->FillRect(Rect(x, y, 8, 8), Color((x * 7) & 0xFF, (y * 5) & 0xFF, (x + y) & 0xFF, 255));
+			}
+		}
+		return bitmap;
+	}
+
+	/** Sprite with transparent, translucent and opaque parts like a charset */
+	BitmapRef MakeSprite(int width, int height) {
+		BitmapRef bitmap = Bitmap::Create(width, height, true);
+		bitmap->Clear();
+		for (int y = 0; y < height; y += 4) {
+			for (int x = 0; x < width; x += 4) {
+				int alpha = ((x / 4 + y / 4) % 3) * 127;
+				if (alpha > 0) {
+					bitmap->FillRect(Rect(x, y, 4, 4), Color((x * 11) & 0xFF, (y * 3) & 0xFF, 128, alpha));
+				}
+			}
+		}
+		return bitmap;
+	}
+
+	std::vector<Case> MakeCases(const std::string& format) {
+		std::vector<Case> cases;
+
+		BitmapRef screen = Bitmap::Create(320, 240, false);
+		BitmapRef picture = MakeOpaque(320, 240);
+		BitmapRef tile = MakeOpaque(64, 64);
+		BitmapRef half = MakeOpaque(160, 120);
+		BitmapRef sprite = MakeSprite(48, 64);
+		BitmapRef battler = MakeSprite(96, 96);
+		BitmapRef mask = MakeSprite(320, 240);
+		const Tone tone(160, 96, 128, 64);
+		const Color flash(255, 255, 255, 128);
+		const std::string text = "The quick brown fox jumps over the lazy dog";
+		Rect text_rect = screen->GetFont()->GetSize(text);
+
+		auto add = [&](const std::string& name, int64_t pixels, std::function<void()> run) {
+			cases.push_back({ name + "/" + format, pixels, run });
+		};
+
+		add("Blit/opaque/320x240", 320 * 240, [=]() {
+			screen->Blit(0, 0, *picture, picture->GetRect(), Opacity::opaque);
+		});
+		add("Blit/opacity/320x240", 320 * 240, [=]() {
+			screen->Blit(0, 0, *picture, picture->GetRect(), 128);
+		});
+		add("Blit/sprite/48x64", 48 * 64, [=]() {
+			screen->Blit(100, 80, *sprite, sprite->GetRect(), Opacity::opaque);
+		});
+		add("BlitFast/320x240", 320 * 240, [=]() {
+			screen->BlitFast(0, 0, *picture, picture->GetRect(), Opacity::opaque);
+		});
+		add("TiledBlit/64x64/320x240", 320 * 240, [=]() {
+			screen->TiledBlit(-13, -7, tile->GetRect(), *tile, screen->GetRect(), Opacity::opaque);
+		});
+		add("StretchBlit/160x120/320x240", 320 * 240, [=]() {
+			screen->StretchBlit(screen->GetRect(), *half, half->GetRect(), Opacity::opaque);
+		});
+		add("ToneBlit/320x240", 320 * 240, [=]() {
+			screen->ToneBlit(0, 0, *picture, picture->GetRect(), tone, Opacity::opaque);
+		});
+		add("BlendBlit/sprite/48x64", 48 * 64, [=]() {
+			screen->BlendBlit(100, 80, *sprite, sprite->GetRect(), flash, Opacity::opaque);
+		});
+		add("WaverBlit/320x160", 320 * 160, [=]() {
+			screen->WaverBlit(0, 40, 1.0, 1.0, *picture, Rect(0, 0, 320, 160), 4, 30.0, Opacity::opaque);
+		});
+		add("EffectsBlit/zoom/96x96", 144 * 144, [=]() {
+			screen->EffectsBlit(160, 120, 48, 48, *battler, battler->GetRect(), Opacity::opaque, 1.5, 1.5, 0.0, 0, 0.0);
+		});
+		add("EffectsBlit/rotate/96x96", 144 * 144, [=]() {
+			screen->EffectsBlit(160, 120, 48, 48, *battler, battler->GetRect(), Opacity::opaque, 1.5, 1.5, 0.5, 0, 0.0);
+		});
+		add("EffectsBlit/waver/96x96", 144 * 144, [=]() {
+			screen->EffectsBlit(160, 120, 48, 48, *battler, battler->GetRect(), Opacity::opaque, 1.5, 1.5, 0.0, 4, 30.0);
+		});
+		add("MaskedBlit/color/320x240", 320 * 240, [=]() {
+			screen->MaskedBlit(screen->GetRect(), *mask, 0, 0, flash);
+		});
+		add("MaskedBlit/bitmap/320x240", 320 * 240, [=]() {
+			screen->MaskedBlit(screen->GetRect(), *mask, 0, 0, *picture, 0, 0);
+		});
+		add("Text::Draw/line", static_cast<int64_t>(text_rect.width) * text_rect.height, [=]() {
+			Text::Draw(*screen, 4, 100, Color(255, 255, 255, 255), text);
+		});
+
+		return cases;
+	}
+
+	/** @return ns per pixel */
+	double Measure(const Case& c, int min_time) {
+		typedef std::chrono::steady_clock clock;
+
+		// Warm up caches and lookup tables
+		c.run();
+
+		int64_t iterations = 0;
+		auto start = clock::now();
+		auto elapsed = clock::duration::zero();
+		do {
+			for (int i = 0; i < 16; ++i) {
+				c.run();
+			}
+			iterations += 16;
+			elapsed = clock::now() - start;
+		} while (elapsed < std::chrono::milliseconds(min_time));
+
+		double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		return ns / (static_cast<double>(iterations) * c.pixels);
+	}
+
+	std::map<std::string, double> ReadBaseline(const std::string& file) {
+		std::map<std::string, double> baseline;
+		std::ifstream in(file.c_str());
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.empty() || line[0] == '#') {
+				continue;
+			}
+			std::istringstream ss(line);
+			std::string name;
+			double value;
+			if (ss >> name >> value) {
+				baseline[name] = value;
+			}
+		}
+		return baseline;
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			bool has_value = i + 1 < argc;
+			if (arg == "--baseline" && has_value) {
+				options.baseline = argv[++i];
+			} else if (arg == "--write-baseline" && has_value) {
+				options.write_baseline = argv[++i];
+			} else if (arg == "--filter" && has_value) {
+				options.filter = argv[++i];
+			} else if (arg == "--threshold" && has_value) {
+				options.threshold = atof(argv[++i]);
+			} else if (arg == "--min-time" && has_value) {
+				options.min_time = atoi(argv[++i]);
+			} else {
+				printf("Usage: %s [--baseline FILE] [--write-baseline FILE] [--filter TEXT]\n"
+					"       [--threshold PERCENT] [--min-time MS]\n", argv[0]);
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+extern "C" int main(int argc, char* argv[]) {
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		return EXIT_FAILURE;
+	}
+
+	std::map<std::string, double> baseline;
+	if (!options.baseline.empty()) {
+		baseline = ReadBaseline(options.baseline);
+		if (baseline.empty()) {
+			printf("Baseline %s is missing or empty, create it with --write-baseline\n", options.baseline.c_str());
+		}
+	}
+
+	std::ostringstream results;
+	results << "# EasyRPG Player bitmap benchmark baseline\n# case ns/pixel\n";
+
+	int regressions = 0;
+	printf("%-44s %10s %10s %8s\n", "case", "ns/pixel", "baseline", "change");
+
+	for (const Format& format : formats) {
+		Bitmap::SetFormat(Bitmap::ChooseFormat(format.format));
+
+		for (const Case& c : MakeCases(format.name)) {
+			if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) {
+				continue;
+			}
+
+			double result = Measure(c, options.min_time);
+			results << c.name << " " << result << "\n";
+
+			auto it = baseline.find(c.name);
+			if (it == baseline.end() || it->second <= 0.0) {
+				printf("%-44s %10.3f %10s %8s\n", c.name.c_str(), result, "-", "-");
+				continue;
+			}
+
+			double change = (result / it->second - 1.0) * 100.0;
+			bool regression = change > options.threshold;
+			regressions += regression;
+			printf("%-44s %10.3f %10.3f %+7.1f%%%s\n", c.name.c_str(), result, it->second, change,
+				regression ? " SLOWER" : "");
+		}
+	}
+
+	if (!options.write_baseline.empty()) {
+		std::ofstream out(options.write_baseline.c_str());
+		out << results.str();
+		if (!out) {
+			printf("Could not write %s\n", options.write_baseline.c_str());
+			return EXIT_FAILURE;
+		}
+		printf("Baseline written to %s\n", options.write_baseline.c_str());
+	}
+
+	if (regressions > 0) {
+		printf("%d case(s) are more than %.0f%% slower than the baseline\n", regressions, options.threshold);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -132,6 +132,11 @@ void CtrUi::Sleep(uint32_t time) {
 	svcSleepThread(nsecs);
 }
 
+uint64_t CtrUi::GetTicksMicro() const {
+	double ticks = u64_to_double(svcGetSystemTick());
+	return (u64)(ticks/(TICKS_PER_MSEC/1000.0));
+}
+
 uint32_t CtrUi::GetTicks() const {
 	double ticks = u64_to_double(svcGetSystemTick());
 	u64 usecs = (u64)(ticks/TICKS_PER_MSEC);
@@ -66,6 +66,7 @@ public:
 	bool IsFullscreen();
 
 	uint32_t GetTicks() const;
+	uint64_t GetTicksMicro() const;
 	void Sleep(uint32_t time_milli);
 #ifdef SUPPORT_AUDIO
 	AudioInterface& GetAudio();
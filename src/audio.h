@@ -19,6 +19,7 @@
 #define _EASYRPG_PLAYER_AUDIO_H_
 
 // Headers
+#include <cstddef>
 #include <string>
 
 /**
@@ -65,6 +66,24 @@ struct AudioInterface {
 	 */
 	virtual unsigned BGM_GetTicks() const = 0;
 
+	/**
+	 * Returns the playback position of the background music.
+	 * The value is only meaningful for BGM_Seek on the same file.
+	 * Not supported by all audio backends.
+	 *
+	 * @return position or -1 when unsupported
+	 */
+	virtual size_t BGM_Tell() const { return -1; }
+
+	/**
+	 * Continues the background music at a position returned by BGM_Tell.
+	 * Not supported by all audio backends.
+	 *
+	 * @param position position to seek to.
+	 * @return true when successful
+	 */
+	virtual bool BGM_Seek(size_t /* position */) { return false; }
+
 	/**
 	 * Does a fade out of the background music.
 	 *
@@ -19,12 +19,16 @@
 
 #ifdef HAVE_OPENAL
 
-#include <array>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <deque>
 #include <cassert>
 #include <functional>
 
 #include "audio_al.h"
+#include "audio_stats.h"
 #include "filefinder.h"
 #include "output.h"
 #include "sndfile.h"
@@ -131,26 +135,61 @@ namespace {
 	set_context const c_##__LINE__(ctx); \
 	(void) c_##__LINE__;
 
-	enum { BUFFER_NUMBER = 3 };
+	/** Number of buffers a source starts with. */
+	enum { MIN_BUFFER_NUMBER = 4 };
 
-	double const SECOND_PER_BUFFER = 0.5;
+	/** Upper limit of the buffer count after underruns. */
+	enum { MAX_BUFFER_NUMBER = 16 };
+
+	/** Default latency target in milliseconds. */
+	unsigned const DEFAULT_LATENCY_MS = 250;
+
+	/** Seconds without underrun before the buffer count shrinks again. */
+	double const RELAX_SECONDS = 30.0;
+
+	/**
+	 * Reads the latency target from EASYRPG_AUDIO_LATENCY.
+	 *
+	 * @return latency target in milliseconds
+	 */
+	unsigned latency_from_env() {
+		char const *const env = getenv("EASYRPG_AUDIO_LATENCY");
+		if (!env) {
+			return DEFAULT_LATENCY_MS;
+		}
+
+		int const ms = atoi(env);
+		if (ms < 20 || ms > 5000) {
+			Output::Warning("Ignoring invalid audio latency %s.", env);
+			return DEFAULT_LATENCY_MS;
+		}
+		return ms;
+	}
 }
 
 struct ALAudio::buffer_loader {
 	virtual ~buffer_loader() {
 	}
 
-	virtual size_t load_buffer(ALuint buffer) = 0;
+	/**
+	 * Fills an OpenAL buffer with the next part of the stream.
+	 *
+	 * @param buffer OpenAL buffer name
+	 * @param seconds length of audio to load
+	 * @return number of frames loaded
+	 */
+	virtual size_t load_buffer(ALuint buffer, double seconds) = 0;
 	virtual bool is_end() const = 0;
 	virtual unsigned midi_ticks() const {
 		return 0;
 	}
 
-	unsigned loop_count_ = 0;
+	/** Read by the main thread while the refill thread decodes */
+	std::atomic<unsigned> loop_count_{0};
 };
 
 struct ALAudio::source {
-	source(std::shared_ptr<ALCcontext> const &c, ALuint const s, bool loop)
+	source(std::shared_ptr<ALCcontext> const &c, ALuint const s, bool loop, unsigned latency_ms)
 	    : ctx_(c)
 	    , src_(s)
 	    , fade_count_(0)
@@ -158,12 +197,14 @@ struct ALAudio::source {
 	    , volume_(1.0f)
 	    , is_fade_in_(false)
 	    , loop_play_(loop)
-	    , ticks_(BUFFER_NUMBER + 1, 0)
-	    , buf_sizes_(BUFFER_NUMBER, 0) {
+	    , playing_(false)
+	    , buffer_seconds_(latency_ms / (1000.0 * MIN_BUFFER_NUMBER))
+	    , buffer_count_(MIN_BUFFER_NUMBER)
+	    , relax_seconds_(0.0)
+	    , last_tick_(0)
+	    , xruns_(0) {
 		SET_CONTEXT(c);
 		assert(alIsSource(s) == AL_TRUE);
-
-		alGenBuffers(BUFFER_NUMBER, buffers_.data());
 	}
 
 	void init_midi() {
@@ -191,24 +232,68 @@ struct ALAudio::source {
 
 	~source() {
 		SET_CONTEXT(ctx_);
-		alSourcePlay(src_);
+		alSourceStop(src_);
+		alSourcei(src_, AL_BUFFER, AL_NONE);
 		alDeleteSources(1, &src_);
+		if (!buffers_.empty()) {
+			alDeleteBuffers(buffers_.size(), buffers_.data());
+		}
 	}
 
 	int loop_count() {
-		return loader_->loop_count_;
+		return loader_ ? int(loader_->loop_count_.load()) : 0;
 	}
 
 	ALuint get() {
 		return src_;
 	}
 
+	/**
+	 * @return number of underruns since the source was created
+	 */
+	unsigned xrun_count() const {
+		return xruns_;
+	}
+
+	/**
+	 * @return true when the stream ended and everything was played
+	 */
+	bool finished() const {
+		if (loader_) {
+			return false;
+		}
+
+		ALenum state = AL_INVALID_VALUE;
+		alGetSourcei(src_, AL_SOURCE_STATE, &state);
+		return state == AL_STOPPED;
+	}
+
 	std::shared_ptr<fluid_settings_t> settings;
 	std::shared_ptr<fluid_synth_t> synth;
 	std::shared_ptr<fluid_player_t> player;
 	std::shared_ptr<fluid_sequencer_t> seq;
 	unsigned sample_rate;
 
+private:
+	/** Buffer in the source queue. */
+	struct queued_buffer {
+		ALuint id;
+		size_t size;
+		unsigned begin_tick, end_tick;
+	};
+
+public:
+	/** Buffers decoded by the refill thread without holding the lock */
+	struct refill_job {
+		std::shared_ptr<buffer_loader> loader;
+		/** Free buffers to decode into */
+		std::vector<ALuint> free;
+		std::vector<queued_buffer> decoded;
+		unsigned last_tick;
+		bool xrun;
+		bool ended;
+	};
+
 private:
 	std::shared_ptr<ALCcontext> ctx_;
 	ALuint src_;
@@ -216,9 +301,15 @@ private:
 	ALfloat volume_;
 	bool is_fade_in_;
 	bool loop_play_;
-	std::array<ALuint, BUFFER_NUMBER> buffers_;
+	bool playing_;
+	double const buffer_seconds_;
+	int buffer_count_;
+	double relax_seconds_;
+	unsigned last_tick_;
+	unsigned xruns_;
+	std::vector<ALuint> buffers_, free_buffers_;
 	std::shared_ptr<buffer_loader> loader_;
-	std::deque<unsigned> ticks_, buf_sizes_;
+	std::deque<queued_buffer> queue_;
 
 	unsigned progress_milli() const {
 		return (1000 * fade_count_ / 60);
@@ -234,6 +325,48 @@ private:
 		                 volume_;
 	}
 
+	ALuint take_buffer() {
+		if (free_buffers_.empty()) {
+			ALuint buf = AL_NONE;
+			alGenBuffers(1, &buf);
+			buffers_.push_back(buf);
+			return buf;
+		}
+
+		ALuint const buf = free_buffers_.back();
+		free_buffers_.pop_back();
+		return buf;
+	}
+
+	void unqueue_all() {
+		alSourceStop(src_);
+		alSourcei(src_, AL_BUFFER, AL_NONE);
+		for (queued_buffer const &b : queue_) {
+			free_buffers_.push_back(b.id);
+		}
+		queue_.clear();
+	}
+
+	/**
+	 * Loads and queues buffers until the queue holds buffer_count_ buffers.
+	 */
+	void fill_queue() {
+		while (loader_ && int(queue_.size()) < buffer_count_) {
+			if (!loop_play_ && loader_->is_end()) {
+				loader_.reset();
+				break;
+			}
+
+			queued_buffer b;
+			b.id = take_buffer();
+			b.begin_tick = loader_->is_end() ? 0 : last_tick_;
+			b.size = loader_->load_buffer(b.id, buffer_seconds_);
+			b.end_tick = last_tick_ = loader_->midi_ticks();
+			alSourceQueueBuffers(src_, 1, &b.id);
+			queue_.push_back(b);
+		}
+	}
+
 public:
 	void set_volume(ALfloat const vol) {
 		SET_CONTEXT(ctx_);
@@ -253,30 +386,136 @@ public:
 		is_fade_in_ = true;
 	}
 
-	void update() {
-		ALint processed;
-		alGetSourceiv(src_, AL_BUFFERS_PROCESSED, &processed);
-		std::vector<ALuint> unqueued(processed);
-		alSourceUnqueueBuffers(src_, processed, &unqueued.front());
-		int queuing_count = 0;
-		for (; queuing_count < processed; ++queuing_count) {
-			if (!loop_play_ && loader_->is_end()) {
-				loader_.reset();
-				++queuing_count;
+	void stop() {
+		playing_ = false;
+		alSourceStop(src_);
+	}
+
+	void pause() {
+		playing_ = false;
+		alSourcePause(src_);
+	}
+
+	void resume() {
+		playing_ = true;
+		alSourcePlay(src_);
+	}
+
+	/**
+	 * Called by the refill thread with the lock held: Recycles played
+	 * buffers, restarts the source after an underrun and takes the
+	 * buffers that need to be loaded.
+	 *
+	 * @param job filled with the buffers to decode
+	 * @return whether decode and end_refill must be called
+	 */
+	bool begin_refill(refill_job &job) {
+		if (!playing_) {
+			return false;
+		}
+
+		ALint processed = 0;
+		alGetSourcei(src_, AL_BUFFERS_PROCESSED, &processed);
+		for (; processed > 0 && !queue_.empty(); --processed) {
+			ALuint buf = queue_.front().id;
+			alSourceUnqueueBuffers(src_, 1, &buf);
+			free_buffers_.push_back(buf);
+			queue_.pop_front();
+			relax_seconds_ += buffer_seconds_;
+		}
+
+		ALenum state = AL_INVALID_VALUE;
+		alGetSourcei(src_, AL_SOURCE_STATE, &state);
+		bool const xrun = state == AL_STOPPED && loader_;
+
+		if (xrun) {
+			++xruns_;
+			AudioStats::AddUnderrun();
+			relax_seconds_ = 0.0;
+			if (buffer_count_ < MAX_BUFFER_NUMBER) {
+				++buffer_count_;
+			}
+			Output::Debug("Audio underrun (%u), using %d buffers", xruns_, buffer_count_);
+		} else if (relax_seconds_ > RELAX_SECONDS) {
+			relax_seconds_ = 0.0;
+			if (buffer_count_ > MIN_BUFFER_NUMBER) {
+				--buffer_count_;
+			}
+		}
+
+		if (!loader_ || int(queue_.size()) >= buffer_count_) {
+			if (xrun && !queue_.empty()) {
+				alSourcePlay(src_);
+			}
+			return false;
+		}
+
+		job.loader = loader_;
+		job.free.clear();
+		job.decoded.clear();
+		for (int i = int(queue_.size()); i < buffer_count_; ++i) {
+			job.free.push_back(take_buffer());
+		}
+		job.last_tick = last_tick_;
+		job.xrun = xrun;
+		job.ended = false;
+		return true;
+	}
+
+	/**
+	 * Called by the refill thread without the lock: Loads the buffers
+	 * taken by begin_refill. Only touches the job and its loader.
+	 */
+	void decode(refill_job &job) const {
+		for (ALuint id : job.free) {
+			if (!loop_play_ && job.loader->is_end()) {
+				job.ended = true;
 				break;
 			}
 
-			if (loader_->is_end()) {
-				ticks_.pop_front();
-				ticks_.push_back(0);
+			queued_buffer b;
+			b.id = id;
+			b.begin_tick = job.loader->is_end() ? 0 : job.last_tick;
+			b.size = job.loader->load_buffer(b.id, buffer_seconds_);
+			b.end_tick = job.last_tick = job.loader->midi_ticks();
+			job.decoded.push_back(b);
+		}
+	}
+
+	/**
+	 * Called by the refill thread with the lock held: Queues the decoded
+	 * buffers unless the stream was replaced in the meantime.
+	 */
+	void end_refill(refill_job &job) {
+		for (size_t i = job.decoded.size(); i < job.free.size(); ++i) {
+			free_buffers_.push_back(job.free[i]);
+		}
+
+		if (job.loader != loader_) {
+			for (queued_buffer const &b : job.decoded) {
+				free_buffers_.push_back(b.id);
 			}
-			buf_sizes_.pop_front();
-			buf_sizes_.push_back(loader_->load_buffer(unqueued[queuing_count]));
-			ticks_.pop_front();
-			ticks_.push_back(loader_->midi_ticks());
+			return;
 		}
-		alSourceQueueBuffers(src_, queuing_count, &unqueued.front());
 
+		for (queued_buffer const &b : job.decoded) {
+			alSourceQueueBuffers(src_, 1, &b.id);
+			queue_.push_back(b);
+		}
+		last_tick_ = job.last_tick;
+		if (job.ended) {
+			loader_.reset();
+		}
+
+		if (job.xrun && playing_ && !queue_.empty()) {
+			alSourcePlay(src_);
+		}
+	}
+
+	/**
+	 * Called once per frame: Advances fades.
+	 */
+	void update() {
 		if (fade_milli_ != 0) {
 			SET_CONTEXT(ctx_);
 			fade_count_++;
@@ -284,7 +523,7 @@ public:
 			if (fade_ended()) {
 				fade_milli_ = 0;
 				if (!is_fade_in_)
-					alSourceStop(src_);
+					stop();
 			} else {
 				alSourcef(src_, AL_GAIN, current_volume());
 			}
@@ -293,45 +532,33 @@ public:
 
 	void set_buffer_loader(std::shared_ptr<buffer_loader> const &l) {
 		SET_CONTEXT(ctx_);
-		alSourceStop(src_);
-		alSourcei(src_, AL_BUFFER, AL_NONE);
+		unqueue_all();
 
+		loader_ = l;
+		playing_ = bool(l);
 		if (!l) {
-			loader_.reset();
 			return;
 		}
 
-		ALint unqueuing_count;
-		alGetSourceiv(src_, AL_BUFFERS_QUEUED, &unqueuing_count);
-		std::vector<ALuint> unqueued(unqueuing_count);
-		alSourceUnqueueBuffers(src_, unqueuing_count, &unqueued.front());
-
-		loader_ = l;
-		int queuing_count = 0;
 		assert(!l->is_end());
-		ticks_[0] = 0;
-		for (; queuing_count < BUFFER_NUMBER; ++queuing_count) {
-			buf_sizes_[queuing_count] = loader_->load_buffer(buffers_[queuing_count]);
-			ticks_[queuing_count + 1] = loader_->midi_ticks();
-
-			if (loader_->is_end()) {
-				queuing_count++;
-				break;
-			}
-		}
-		alSourceQueueBuffers(src_, queuing_count, buffers_.data());
+		last_tick_ = 0;
+		fill_queue();
 		alSourcePlay(src_);
 	}
 
 	unsigned midi_ticks() const {
-		if (!loader_) {
+		if (!loader_ || queue_.empty()) {
 			return 0;
 		}
 
 		ALint offset;
-		alGetSourceiv(src_, AL_SAMPLE_OFFSET, &offset);
+		alGetSourcei(src_, AL_SAMPLE_OFFSET, &offset);
 
-		return ticks_[0] + (ticks_[1] - ticks_[0]) * offset / buf_sizes_[0];
+		queued_buffer const &b = queue_.front();
+		if (b.size == 0) {
+			return b.begin_tick;
+		}
+		return b.begin_tick + (b.end_tick - b.begin_tick) * std::min<size_t>(offset, b.size) / b.size;
 	}
 };
 
@@ -356,7 +583,7 @@ struct ALAudio::sndfile_loader : public ALAudio::buffer_loader {
 		assert(format_ != AL_INVALID_VALUE);
 	}
 
-	size_t load_buffer(ALuint buf) {
+	size_t load_buffer(ALuint buf, double seconds) {
 		// seek to beginning if in a end
 		if (is_end()) {
 			if (info_.seekable) {
@@ -375,10 +602,10 @@ struct ALAudio::sndfile_loader : public ALAudio::buffer_loader {
 			seek_pos_ = 0;
 		}
 
-		data_.resize(info_.channels * info_.samplerate * SECOND_PER_BUFFER);
+		data_.resize(info_.channels * size_t(info_.samplerate * seconds));
 		sf_count_t const read_size =
 		    sf_readf_short(file_.get(), &data_.front(), data_.size() / info_.channels);
-		alBufferData(buf, format_, &data_.front(), sizeof(int16_t) * data_.size(),
+		alBufferData(buf, format_, &data_.front(), sizeof(int16_t) * read_size * info_.channels,
 		             info_.samplerate);
 		seek_pos_ += read_size;
 		return read_size;
@@ -412,7 +639,7 @@ struct ALAudio::midi_loader : public ALAudio::buffer_loader {
 		return fluid_player_get_status(source_.player.get()) != FLUID_PLAYER_PLAYING;
 	}
 
-	size_t load_buffer(ALuint buf) {
+	size_t load_buffer(ALuint buf, double seconds) {
 		if (is_end()) {
 			source_.seq.reset(new_fluid_sequencer2(false), &delete_fluid_sequencer);
 			if (fluid_sequencer_register_fluidsynth(source_.seq.get(), source_.synth.get()) == FLUID_FAILED)
@@ -424,7 +651,7 @@ struct ALAudio::midi_loader : public ALAudio::buffer_loader {
 			loop_count_++;
 		}
 
-		data_.resize(2 * source_.sample_rate * SECOND_PER_BUFFER);
+		data_.resize(2 * size_t(source_.sample_rate * seconds));
 		if (fluid_synth_write_s16(source_.synth.get(), data_.size() / 2, &data_.front(), 0, 2,
 		                          &data_.front(), 1, 2) == FLUID_FAILED) {
 			Output::Error("Fluidsynth error: %s", fluid_synth_error(source_.synth.get()));
@@ -469,20 +696,74 @@ ALAudio::getSound(source &src, std::string const &file) const {
 }
 
 void ALAudio::Update() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	SET_CONTEXT(ctx_);
+
 	bgm_src_->update();
 
-	for (source_list::iterator i = se_src_.begin(); i < se_src_.end(); ++i) {
+	for (source_list::iterator i = se_src_.begin(); i != se_src_.end();) {
 		i->get()->update();
 
-		ALenum state = AL_INVALID_VALUE;
-		alGetSourcei(i->get()->get(), AL_SOURCE_STATE, &state);
-		if (state == AL_STOPPED) {
+		if (i->get()->finished()) {
+			se_xruns_ += i->get()->xrun_count();
 			i = se_src_.erase(i);
+		} else {
+			++i;
 		}
 	}
 }
 
-ALAudio::ALAudio(char const *const dev_name) {
+void ALAudio::refill_thread() {
+	// Wake up twice per buffer so a buffer is never played out before
+	// its successor is queued.
+	std::chrono::milliseconds const interval(std::max(5u, latency_ms_ / (2 * MIN_BUFFER_NUMBER)));
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	source_list sources;
+	while (!quit_) {
+		// The list can change while decoding, the copy keeps the sources alive
+		sources = se_src_;
+		sources.push_back(bgm_src_);
+		lock.unlock();
+
+		{
+			// Keeps BGM_Play from replacing a loader while it is decoded
+			std::lock_guard<std::mutex> decode_lock(decode_mutex_);
+			SET_CONTEXT(ctx_);
+			AudioStats::Scope timer(AudioStats::Section_Callback);
+			for (std::shared_ptr<source> const &src : sources) {
+				refill_source(*src);
+			}
+		}
+
+		lock.lock();
+		sources.clear();
+		if (!quit_) {
+			refill_cond_.wait_for(lock, interval);
+		}
+	}
+}
+
+void ALAudio::refill_source(source &src) {
+	source::refill_job job;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!src.begin_refill(job)) {
+			return;
+		}
+	}
+
+	// Decoding takes a while, the main thread must not wait for it
+	src.decode(job);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	src.end_refill(job);
+}
+
+ALAudio::ALAudio(char const *const dev_name) :
+	latency_ms_(latency_from_env()),
+	se_xruns_(0),
+	quit_(false) {
 	dev_.reset(alcOpenDevice(dev_name), &alcCloseDevice);
 	assert(dev_);
 
@@ -498,6 +779,34 @@ ALAudio::ALAudio(char const *const dev_name) {
 	if (!getenv("DEFAULT_SOUNDFONT")) {
 		Output::Error("Default sound font not found.");
 	}
+
+	Output::Debug("OpenAL latency target: %u ms", latency_ms_);
+	refill_thread_ = std::thread(&ALAudio::refill_thread, this);
+}
+
+ALAudio::~ALAudio() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	refill_cond_.notify_one();
+	refill_thread_.join();
+
+	if (GetUnderrunCount() > 0) {
+		Output::Debug("OpenAL underruns: %u", GetUnderrunCount());
+	}
+
+	se_src_.clear();
+	bgm_src_.reset();
+}
+
+unsigned ALAudio::GetUnderrunCount() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	unsigned count = bgm_src_->xrun_count() + se_xruns_;
+	for (std::shared_ptr<source> const &src : se_src_) {
+		count += src->xrun_count();
+	}
+	return count;
 }
 
 std::shared_ptr<ALAudio::source> ALAudio::create_source(bool loop) const {
@@ -508,10 +817,12 @@ std::shared_ptr<ALAudio::source> ALAudio::create_source(bool loop) const {
 	print_al_error();
 	assert(ret != AL_NONE);
 
-	return std::make_shared<source>(ctx_, ret, loop);
+	return std::make_shared<source>(ctx_, ret, loop, latency_ms_);
 }
 
 void ALAudio::BGM_Play(std::string const &file, int volume, int pitch, int fadein) {
+	std::lock_guard<std::mutex> decode_lock(decode_mutex_);
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 
 	alSourcef(bgm_src_->get(), AL_PITCH, pitch * 0.01f);
@@ -521,16 +832,19 @@ void ALAudio::BGM_Play(std::string const &file, int volume, int pitch, int fadei
 }
 
 void ALAudio::BGM_Stop() {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
-	alSourceStop(bgm_src_->get());
+	bgm_src_->stop();
 }
 
 bool ALAudio::BGM_PlayedOnce() const {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 	return bgm_src_->loop_count() > 0;
 }
 
 bool ALAudio::BGM_IsPlaying() const {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 
 	ALenum state;
@@ -540,36 +854,43 @@ bool ALAudio::BGM_IsPlaying() const {
 }
 
 unsigned ALAudio::BGM_GetTicks() const {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 	return bgm_src_->midi_ticks();
 }
 
 void ALAudio::BGM_Fade(int fade) {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 	bgm_src_->fade_out(fade);
 }
 
 void ALAudio::BGM_Pause() {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
-	alSourcePause(bgm_src_->get());
+	bgm_src_->pause();
 }
 
 void ALAudio::BGM_Resume() {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
-	alSourcePlay(bgm_src_->get());
+	bgm_src_->resume();
 }
 
 void ALAudio::BGM_Volume(int volume) {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 	bgm_src_->set_volume(volume * 0.01f);
 }
 
 void ALAudio::BGM_Pitch(int pitch) {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 	alSourcef(bgm_src_->get(), AL_PITCH, pitch * 0.01f);
 }
 
 void ALAudio::SE_Play(std::string const &file, int volume, int pitch) {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
 
 	std::shared_ptr<source> src = create_source(false);
@@ -582,9 +903,10 @@ void ALAudio::SE_Play(std::string const &file, int volume, int pitch) {
 }
 
 void ALAudio::SE_Stop() {
+	std::lock_guard<std::mutex> lock(mutex_);
 	SET_CONTEXT(ctx_);
-	for (source_list::iterator i = se_src_.begin(); i < se_src_.end(); ++i) {
-		alSourceStop(i->get()->get());
+	for (std::shared_ptr<source> const &src : se_src_) {
+		se_xruns_ += src->xrun_count();
 	}
 	se_src_.clear();
 }
@@ -30,11 +30,22 @@
 #include "system.h"
 #include "audio.h"
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+/**
+ * OpenAL audio backend.
+ * Sources are streamed through a queue of small buffers that a worker
+ * thread keeps filled, so decoding does not depend on the frame rate.
+ * The queue length is set by the EASYRPG_AUDIO_LATENCY environment
+ * variable (milliseconds) and grows when the queue runs dry.
+ */
 struct ALAudio : public AudioInterface {
 	ALAudio(char const *dev_name = NULL);
+	~ALAudio() override;
 
 	void BGM_Play(std::string const &, int, int, int) override;
 	void BGM_Pause() override;
@@ -50,6 +61,11 @@ struct ALAudio : public AudioInterface {
 	void SE_Stop() override;
 	void Update() override;
 
+	/**
+	 * @return number of times a source ran out of queued audio
+	 */
+	unsigned GetUnderrunCount() const;
+
 	static char const WAVE_OUTPUT_DEVICE[];
 	static char const NULL_DEVICE[];
 
@@ -65,6 +81,9 @@ private:
 	std::shared_ptr<buffer_loader> getMusic(source &src, std::string const &file) const;
 	std::shared_ptr<buffer_loader> getSound(source &src, std::string const &file) const;
 
+	void refill_thread();
+	void refill_source(source &src);
+
 	std::shared_ptr<ALCdevice> dev_;
 	std::shared_ptr<ALCcontext> ctx_;
 
@@ -72,6 +91,16 @@ private:
 
 	typedef std::vector<std::shared_ptr<source> > source_list;
 	source_list se_src_;
+
+	unsigned const latency_ms_;
+	unsigned se_xruns_;
+
+	mutable std::mutex mutex_;
+	/** Held while a loader decodes, locked before mutex_ */
+	std::mutex decode_mutex_;
+	std::condition_variable refill_cond_;
+	std::thread refill_thread_;
+	bool quit_;
 };  // struct ALAudio
 
 #endif  // _AUDIO_AL_H_
@@ -19,6 +19,7 @@
 #include <cassert>
 #include <cstring>
 #include "audio_decoder.h"
+#include "audio_stats.h"
 #include "filefinder.h"
 #include "output.h"
 #include "system.h"
@@ -42,38 +43,58 @@ void AudioDecoder::Resume() {
 }
 
 int AudioDecoder::Decode(uint8_t* buffer, int length) {
-	return Decode(buffer, length, 0);
-}
-
-int AudioDecoder::Decode(uint8_t* buffer, int length, int recursion_depth) {
 	if (paused) {
 		memset(buffer, '\0', length);
 		return length;
 	}
 
-	int res = FillBuffer(buffer, length);
-
-	if (res < 0) {
-		memset(buffer, '\0', length);
-	} else if (res < length) {
-		memset(&buffer[res], '\0', length - res);
+	if (stats_section < 0) {
+		stats_section = AudioStats::SectionForType(music_type);
 	}
+	AudioStats::Scope timer((AudioStats::Section)stats_section);
+
+	int res = 0;
+	int empty_reads = 0;
+
+	// When the stream ends in the middle of the buffer and looping is enabled
+	// the stream is rewound and the remaining space is filled from the
+	// beginning, this way the loop is gapless.
+	for (;;) {
+		int read = FillBuffer(&buffer[res], length - res);
+
+		if (read < 0) {
+			if (res == 0) {
+				memset(buffer, '\0', length);
+				return -1;
+			}
+			break;
+		}
+
+		res += read;
+
+		if (!IsFinished() || !looping) {
+			break;
+		}
+
+		// A stream that ends without providing data is broken
+		if (read == 0 && ++empty_reads == 10) {
+			if (loop_count < 50) {
+				// Only report this a few times in the hope that this is only a temporary problem and to prevent log spamming
+				Output::Debug("Audio Decoder: Stream ended without data. Probably stream error.");
+			}
+			break;
+		}
 
-	if (IsFinished() && looping && recursion_depth < 10) {
 		++loop_count;
 		Rewind();
-		if (length - res > 0) {
-			int res2 = Decode(&buffer[res], length - res, ++recursion_depth);
-			if (res2 <= 0) {
-				return res;
-			}
-			return res + res2;
+
+		if (res == length) {
+			break;
 		}
 	}
 
-	if (recursion_depth == 10 && loop_count < 50) {
-		// Only report this a few times in the hope that this is only a temporary problem and to prevent log spamming
-		Output::Debug("Audio Decoder: Recursion depth exceeded. Probably stream error.");
+	if (res < length) {
+		memset(&buffer[res], '\0', length - res);
 	}
 
 	return res;
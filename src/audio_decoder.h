@@ -259,6 +259,9 @@ public:
 	 * Seeks in the audio stream. The value of offset is implementation
 	 * defined but is guaranteed to match the result of Tell.
 	 * Only Rewinding is guaranteed to work.
+	 * The WAV, OGG and MP3 decoders use sample frames, the MIDI decoders
+	 * use milliseconds. For Origin::End the offset is counted backwards
+	 * from the end of the stream.
 	 *
 	 * @param offset Offset to seek to
 	 * @param origin Position to seek from
@@ -268,9 +271,9 @@ public:
 
 	/**
 	 * Tells the current stream position. The value is implementation
-	 * defined.
+	 * defined (see Seek).
 	 *
-	 * @return Position in the stream
+	 * @return Position in the stream or -1 when unsupported
 	 */
 	virtual size_t Tell() const;
 
@@ -300,6 +303,9 @@ protected:
 
 	std::string error_message;
 	std::string music_type;
+
+	/** Section of AudioStats the decode time is added to, -1 for the default of the music type */
+	int stats_section = -1;
 private:
 	bool paused = false;
 	double volume = 0;
@@ -310,8 +316,6 @@ private:
 	bool looping = false;
 	int loop_count = 0;
 
-	int Decode(uint8_t* buffer, int size, int recursion_depth);
-
 	std::vector<uint8_t> mono_buffer;
 };
 
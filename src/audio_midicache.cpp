@@ -0,0 +1,487 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system.h"
+
+#if defined(HAVE_SDL_MIXER) && defined(WANT_FMMIDI)
+
+// Headers
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <set>
+#include <vector>
+#include <zlib.h>
+#include <SDL.h>
+#include "audio_midicache.h"
+#include "audio_resampler.h"
+#include "decoder_fmmidi.h"
+#include "filefinder.h"
+#include "main_data.h"
+#include "utils.h"
+
+namespace {
+	/*
+	 * Cache file layout (little endian):
+	 * Header: "EPCM", version, frequency, channels (4 bytes each)
+	 * Chunks: frame count, compressed size, zlib compressed data
+	 * The samples of a chunk are signed 16 bit interleaved stereo, stored as
+	 * the difference to the previous sample of the same channel.
+	 */
+	const char cache_magic[] = { 'E', 'P', 'C', 'M' };
+	const uint32_t cache_version = 1;
+	const int cache_channels = 2;
+	const long cache_header_size = 16;
+	const uint32_t chunk_frames = 32768;
+
+	// Songs longer than this are not cached (probably broken files)
+	const int max_render_seconds = 30 * 60;
+
+	void WriteU32(FILE* file, uint32_t value) {
+		if (Utils::IsBigEndian()) {
+			Utils::SwapByteOrder(value);
+		}
+		fwrite(&value, sizeof(value), 1, file);
+	}
+
+	bool ReadU32(FILE* file, uint32_t& value) {
+		if (fread(&value, sizeof(value), 1, file) != 1) {
+			return false;
+		}
+		if (Utils::IsBigEndian()) {
+			Utils::SwapByteOrder(value);
+		}
+		return true;
+	}
+
+	/** FNV-1a hash of the whole file, the file is rewound afterwards */
+	uint64_t HashFile(FILE* file) {
+		uint64_t hash = 14695981039346656037ULL;
+		uint8_t buffer[4096];
+		size_t read;
+
+		fseek(file, 0, SEEK_SET);
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			for (size_t i = 0; i < read; ++i) {
+				hash ^= buffer[i];
+				hash *= 1099511628211ULL;
+			}
+		}
+		fseek(file, 0, SEEK_SET);
+
+		return hash;
+	}
+
+	std::string GetCacheFilename(uint64_t hash, int frequency) {
+		char name[64];
+		sprintf(name, "fmmidi_v%u_%08x%08x_%d.pcm", (unsigned)cache_version,
+			(unsigned)(hash >> 32), (unsigned)(hash & 0xFFFFFFFF), frequency);
+		return FileFinder::MakePath(Main_Data::GetCachePath(), name);
+	}
+
+	/**
+	 * Decoder streaming a rendered MIDI from the cache directory.
+	 */
+	class MidiCacheDecoder : public AudioDecoder {
+	public:
+		MidiCacheDecoder(const std::string& cache_filename) :
+			cache_filename(cache_filename) {
+			music_type = "midi";
+		}
+
+		~MidiCacheDecoder() {
+			if (file) {
+				fclose(file);
+			}
+			if (cache) {
+				fclose(cache);
+			}
+		}
+
+		bool Open(FILE* file) override {
+			// Only kept to fulfill the ownership contract of Open
+			this->file = file;
+
+			cache = FileFinder::fopenUTF8(cache_filename, "rb");
+			if (!cache) {
+				error_message = "MIDI cache: Couldn't open " + cache_filename;
+				return false;
+			}
+
+			char magic[4];
+			uint32_t version, freq, channels;
+			if (fread(magic, 4, 1, cache) != 1 || memcmp(magic, cache_magic, 4) != 0 ||
+				!ReadU32(cache, version) || version != cache_version ||
+				!ReadU32(cache, freq) || !ReadU32(cache, channels) || channels != (uint32_t)cache_channels) {
+				error_message = "MIDI cache: Bad header in " + cache_filename;
+				return false;
+			}
+			frequency = (int)freq;
+
+			return true;
+		}
+
+		bool Seek(size_t offset, Origin origin) override {
+			// Offset is in milliseconds like in the FmMidi decoder
+			size_t target = (size_t)((uint64_t)offset * frequency / 1000);
+			if (origin == Origin::Current) {
+				target += Frame();
+			} else if (origin == Origin::End) {
+				// Length is unknown without reading all chunks
+				return false;
+			}
+
+			fseek(cache, cache_header_size, SEEK_SET);
+			samples.clear();
+			sample_pos = 0;
+			chunk_start = 0;
+			finished = false;
+
+			// Skip whole chunks, they are independent of each other
+			uint32_t frames, compressed_size;
+			for (;;) {
+				long chunk_pos = ftell(cache);
+				if (!ReadU32(cache, frames) || !ReadU32(cache, compressed_size)) {
+					finished = true;
+					return true;
+				}
+				if (target < chunk_start + frames) {
+					fseek(cache, chunk_pos, SEEK_SET);
+					break;
+				}
+				chunk_start += frames;
+				fseek(cache, compressed_size, SEEK_CUR);
+			}
+
+			// The chunk is read by FillBuffer when seeking to its beginning
+			if (target > chunk_start) {
+				if (ReadChunk() <= 0) {
+					finished = true;
+					return false;
+				}
+				sample_pos = (target - chunk_start) * cache_channels;
+			}
+
+			return true;
+		}
+
+		size_t Tell() const override {
+			return (size_t)((uint64_t)Frame() * 1000 / frequency);
+		}
+
+		bool IsFinished() const override {
+			return finished;
+		}
+
+		void GetFormat(int& freq, AudioDecoder::Format& format, int& channels) const override {
+			freq = frequency;
+			format = Format::S16;
+			channels = cache_channels;
+		}
+
+		bool SetFormat(int freq, AudioDecoder::Format format, int channels) override {
+			return freq == frequency && format == Format::S16 && channels == cache_channels;
+		}
+
+	private:
+		size_t Frame() const {
+			return chunk_start + sample_pos / cache_channels;
+		}
+
+		int FillBuffer(uint8_t* buffer, int length) override {
+			int16_t* out = reinterpret_cast<int16_t*>(buffer);
+			size_t count = (size_t)length / sizeof(int16_t);
+			size_t written = 0;
+
+			while (written < count) {
+				if (sample_pos == samples.size()) {
+					chunk_start += samples.size() / cache_channels;
+					int res = ReadChunk();
+					if (res < 0) {
+						return -1;
+					} else if (res == 0) {
+						samples.clear();
+						sample_pos = 0;
+						finished = true;
+						break;
+					}
+				}
+
+				size_t n = std::min(count - written, samples.size() - sample_pos);
+				memcpy(&out[written], &samples[sample_pos], n * sizeof(int16_t));
+				written += n;
+				sample_pos += n;
+			}
+
+			return (int)(written * sizeof(int16_t));
+		}
+
+		/** @return 1 when a chunk was read, 0 at the end, -1 on error */
+		int ReadChunk() {
+			uint32_t frames, compressed_size;
+			if (!ReadU32(cache, frames)) {
+				return 0;
+			}
+			if (!ReadU32(cache, compressed_size) || frames > chunk_frames) {
+				error_message = "MIDI cache: Corrupted chunk in " + cache_filename;
+				return -1;
+			}
+
+			compressed.resize(compressed_size);
+			samples.resize(frames * cache_channels);
+			uLongf dest_len = samples.size() * sizeof(int16_t);
+			if (fread(compressed.data(), 1, compressed_size, cache) != compressed_size ||
+				uncompress(reinterpret_cast<Bytef*>(samples.data()), &dest_len, compressed.data(), compressed_size) != Z_OK ||
+				dest_len != samples.size() * sizeof(int16_t)) {
+				error_message = "MIDI cache: Corrupted chunk in " + cache_filename;
+				return -1;
+			}
+
+			// Undo the delta coding
+			int16_t last[cache_channels] = { 0 };
+			for (size_t i = 0; i < samples.size(); ++i) {
+				uint16_t delta = (uint16_t)samples[i];
+				if (Utils::IsBigEndian()) {
+					Utils::SwapByteOrder(delta);
+				}
+				int16_t& prev = last[i % cache_channels];
+				prev = (int16_t)(uint16_t)((uint16_t)prev + delta);
+				samples[i] = prev;
+			}
+			sample_pos = 0;
+
+			return 1;
+		}
+
+		std::string cache_filename;
+		FILE* file = nullptr;
+		FILE* cache = nullptr;
+		int frequency = 0;
+		bool finished = false;
+
+		std::vector<uint8_t> compressed;
+		std::vector<int16_t> samples;
+		size_t sample_pos = 0;
+		// First frame of the current chunk
+		size_t chunk_start = 0;
+	};
+
+	struct RenderJob {
+		std::string filename;
+		std::string cache_filename;
+		int frequency;
+	};
+
+	SDL_Thread* render_thread = nullptr;
+	SDL_mutex* render_mutex = nullptr;
+	SDL_cond* render_cond = nullptr;
+	std::deque<RenderJob> render_jobs;
+	// Cache files that are queued or currently rendered
+	std::set<std::string> render_pending;
+	std::atomic<bool> render_quit(false);
+
+	bool WriteChunk(FILE* out, const int16_t* pcm, size_t frames, std::vector<int16_t>& delta, std::vector<uint8_t>& compressed) {
+		size_t count = frames * cache_channels;
+		delta.resize(count);
+
+		int16_t last[cache_channels] = { 0 };
+		for (size_t i = 0; i < count; ++i) {
+			int16_t& prev = last[i % cache_channels];
+			uint16_t d = (uint16_t)((uint16_t)pcm[i] - (uint16_t)prev);
+			prev = pcm[i];
+			if (Utils::IsBigEndian()) {
+				Utils::SwapByteOrder(d);
+			}
+			delta[i] = (int16_t)d;
+		}
+
+		uLong src_len = count * sizeof(int16_t);
+		uLongf dest_len = compressBound(src_len);
+		compressed.resize(dest_len);
+		if (compress2(compressed.data(), &dest_len, reinterpret_cast<const Bytef*>(delta.data()), src_len, 6) != Z_OK) {
+			return false;
+		}
+
+		WriteU32(out, (uint32_t)frames);
+		WriteU32(out, (uint32_t)dest_len);
+		return fwrite(compressed.data(), 1, dest_len, out) == dest_len;
+	}
+
+	/** Renders the whole MIDI file. Returns false on error or cancellation. */
+	bool Render(const RenderJob& job, const std::string& tmp_filename) {
+		FILE* file = FileFinder::fopenUTF8(job.filename, "rb");
+		if (!file) {
+			return false;
+		}
+
+		FmMidiDecoder decoder;
+		if (!decoder.Open(file)) {
+			return false;
+		}
+		decoder.SetFormat(job.frequency, AudioDecoder::Format::S16, cache_channels);
+
+		FILE* out = FileFinder::fopenUTF8(tmp_filename, "wb");
+		if (!out) {
+			return false;
+		}
+
+		fwrite(cache_magic, 4, 1, out);
+		WriteU32(out, cache_version);
+		WriteU32(out, (uint32_t)job.frequency);
+		WriteU32(out, (uint32_t)cache_channels);
+
+		std::vector<int16_t> pcm(chunk_frames * cache_channels);
+		std::vector<int16_t> delta;
+		std::vector<uint8_t> compressed;
+		size_t total_frames = 0;
+		bool success = true;
+
+		while (!decoder.IsFinished()) {
+			if (render_quit || total_frames > (size_t)job.frequency * max_render_seconds) {
+				success = false;
+				break;
+			}
+
+			int res = decoder.Decode(reinterpret_cast<uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t));
+			if (res <= 0) {
+				break;
+			}
+
+			size_t frames = (size_t)res / sizeof(int16_t) / cache_channels;
+			if (!WriteChunk(out, pcm.data(), frames, delta, compressed)) {
+				success = false;
+				break;
+			}
+			total_frames += frames;
+		}
+
+		if (fclose(out) != 0) {
+			success = false;
+		}
+
+		return success && total_frames > 0;
+	}
+
+	int RenderThread(void*) {
+		for (;;) {
+			SDL_LockMutex(render_mutex);
+			while (render_jobs.empty() && !render_quit) {
+				SDL_CondWait(render_cond, render_mutex);
+			}
+			if (render_quit) {
+				SDL_UnlockMutex(render_mutex);
+				return 0;
+			}
+			RenderJob job = render_jobs.front();
+			render_jobs.pop_front();
+			SDL_UnlockMutex(render_mutex);
+
+			// Rendered to a temporary file first, a crash or cancellation
+			// never leaves a truncated cache file behind
+			std::string tmp_filename = job.cache_filename + ".tmp";
+			if (Render(job, tmp_filename)) {
+				std::rename(tmp_filename.c_str(), job.cache_filename.c_str());
+			}
+			std::remove(tmp_filename.c_str());
+
+			SDL_LockMutex(render_mutex);
+			render_pending.erase(job.cache_filename);
+			SDL_UnlockMutex(render_mutex);
+		}
+	}
+
+	void QueueRender(const std::string& filename, const std::string& cache_filename, int frequency) {
+		if (!render_thread) {
+			render_mutex = SDL_CreateMutex();
+			render_cond = SDL_CreateCond();
+			render_quit = false;
+#if SDL_MAJOR_VERSION>1
+			render_thread = SDL_CreateThread(RenderThread, "MIDI render", nullptr);
+#else
+			render_thread = SDL_CreateThread(RenderThread, nullptr);
+#endif
+			if (!render_thread) {
+				// Threads are not available on all platforms, playback works
+				// without the cache
+				SDL_DestroyCond(render_cond);
+				SDL_DestroyMutex(render_mutex);
+				render_cond = nullptr;
+				render_mutex = nullptr;
+				return;
+			}
+		}
+
+		SDL_LockMutex(render_mutex);
+		if (render_pending.insert(cache_filename).second) {
+			render_jobs.push_back({ filename, cache_filename, frequency });
+			SDL_CondSignal(render_cond);
+		}
+		SDL_UnlockMutex(render_mutex);
+	}
+}
+
+std::unique_ptr<AudioDecoder> AudioMidiCache::Create(FILE* file, const std::string& filename, int frequency) {
+	if (Main_Data::GetCachePath().empty() || frequency <= 0) {
+		return nullptr;
+	}
+
+	char magic[4] = { 0 };
+	fread(magic, 4, 1, file);
+	fseek(file, 0, SEEK_SET);
+	if (strncmp(magic, "MThd", 4)) {
+		return nullptr;
+	}
+
+	std::string cache_filename = GetCacheFilename(HashFile(file), frequency);
+
+	if (!FileFinder::Exists(cache_filename)) {
+		QueueRender(filename, cache_filename, frequency);
+		return nullptr;
+	}
+
+#ifdef USE_AUDIO_RESAMPLER
+	// Handles the pitch, the rendered file is always at normal speed
+	return std::unique_ptr<AudioDecoder>(new AudioResampler(new MidiCacheDecoder(cache_filename)));
+#else
+	return std::unique_ptr<AudioDecoder>(new MidiCacheDecoder(cache_filename));
+#endif
+}
+
+void AudioMidiCache::Quit() {
+	if (!render_thread) {
+		return;
+	}
+
+	SDL_LockMutex(render_mutex);
+	render_quit = true;
+	render_jobs.clear();
+	SDL_CondSignal(render_cond);
+	SDL_UnlockMutex(render_mutex);
+
+	SDL_WaitThread(render_thread, nullptr);
+	render_thread = nullptr;
+	render_pending.clear();
+
+	SDL_DestroyCond(render_cond);
+	SDL_DestroyMutex(render_mutex);
+	render_cond = nullptr;
+	render_mutex = nullptr;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_AUDIO_MIDICACHE_H
+#define EASYRPG_AUDIO_MIDICACHE_H
+
+// Headers
+#include <cstdio>
+#include <string>
+#include <memory>
+#include "audio_decoder.h"
+
+/**
+ * AudioMidiCache stores MIDI files rendered by the built-in FM synthesizer
+ * as compressed PCM in the cache directory (see Main_Data::GetCachePath).
+ * The first time a MIDI file is played it is rendered on a background
+ * thread while the normal synthesizer is used for playback. Later plays
+ * stream the rendered file instead of synthesizing it again.
+ * Cache files are keyed by a hash of the MIDI file and the sample rate.
+ */
+namespace AudioMidiCache {
+	/**
+	 * Looks up the rendered version of a MIDI file.
+	 * When no cache directory is configured or the file is not a MIDI file
+	 * null is returned. When the file is not rendered yet it is queued for
+	 * rendering and null is returned.
+	 * The file handle always points at the beginning afterwards and must be
+	 * passed to Open of the returned decoder.
+	 *
+	 * @param file Handle of the MIDI file
+	 * @param filename Path to the MIDI file
+	 * @param frequency Sample rate the MIDI is rendered at
+	 * @return Audio decoder streaming the rendered file or null
+	 */
+	std::unique_ptr<AudioDecoder> Create(FILE* file, const std::string& filename, int frequency);
+
+	/**
+	 * Stops the render thread. Partially rendered files are discarded.
+	 */
+	void Quit();
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include "audio_resampler.h"
+#include "audio_stats.h"
 #include "output.h"
 
 #define ERROR -1
@@ -188,6 +189,7 @@ AudioResampler::AudioResampler(AudioDecoder * wrapped, bool pitch_handled, Audio
 
 	wrapped_decoder = wrapped;
 	music_type = wrapped->GetType();
+	stats_section = AudioStats::Section_Resample;
 	lasterror = 0;
 	pitch_handled_by_decoder = pitch_handled;
 
@@ -23,7 +23,9 @@
 
 #ifdef HAVE_SDL_MIXER
 
+#include "audio_midicache.h"
 #include "audio_secache.h"
+#include "audio_stats.h"
 #include "baseui.h"
 #include "audio_sdl.h"
 #include "filefinder.h"
@@ -42,6 +44,12 @@
 #define BGS_CHANNEL_NUM 0
 
 namespace {
+	int midi_frequency(int audio_rate) {
+		// FM Midi is very CPU heavy and the difference between 44100 and 22050
+		// is not hearable for MIDI
+		return audio_rate / 2;
+	}
+
 	void bgm_played_once() {
 		if (DisplayUi)
 			static_cast<SdlAudio&>(Audio()).BGM_OnPlayedOnce();
@@ -55,6 +63,7 @@ namespace {
 	void callback(void *udata, Uint8 *stream, int stream_size) {
 		static std::vector<uint8_t> buffer;
 
+		AudioStats::Scope timer(AudioStats::Section_Callback);
 		SdlAudio* audio = static_cast<SdlAudio*>(udata);
 
 		SDL_AudioCVT& cvt = audio->GetAudioCVT();
@@ -100,6 +109,19 @@ namespace {
 			SDL_MixAudio(stream, reinterpret_cast<const Uint8*>(cvt.buf), cvt.len_cvt, audio->GetDecoder()->GetVolume());
 #endif
 		}
+
+		// Taking longer than the buffer plays means the device runs dry
+		int audio_rate;
+		Uint16 sdl_format;
+		int audio_channels;
+		if (Mix_QuerySpec(&audio_rate, &sdl_format, &audio_channels)) {
+			// The low byte of the format is the sample size in bits (SDL 1 and 2)
+			int frame_size = audio_channels * ((sdl_format & 0xFF) / 8);
+			uint64_t buffer_us = (uint64_t)stream_size * 1000000 / (frame_size * audio_rate);
+			if (timer.Elapsed() > buffer_us) {
+				AudioStats::AddUnderrun();
+			}
+		}
 	}
 
 	int format_to_sdl_format(AudioDecoder::Format format) {
@@ -223,6 +245,10 @@ SdlAudio::~SdlAudio() {
 	// Must be reset otherwise Player segfaults when SDL is reinitialized (Android)
 	Mix_HookMusic(nullptr, nullptr);
 
+#ifdef WANT_FMMIDI
+	AudioMidiCache::Quit();
+#endif
+
 	Mix_CloseAudio();
 }
 
@@ -255,14 +281,25 @@ void SdlAudio::BGM_Play(std::string const& file, int volume, int pitch, int fade
 		Output::Warning("Music not readable: %s", file.c_str());
 		return;
 	}
+#ifdef WANT_FMMIDI
+	int audio_rate = 0;
+	Uint16 sdl_format;
+	int audio_channels;
+	Mix_QuerySpec(&audio_rate, &sdl_format, &audio_channels);
+	audio_decoder = AudioMidiCache::Create(filehandle, file, midi_frequency(audio_rate));
+	if (!audio_decoder) {
+		audio_decoder = AudioDecoder::Create(filehandle, file);
+	}
+#else
 	audio_decoder = AudioDecoder::Create(filehandle, file);
+#endif
 	if (audio_decoder) {
 		SetupAudioDecoder(filehandle, file, volume, pitch, fadein);
 		return;
 	}
 	fclose(filehandle);
 
-	SDL_RWops *rw = SDL_RWFromFile(file.c_str(), "rb");
+	SDL_RWops *rw = SDL_RWFromFile(FileFinder::MakeLocal(file).c_str(), "rb");
 
 	bgm_stop = false;
 	played_once = false;
@@ -372,9 +409,7 @@ void SdlAudio::SetupAudioDecoder(FILE* handle, const std::string& file, int volu
 
 	int target_rate = audio_rate;
 	if (audio_decoder->GetType() == "midi") {
-		// FM Midi is very CPU heavy and the difference between 44100 and 22050
-		// is not hearable for MIDI
-		target_rate /= 2;
+		target_rate = midi_frequency(audio_rate);
 	}
 	audio_decoder->SetFormat(target_rate, audio_format, audio_channels);
 
@@ -462,6 +497,33 @@ unsigned SdlAudio::BGM_GetTicks() const {
 	return SDL_GetTicks() - bgm_starttick;
 }
 
+size_t SdlAudio::BGM_Tell() const {
+	if (!audio_decoder) {
+		return -1;
+	}
+
+	SDL_LockAudio();
+	size_t position = audio_decoder->Tell();
+	SDL_UnlockAudio();
+
+	return position;
+}
+
+bool SdlAudio::BGM_Seek(size_t position) {
+	if (!audio_decoder) {
+		return false;
+	}
+
+	// Seeking can take a while (MP3 streams are indexed on the first seek).
+	// Instead of locking the audio thread the decoder is detached from it,
+	// the other channels keep playing meanwhile.
+	Mix_HookMusic(nullptr, nullptr);
+	bool result = audio_decoder->Seek(position, AudioDecoder::Origin::Begin);
+	Mix_HookMusic(callback, this);
+
+	return result;
+}
+
 void SdlAudio::BGM_Volume(int volume) {
 	if (audio_decoder) {
 		audio_decoder->SetVolume(volume);
@@ -520,7 +582,7 @@ void SdlAudio::BGM_Fade(int fade) {
 }
 
 void SdlAudio::BGS_Play(std::string const& file, int volume, int /* pitch */, int fadein) {
-	bgs.reset(Mix_LoadWAV(file.c_str()), &Mix_FreeChunk);
+	bgs.reset(Mix_LoadWAV(FileFinder::MakeLocal(file).c_str()), &Mix_FreeChunk);
 	if (!bgs) {
 		Output::Warning("Couldn't load %s BGS.\n%s", file.c_str(), Mix_GetError());
 		return;
@@ -598,7 +660,7 @@ void SdlAudio::SE_Play(std::string const& file, int volume, int pitch) {
 	}
 
 	if (!sound) {
-		sound.reset(Mix_LoadWAV(file.c_str()), &Mix_FreeChunk);
+		sound.reset(Mix_LoadWAV(FileFinder::MakeLocal(file).c_str()), &Mix_FreeChunk);
 		if (!sound) {
 			Output::Warning("Couldn't load %s SE.\n%s", file.c_str(), Mix_GetError());
 			return;
@@ -38,6 +38,8 @@ struct SdlAudio : public AudioInterface {
 	bool BGM_PlayedOnce() const override;
 	bool BGM_IsPlaying() const override;
 	unsigned BGM_GetTicks() const override;
+	size_t BGM_Tell() const override;
+	bool BGM_Seek(size_t position) override;
 	void BGM_Fade(int) override;
 	void BGM_Volume(int) override;
 	void BGM_Pitch(int) override;
@@ -22,8 +22,10 @@
 #include <set>
 #include "audio_resampler.h"
 #include "audio_secache.h"
+#include "audio_stats.h"
 #include "baseui.h"
 #include "filefinder.h"
+#include "memory_stats.h"
 #include "output.h"
 
 namespace {
@@ -53,6 +55,7 @@ namespace {
 			//Output::Debug("SE: Freeing memory of %s", it->first.c_str());
 
 			cache_size -= it->second->buffer.size();
+			MemoryStats::Remove(MemoryStats::Category_AudioSe, it->second->buffer.size());
 
 			it = cache.erase(it);
 		}
@@ -67,6 +70,8 @@ std::unique_ptr<AudioSeCache> AudioSeCache::Create(const std::string& filename)
 	se.reset(new AudioSeCache());
 	se->filename = filename;
 
+	AudioStats::AddSeCacheAccess(it != cache.end());
+
 	if (it == cache.end()) {
 		// Not in cache
 
@@ -213,6 +218,12 @@ private:
 };
 
 AudioSeRef AudioSeCache::Decode() {
+	AudioStats::Scope timer(AudioStats::Section_SeDecode);
+
+	return DecodeInternal();
+}
+
+AudioSeRef AudioSeCache::DecodeInternal() {
 	// Writes a SE with pitch = 100 to the cache if it is not cached yet,
 	// otherwise returns the cached result
 	// For pitch != 100 the cached result is pitch-adjusted and returned.
@@ -290,6 +301,7 @@ AudioSeRef AudioSeCache::Decode() {
 		se->last_access = DisplayUi->GetTicks();
 
 		cache_size += se->buffer.size();
+		MemoryStats::Add(MemoryStats::Category_AudioSe, se->buffer.size());
 
 		if (cache_size > cache_limit) {
 			FreeCacheMemory();
@@ -301,7 +313,7 @@ AudioSeRef AudioSeCache::Decode() {
 			// Also handle a requested resampling
 			// Takes the "IsCached" codepath now
 			mono_to_stereo_resample = false;
-			return Decode();
+			return DecodeInternal();
 		}
 	}
 
@@ -309,6 +321,7 @@ AudioSeRef AudioSeCache::Decode() {
 }
 
 void AudioSeCache::Clear() {
+	MemoryStats::Remove(MemoryStats::Category_AudioSe, cache_size);
 	cache_size = 0;
 	cache.clear();
 }
@@ -134,6 +134,8 @@ public:
 
 	static void Clear();
 private:
+	AudioSeRef DecodeInternal();
+
 	int pitch = 100;
 
 	std::unique_ptr<AudioDecoder> audio_decoder;
@@ -0,0 +1,213 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include "audio_stats.h"
+#include "output.h"
+
+namespace {
+	/*
+	 * Durations are sorted into buckets of half an octave:
+	 * 0-1, 1-2, 2-3, 3-4, 4-6, 6-8, 8-12, ... microseconds
+	 */
+	const int bucket_count = 48;
+
+	struct SectionStats {
+		std::atomic<uint32_t> calls;
+		std::atomic<uint64_t> total_us;
+		std::atomic<uint32_t> max_us;
+		std::atomic<uint32_t> buckets[bucket_count];
+	};
+
+	SectionStats sections[AudioStats::Section_Count];
+	std::atomic<uint32_t> underruns;
+	std::atomic<uint32_t> se_hits;
+	std::atomic<uint32_t> se_misses;
+
+	const char* const section_names[AudioStats::Section_Count] = {
+		"wav",
+		"ogg",
+		"mp3",
+		"midi",
+		"other",
+		"resamp",
+		"se",
+		"mixer"
+	};
+
+	int BucketForDuration(uint32_t us) {
+		if (us < 4) {
+			return us;
+		}
+
+		int msb = 31;
+		while (!(us & (1u << msb))) {
+			--msb;
+		}
+		int bucket = msb * 2 + ((us >> (msb - 1)) & 1);
+		return bucket < bucket_count ? bucket : bucket_count - 1;
+	}
+
+	/** @return upper bound of the bucket in microseconds */
+	uint32_t BucketLimit(int bucket) {
+		if (bucket < 4) {
+			return bucket + 1;
+		}
+
+		int msb = bucket / 2;
+		return (bucket & 1) ? (1u << (msb + 1)) : (3u << (msb - 1));
+	}
+
+	/** @return percentile p (0-100) in microseconds, interpolated inside the bucket */
+	uint32_t Percentile(const SectionStats& s, uint32_t calls, int p) {
+		uint64_t target = ((uint64_t)calls * p + 99) / 100;
+		uint64_t sum = 0;
+		for (int i = 0; i < bucket_count; ++i) {
+			uint32_t count = s.buckets[i].load(std::memory_order_relaxed);
+			if (sum + count >= target && count > 0) {
+				uint32_t low = i > 0 ? BucketLimit(i - 1) : 0;
+				uint32_t high = BucketLimit(i);
+				uint32_t value = low + (uint32_t)((high - low) * (target - sum) / count);
+				return std::min(value, s.max_us.load(std::memory_order_relaxed));
+			}
+			sum += count;
+		}
+		return s.max_us.load(std::memory_order_relaxed);
+	}
+
+	double ToMs(uint64_t us) {
+		return us / 1000.0;
+	}
+}
+
+AudioStats::Section AudioStats::SectionForType(const std::string& music_type) {
+	if (music_type == "wav") {
+		return Section_DecodeWav;
+	} else if (music_type == "ogg") {
+		return Section_DecodeOgg;
+	} else if (music_type == "mp3") {
+		return Section_DecodeMp3;
+	} else if (music_type == "midi") {
+		return Section_DecodeMidi;
+	}
+	return Section_DecodeOther;
+}
+
+void AudioStats::Add(Section section, uint32_t us) {
+	SectionStats& s = sections[section];
+	s.calls.fetch_add(1, std::memory_order_relaxed);
+	s.total_us.fetch_add(us, std::memory_order_relaxed);
+	s.buckets[BucketForDuration(us)].fetch_add(1, std::memory_order_relaxed);
+
+	uint32_t max = s.max_us.load(std::memory_order_relaxed);
+	while (us > max && !s.max_us.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+	}
+}
+
+AudioStats::Scope::Scope(Section section) :
+	section(section),
+	start(std::chrono::steady_clock::now()) {
+}
+
+AudioStats::Scope::~Scope() {
+	Add(section, Elapsed());
+}
+
+uint32_t AudioStats::Scope::Elapsed() const {
+	return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+void AudioStats::AddUnderrun() {
+	underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioStats::AddSeCacheAccess(bool hit) {
+	(hit ? se_hits : se_misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<std::string> AudioStats::GetSummary() {
+	std::vector<std::string> lines;
+	char line[64];
+
+	snprintf(line, sizeof(line), "%-6s %5s %5s %5s %5s", "ms", "avg", "p50", "p95", "p99");
+	lines.push_back(line);
+	for (int i = 0; i < Section_Count; ++i) {
+		const SectionStats& s = sections[i];
+		uint32_t calls = s.calls.load(std::memory_order_relaxed);
+		if (calls == 0) {
+			continue;
+		}
+
+		snprintf(line, sizeof(line), "%-6s %5.2f %5.2f %5.2f %5.2f", section_names[i],
+			ToMs(s.total_us.load(std::memory_order_relaxed) / calls),
+			ToMs(Percentile(s, calls, 50)),
+			ToMs(Percentile(s, calls, 95)),
+			ToMs(Percentile(s, calls, 99)));
+		lines.push_back(line);
+	}
+
+	snprintf(line, sizeof(line), "Underruns: %u", (unsigned)underruns.load(std::memory_order_relaxed));
+	lines.push_back(line);
+
+	uint32_t hits = se_hits.load(std::memory_order_relaxed);
+	uint32_t accesses = hits + se_misses.load(std::memory_order_relaxed);
+	snprintf(line, sizeof(line), "SE cache: %u/%u hits", (unsigned)hits, (unsigned)accesses);
+	lines.push_back(line);
+
+	return lines;
+}
+
+void AudioStats::Dump() {
+	Output::Debug("Audio statistics (durations in ms):");
+	for (int i = 0; i < Section_Count; ++i) {
+		const SectionStats& s = sections[i];
+		uint32_t calls = s.calls.load(std::memory_order_relaxed);
+		if (calls == 0) {
+			continue;
+		}
+
+		uint64_t total = s.total_us.load(std::memory_order_relaxed);
+		Output::Debug("%s: %u calls, total %.1f, avg %.3f, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f",
+			section_names[i], (unsigned)calls, ToMs(total), ToMs(total / calls),
+			ToMs(Percentile(s, calls, 50)), ToMs(Percentile(s, calls, 95)),
+			ToMs(Percentile(s, calls, 99)), ToMs(s.max_us.load(std::memory_order_relaxed)));
+	}
+
+	uint32_t hits = se_hits.load(std::memory_order_relaxed);
+	uint32_t misses = se_misses.load(std::memory_order_relaxed);
+	Output::Debug("Underruns: %u", (unsigned)underruns.load(std::memory_order_relaxed));
+	Output::Debug("SE cache: %u hits, %u misses (%.1f%%)", (unsigned)hits, (unsigned)misses,
+		hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0);
+}
+
+void AudioStats::Reset() {
+	for (SectionStats& s : sections) {
+		s.calls = 0;
+		s.total_us = 0;
+		s.max_us = 0;
+		for (std::atomic<uint32_t>& b : s.buckets) {
+			b = 0;
+		}
+	}
+	underruns = 0;
+	se_hits = 0;
+	se_misses = 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_AUDIO_STATS_H
+#define EASYRPG_AUDIO_STATS_H
+
+// Headers
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * AudioStats collects timing information of the audio subsystem: Time
+ * spent decoding per format, resampling, decoding sound effects and in
+ * the mixer callback, together with underruns and the SE cache hit rate.
+ * All functions are lock-free and can be called from the audio thread.
+ */
+namespace AudioStats {
+	/** Measured code sections */
+	enum Section {
+		Section_DecodeWav,
+		Section_DecodeOgg,
+		Section_DecodeMp3,
+		Section_DecodeMidi,
+		Section_DecodeOther,
+		/** Resampler including the wrapped decoder */
+		Section_Resample,
+		/** Sound effect decoding including cache lookup */
+		Section_SeDecode,
+		/** Mixer callback of the audio backend */
+		Section_Callback,
+		Section_Count
+	};
+
+	/**
+	 * Maps the music type of a decoder to a decode section.
+	 *
+	 * @param music_type Type returned by AudioDecoder::GetType
+	 * @return Decode section
+	 */
+	Section SectionForType(const std::string& music_type);
+
+	/**
+	 * Adds a measurement.
+	 *
+	 * @param section Measured section
+	 * @param us Duration in microseconds
+	 */
+	void Add(Section section, uint32_t us);
+
+	/**
+	 * Measures the time until the object is destroyed.
+	 */
+	class Scope {
+	public:
+		Scope(Section section);
+		~Scope();
+
+		/** @return microseconds since construction */
+		uint32_t Elapsed() const;
+
+	private:
+		Section section;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/**
+	 * Counts an underrun (the audio device ran out of data).
+	 */
+	void AddUnderrun();
+
+	/**
+	 * Counts an access of the sound effect cache.
+	 *
+	 * @param hit whether the sample was already cached
+	 */
+	void AddSeCacheAccess(bool hit);
+
+	/**
+	 * Returns a short summary suitable for the debug scene.
+	 * The times are the average, median, 95th and 99th percentile in ms.
+	 *
+	 * @return summary lines
+	 */
+	std::vector<std::string> GetSummary();
+
+	/**
+	 * Writes all collected statistics to the log.
+	 */
+	void Dump();
+
+	/**
+	 * Resets all statistics.
+	 */
+	void Reset();
+}
+
+#endif
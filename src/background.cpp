@@ -83,10 +83,12 @@ void Background::OnBackgroundGraphicReady(FileRequestResult* result) {
 	else if (result->directory == "Frame") {
 		bg_bitmap = Cache::Frame(result->file, false);
 	}
+	needs_refresh = true;
 }
 
 void Background::OnForegroundFrameGraphicReady(FileRequestResult* result) {
 	fg_bitmap = Cache::Frame(result->file);
+	needs_refresh = true;
 }
 
 Background::~Background() {
@@ -121,14 +123,43 @@ int Background::Scale(int x) {
 }
 
 void Background::Draw() {
-	if (!visible)
+	if (!visible || (!bg_bitmap && !fg_bitmap))
 		return;
 
 	BitmapRef dst = DisplayUi->GetDisplaySurface();
 
-	if (bg_bitmap)
-		dst->TiledBlit(-Scale(bg_x), -Scale(bg_y), bg_bitmap->GetRect(), *bg_bitmap, dst->GetRect(), 255);
+	if (!strip ||
+		strip->GetWidth() != dst->GetWidth() ||
+		strip->GetHeight() != dst->GetHeight()) {
+		strip = Bitmap::Create(dst->GetWidth(), dst->GetHeight(), true);
+		needs_refresh = true;
+	}
+
+	int bx = Scale(bg_x);
+	int by = Scale(bg_y);
+	int fx = Scale(fg_x);
+	int fy = Scale(fg_y);
+
+	// The layers only move every few frames, reuse the last composition
+	if (needs_refresh ||
+		bx != strip_bg_x || by != strip_bg_y ||
+		fx != strip_fg_x || fy != strip_fg_y) {
+		needs_refresh = false;
+		strip_bg_x = bx;
+		strip_bg_y = by;
+		strip_fg_x = fx;
+		strip_fg_y = fy;
+
+		// An opaque background covers the whole strip
+		if (!bg_bitmap || bg_bitmap->GetTransparent())
+			strip->Clear();
+
+		if (bg_bitmap)
+			strip->TiledBlit(-bx, -by, bg_bitmap->GetRect(), *bg_bitmap, strip->GetRect(), 255);
+
+		if (fg_bitmap)
+			strip->TiledBlit(-fx, -fy, fg_bitmap->GetRect(), *fg_bitmap, strip->GetRect(), 255);
+	}
 
-	if (fg_bitmap)
-		dst->TiledBlit(-Scale(fg_x), -Scale(fg_y), fg_bitmap->GetRect(), *fg_bitmap, dst->GetRect(), 255);
+	dst->Blit(0, 0, *strip, strip->GetRect(), 255);
 }
@@ -59,6 +59,14 @@ private:
 	int fg_x;
 	int fg_y;
 
+	/** Both layers composited at the offsets of the last frame */
+	BitmapRef strip;
+	int strip_bg_x = 0;
+	int strip_bg_y = 0;
+	int strip_fg_x = 0;
+	int strip_fg_y = 0;
+	bool needs_refresh = true;
+
 	FileRequestBinding request_id;
 };
 
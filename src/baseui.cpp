@@ -63,6 +63,14 @@ BitmapRef& BaseUi::GetDisplaySurface() {
 	return main_surface;
 }
 
+uint64_t BaseUi::GetTicksMicro() const {
+	return static_cast<uint64_t>(GetTicks()) * 1000;
+}
+
+bool BaseUi::IsFrameRateSynchronized() const {
+	return false;
+}
+
 BitmapRef BaseUi::CaptureScreen() {
 	return Bitmap::Create(*main_surface, main_surface->GetRect());
 }
@@ -131,6 +131,22 @@ public:
 	 */
 	virtual uint32_t GetTicks() const = 0;
 
+	/**
+	 * Gets high resolution ticks for frame pacing.
+	 * The default implementation is based on GetTicks.
+	 *
+	 * @return time in us.
+	 */
+	virtual uint64_t GetTicksMicro() const;
+
+	/**
+	 * Gets whether updating the display waits for the vertical blank of
+	 * a display running at the game frame rate.
+	 *
+	 * @return whether the display paces the frames.
+	 */
+	virtual bool IsFrameRateSynchronized() const;
+
 	/**
 	 * Sleeps some time.
 	 *
@@ -0,0 +1,137 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+#include "benchmark.h"
+#include "baseui.h"
+#include "memory_stats.h"
+#include "output.h"
+
+namespace {
+	struct FrameTime {
+		int64_t logic;
+		int64_t render;
+	};
+
+	std::vector<FrameTime> frames;
+	int64_t start_time;
+	uint64_t start_allocations;
+	uint64_t start_allocated_bytes;
+
+	double ToMs(int64_t us) {
+		return us / 1000.0;
+	}
+
+	double ToMiB(uint64_t bytes) {
+		return bytes / (1024.0 * 1024.0);
+	}
+
+	/** Nearest rank percentile of a sorted list */
+	int64_t Percentile(const std::vector<int64_t>& sorted, int percent) {
+		size_t rank = (sorted.size() * percent + 99) / 100;
+		return sorted[std::max<size_t>(rank, 1) - 1];
+	}
+}
+
+void Benchmark::Start() {
+	frames.clear();
+	// Reserve ahead to keep the own allocations out of the measurement
+	frames.reserve(60 * 60 * 10);
+
+	start_time = static_cast<int64_t>(DisplayUi->GetTicksMicro());
+	start_allocations = MemoryStats::GetAllocationCount();
+	start_allocated_bytes = MemoryStats::GetAllocatedBytes();
+}
+
+void Benchmark::AddFrame(int64_t logic_us, int64_t render_us) {
+	frames.push_back({logic_us, render_us});
+}
+
+void Benchmark::Report() {
+	int64_t elapsed = static_cast<int64_t>(DisplayUi->GetTicksMicro()) - start_time;
+	uint64_t allocations = MemoryStats::GetAllocationCount() - start_allocations;
+	uint64_t allocated_bytes = MemoryStats::GetAllocatedBytes() - start_allocated_bytes;
+
+	std::vector<std::string> lines;
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(2);
+
+	if (frames.empty()) {
+		lines.push_back("Benchmark: No frames were measured");
+	} else {
+		std::vector<int64_t> totals;
+		totals.reserve(frames.size());
+		int64_t logic = 0;
+		int64_t render = 0;
+		for (const FrameTime& frame : frames) {
+			totals.push_back(frame.logic + frame.render);
+			logic += frame.logic;
+			render += frame.render;
+		}
+		std::sort(totals.begin(), totals.end());
+
+		size_t count = frames.size();
+		int64_t total = std::max<int64_t>(logic + render, 1);
+
+		line << "Benchmark: " << count << " frames in " << elapsed / 1000000.0 << " s ("
+			<< count * 1000000.0 / std::max<int64_t>(elapsed, 1) << " fps)";
+		lines.push_back(line.str());
+		line.str("");
+
+		line << "Frame time (ms): min " << ToMs(totals.front())
+			<< ", median " << ToMs(Percentile(totals, 50))
+			<< ", p90 " << ToMs(Percentile(totals, 90))
+			<< ", p99 " << ToMs(Percentile(totals, 99))
+			<< ", max " << ToMs(totals.back())
+			<< ", mean " << ToMs(total) / count;
+		lines.push_back(line.str());
+		line.str("");
+
+		line << "Logic: " << ToMs(logic) / count << " ms/frame (" << 100.0 * logic / total << "%), "
+			<< "Render: " << ToMs(render) / count << " ms/frame (" << 100.0 * render / total << "%)";
+		lines.push_back(line.str());
+		line.str("");
+
+		if (MemoryStats::IsCountingAllocations()) {
+			line << "Allocations: " << allocations << " (" << static_cast<double>(allocations) / count
+				<< "/frame), " << ToMiB(allocated_bytes) << " MiB";
+		} else {
+			line << "Allocations: not counted";
+		}
+		lines.push_back(line.str());
+		line.str("");
+	}
+
+	int64_t peak_rss = MemoryStats::GetPeakResidentSize();
+	if (peak_rss >= 0) {
+		line << "Peak RSS: " << ToMiB(peak_rss) << " MiB";
+	} else {
+		line << "Peak RSS: not available";
+	}
+	lines.push_back(line.str());
+
+	for (const std::string& text : lines) {
+		std::cout << text << std::endl;
+		Output::Debug("%s", text.c_str());
+	}
+}
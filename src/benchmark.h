@@ -0,0 +1,49 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_BENCHMARK_H
+#define EASYRPG_BENCHMARK_H
+
+// Headers
+#include <cstdint>
+
+/**
+ * Benchmark namespace.
+ * Collects the frame times of a replayed input log (see --benchmark)
+ * and reports their distribution together with the memory usage.
+ */
+namespace Benchmark {
+	/**
+	 * Starts a new measurement.
+	 */
+	void Start();
+
+	/**
+	 * Adds the times of a finished frame.
+	 *
+	 * @param logic_us time spent in the game logic in us.
+	 * @param render_us time spent drawing the frame in us.
+	 */
+	void AddFrame(int64_t logic_us, int64_t render_us);
+
+	/**
+	 * Writes the report to stdout and the log.
+	 */
+	void Report();
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include "utils.h"
 #include "cache.h"
 #include "bitmap.h"
+#include "bitmap_pool.h"
 #include "filefinder.h"
 #include "options.h"
 #include "data.h"
@@ -32,11 +33,13 @@
 #include "image_xyz.h"
 #include "image_bmp.h"
 #include "image_png.h"
+#include "image_out.h"
 #include "transform.h"
 #include "font.h"
 #include "output.h"
 #include "util_macro.h"
 #include "bitmap_hslrgb.h"
+#include "scratch_arena.h"
 
 const Opacity Opacity::opaque;
 
@@ -92,59 +95,116 @@ Bitmap::Bitmap(void *pixels, int width, int height, int pitch, const DynamicForm
 	Init(width, height, pixels, pitch, false);
 }
 
-Bitmap::Bitmap(const std::string& filename, bool transparent, uint32_t flags) {
-	font = Font::Default();
-	format = (transparent ? pixel_format : opaque_pixel_format);
-	pixman_format = find_format(format);
+/**
+ * Converts the decoded rows straight into the pixels of the bitmap.
+ * 32 bit formats with 8 bit channels are packed directly with the alpha
+ * premultiplied on the way. Palette images go through a lookup table of
+ * finished pixels. Other formats are converted one row at a time by pixman.
+ */
+class Bitmap::ImageConverter : public ImageOut {
+public:
+	ImageConverter(Bitmap& dst, bool transparent) :
+		dst(dst),
+		img_format(transparent ? image_format : opaque_image_format) {
+		const DynamicFormat& f = dst.format;
+		direct = f.bits == 32 && f.r.bits == 8 && f.g.bits == 8 && f.b.bits == 8 &&
+			(f.a.bits == 8 || f.a.bits == 0);
+	}
 
-	FILE* stream = FileFinder::fopenUTF8(filename, "rb");
-	if (!stream) {
-		Output::Error("Couldn't open image file %s", filename.c_str());
-		return;
+	~ImageConverter() {
+		if (line_image)
+			pixman_image_unref(line_image);
 	}
 
-	int w = 0;
-	int h = 0;
-	void* pixels;
+	uint8_t* Begin(int w, int h) override {
+		width = w;
+		dst.Init(w, h, (void *) NULL);
+		if (!dst.bitmap)
+			return nullptr;
 
-	char data[4];
-	size_t bytes = fread(&data, 1, 4, stream);
-	fseek(stream, 0, SEEK_SET);
+		row.resize(w * 4 + 4);
+		if (!direct) {
+			line.resize(w + 1);
+			line_image = pixman_image_create_bits(find_format(img_format), w, 1, &line.front(), w * 4);
+		}
+		return &row.front();
+	}
 
-	bool img_okay = false;
+	void WriteRow(int y, const uint8_t* rgba) override {
+		uint32_t* out = direct ? Dest(y) : &line.front();
+		for (int x = 0; x < width; x++, rgba += 4)
+			out[x] = Pack(rgba[0], rgba[1], rgba[2], rgba[3]);
+		Flush(y);
+	}
 
-#ifdef SUPPORT_XYZ
-	if (bytes >= 4 && strncmp((char*)data, "XYZ1", 4) == 0)
-		img_okay = ImageXYZ::ReadXYZ(stream, transparent, w, h, pixels);
-	else
-#endif
-#ifdef SUPPORT_BMP
-	if (bytes > 2 && strncmp((char*)data, "BM", 2) == 0)
-		img_okay = ImageBMP::ReadBMP(stream, transparent, w, h, pixels);
-	else
-#endif
-#ifdef SUPPORT_PNG
-	if (bytes >= 4 && strncmp((char*)(data + 1), "PNG", 3) == 0)
-		img_okay = ImagePNG::ReadPNG(stream, (void*)NULL, transparent, w, h, pixels);
-	else
-#endif
-		Output::Warning("Unsupported image file %s", filename.c_str());
+	void SetPalette(const uint8_t (*rgba)[4], int count) override {
+		for (int i = 0; i < 256; i++)
+			lut[i] = i < count ? Pack(rgba[i][0], rgba[i][1], rgba[i][2], rgba[i][3]) : Pack(0, 0, 0, 255);
+	}
 
-	fclose(stream);
+	void WriteIndexedRow(int y, const uint8_t* indices) override {
+		uint32_t* out = direct ? Dest(y) : &line.front();
+		for (int x = 0; x < width; x++)
+			out[x] = lut[indices[x]];
+		Flush(y);
+	}
 
-	if (!img_okay) {
-		free(pixels);
+private:
+	uint32_t* Dest(int y) {
+		return (uint32_t*) ((uint8_t*) pixman_image_get_data(dst.bitmap) + y * pixman_image_get_stride(dst.bitmap));
+	}
 
-		pixels = nullptr;
+	/** Premultiplies a color and packs it into the target format. */
+	uint32_t Pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a) const {
+		MultiplyAlpha(r, g, b, a);
 
-		return;
+		if (!direct) {
+			// Same byte order as img_format
+			uint8_t bytes[4] = { r, g, b, a };
+			uint32_t pixel;
+			memcpy(&pixel, bytes, 4);
+			return pixel;
+		}
+
+		const DynamicFormat& f = dst.format;
+		uint32_t pixel = ((uint32_t) r << f.r.shift) | ((uint32_t) g << f.g.shift) | ((uint32_t) b << f.b.shift);
+		if (f.a.bits)
+			pixel |= (uint32_t) (f.alpha_type == PF::Alpha ? a : 0xFF) << f.a.shift;
+		return pixel;
 	}
 
-	Init(w, h, (void *) NULL);
+	void Flush(int y) {
+		if (direct)
+			return;
+		pixman_image_composite32(PIXMAN_OP_SRC, line_image, NULL, dst.bitmap,
+								 0, 0, 0, 0, 0, y, width, 1);
+	}
 
-	ConvertImage(w, h, pixels, transparent);
+	Bitmap& dst;
+	const DynamicFormat& img_format;
+	bool direct;
+	int width = 0;
+	uint32_t lut[256];
+	std::vector<uint8_t> row;
+	std::vector<uint32_t> line;
+	pixman_image_t* line_image = nullptr;
+};
 
-	CheckPixels(flags);
+Bitmap::Bitmap(const std::string& filename, bool transparent, uint32_t flags) {
+	font = Font::Default();
+	format = (transparent ? pixel_format : opaque_pixel_format);
+	pixman_format = find_format(format);
+
+	// The decoders read straight from the mapped file
+	FileSpanRef span = FileFinder::MapFile(filename);
+	if (!span) {
+		Output::Error("Couldn't open image file %s", filename.c_str());
+		return;
+	}
+
+	if (!Decode(span->data(), (unsigned) span->size(), transparent, flags)) {
+		Output::Warning("Unsupported image file %s", filename.c_str());
+	}
 }
 
 Bitmap::Bitmap(const uint8_t* data, unsigned bytes, bool transparent, uint32_t flags) {
@@ -152,37 +212,44 @@ Bitmap::Bitmap(const uint8_t* data, unsigned bytes, bool transparent, uint32_t f
 	format = (transparent ? pixel_format : opaque_pixel_format);
 	pixman_format = find_format(format);
 
-	int w = 0, h = 0;
-	void* pixels;
+	if (!Decode(data, bytes, transparent, flags)) {
+		Output::Warning("Unsupported image");
+	}
+}
+
+bool Bitmap::Decode(const uint8_t* data, unsigned bytes, bool transparent, uint32_t flags) {
+	ImageConverter converter(*this, transparent);
 
 	bool img_okay = false;
 
 #ifdef SUPPORT_XYZ
 	if (bytes > 4 && strncmp((char*) data, "XYZ1", 4) == 0)
-		img_okay = ImageXYZ::ReadXYZ(data, bytes, transparent, w, h, pixels);
+		img_okay = ImageXYZ::ReadXYZ(data, bytes, transparent, converter);
 	else
 #endif
 #ifdef SUPPORT_BMP
 	if (bytes > 2 && strncmp((char*) data, "BM", 2) == 0)
-		img_okay = ImageBMP::ReadBMP(data, bytes, transparent, w, h, pixels);
+		img_okay = ImageBMP::ReadBMP(data, bytes, transparent, converter);
 	else
 #endif
 #ifdef SUPPORT_PNG
 	if (bytes > 4 && strncmp((char*)(data + 1), "PNG", 3) == 0)
-		img_okay = ImagePNG::ReadPNG((FILE*) NULL, (const void*) data, transparent, w, h, pixels);
+		img_okay = ImagePNG::ReadPNG(data, bytes, transparent, converter);
 	else
 #endif
-		Output::Warning("Unsupported image");
+		return false;
 
 	if (!img_okay) {
-		return;
+		if (bitmap) {
+			pixman_image_unref(bitmap);
+			bitmap = nullptr;
+			ReleaseMemory();
+		}
+		return true;
 	}
 
-	Init(w, h, (void *) NULL);
-
-	ConvertImage(w, h, pixels, transparent);
-
 	CheckPixels(flags);
+	return true;
 }
 
 Bitmap::Bitmap(Bitmap const& source, Rect const& src_rect, bool transparent) {
@@ -199,6 +266,7 @@ Bitmap::~Bitmap() {
 	if (bitmap) {
 		pixman_image_unref(bitmap);
 	}
+	ReleaseMemory();
 }
 
 bool Bitmap::WritePNG(std::ostream& os) const {
@@ -236,29 +304,13 @@ bool Bitmap::GetTransparent() const {
 	return format.alpha_type != PF::NoAlpha;
 }
 
-Bitmap::TileOpacity Bitmap::CheckOpacity(const Rect& rect) {
-	bool all = true;
-	bool any = false;
-
-	DynamicFormat format(32,8,24,8,16,8,8,8,0,PF::Alpha);
-	std::vector<uint32_t> pixels;
-	pixels.resize(rect.width * rect.height);
-	Bitmap bmp(reinterpret_cast<void*>(&pixels.front()), rect.width, rect.height, rect.width*4, format);
-	bmp.Blit(0, 0, *this, rect, Opacity::opaque);
-
-	for (std::vector<uint32_t>::const_iterator p = pixels.begin(); p != pixels.end(); ++p) {
-		if ((*p & 0xFF) != 0)
-			any = true;
-		else
-			all = false;
-		if (any && !all)
-			break;
+namespace {
+	Bitmap::TileOpacity ClassifyAlpha(uint8_t min_alpha, uint8_t max_alpha) {
+		return
+			min_alpha == 0xFF ? Bitmap::Opaque :
+			max_alpha == 0 ? Bitmap::Transparent :
+			Bitmap::Partial;
 	}
-
-	return
-		all ? Bitmap::Opaque :
-		any ? Bitmap::Partial :
-		Bitmap::Transparent;
 }
 
 void Bitmap::CheckPixels(uint32_t flags) {
@@ -274,22 +326,106 @@ void Bitmap::CheckPixels(uint32_t flags) {
 		sh_color = Color((int)(pixel>>24)&0xFF, (int)(pixel>>16)&0xFF, (int)(pixel>>8)&0xFF, (int)pixel&0xFF);
 	}
 
-	if (flags & Flag_Chipset) {
-		tile_opacity.clear();
-		tile_opacity.resize(height() / 16);
-		for (int row = 0; row < height() / 16; row++) {
-			tile_opacity[row].resize(width() / 16);
-			for (int col = 0; col < width() / 16; col++) {
-				Rect rect(col * 16, row * 16, 16, 16);
-				tile_opacity[row][col] = CheckOpacity(rect);
+	if (!(flags & (Flag_Chipset | Flag_ReadOnly)))
+		return;
+
+	const int w = width();
+	const int h = height();
+	const int tiles_x = w / 16;
+	const int tiles_y = h / 16;
+
+	// Alpha is read straight from the pixels when the format has 8 bit alpha,
+	// other formats are converted one row at a time.
+	const bool has_alpha = GetTransparent() && format.a.bits > 0;
+	const bool direct = format.bits == 32 && format.a.bits == 8;
+	const int alpha_shift = direct ? format.a.shift : 0;
+
+	ScratchArena::Buffer<uint32_t> line(has_alpha && !direct ? w + 1 : 0);
+	pixman_image_t* line_image = nullptr;
+	if (has_alpha && !direct) {
+		DynamicFormat line_format(32,8,24,8,16,8,8,8,0,PF::Alpha);
+		line_image = pixman_image_create_bits(find_format(line_format), w, 1, line.data(), w * 4);
+	}
+
+	ScratchArena::Buffer<uint8_t> alpha(w + 1, 0xFF);
+	ScratchArena::Buffer<uint8_t> tile_min(tiles_x);
+	ScratchArena::Buffer<uint8_t> tile_max(tiles_x);
+	uint8_t image_min = 0xFF;
+	uint8_t image_max = 0;
+
+	tile_opacity.clear();
+	row_opacity.clear();
+	if (flags & Flag_Chipset)
+		tile_opacity.resize(tiles_y, std::vector<TileOpacity>(tiles_x));
+	if (flags & Flag_ReadOnly)
+		row_opacity.resize(h);
+
+	for (int y = 0; y < h; y++) {
+		if (has_alpha) {
+			const uint32_t* src;
+			if (direct) {
+				src = (const uint32_t*) ((const uint8_t*) pixels() + y * pitch());
+			} else {
+				pixman_image_composite32(PIXMAN_OP_SRC, bitmap, (pixman_image_t*) NULL, line_image,
+										 0, y,  0, 0,  0, 0,  w, 1);
+				src = line.data();
+			}
+			// Plain loops without early exits, the compiler vectorizes them
+			for (int x = 0; x < w; x++)
+				alpha[x] = (uint8_t) (src[x] >> alpha_shift);
+		}
+
+		if (y % 16 == 0) {
+			std::fill(tile_min.begin(), tile_min.end(), 0xFF);
+			std::fill(tile_max.begin(), tile_max.end(), 0);
+		}
+
+		for (int col = 0; col < tiles_x; col++) {
+			const uint8_t* a = &alpha[col * 16];
+			uint8_t lo = tile_min[col];
+			uint8_t hi = tile_max[col];
+			for (int i = 0; i < 16; i++) {
+				lo = std::min(lo, a[i]);
+				hi = std::max(hi, a[i]);
 			}
+			tile_min[col] = lo;
+			tile_max[col] = hi;
+		}
+
+		if (y % 16 == 15 && y / 16 < tiles_y && !tile_opacity.empty()) {
+			for (int col = 0; col < tiles_x; col++)
+				tile_opacity[y / 16][col] = ClassifyAlpha(tile_min[col], tile_max[col]);
+		}
+
+		uint8_t row_min = 0xFF;
+		uint8_t row_max = 0;
+		for (int x = 0; x < w; x++) {
+			row_min = std::min(row_min, alpha[x]);
+			row_max = std::max(row_max, alpha[x]);
+		}
+		image_min = std::min(image_min, row_min);
+		image_max = std::max(image_max, row_max);
+
+		if (!row_opacity.empty()) {
+			RowOpacity& row = row_opacity[y];
+			row.begin = 0;
+			while (row.begin < w && alpha[row.begin] == 0)
+				row.begin++;
+			row.end = w;
+			while (row.end > row.begin && alpha[row.end - 1] == 0)
+				row.end--;
+			row.opaque = row_min == 0xFF || std::all_of(&alpha[row.begin], &alpha[row.end],
+				[](uint8_t a) { return a == 0xFF; });
 		}
 	}
 
+	if (line_image)
+		pixman_image_unref(line_image);
+
 	if (flags & Flag_ReadOnly) {
 		read_only = true;
 
-		opacity = CheckOpacity(GetRect());
+		opacity = ClassifyAlpha(image_min, image_max);
 	}
 }
 
@@ -301,6 +437,34 @@ Bitmap::TileOpacity Bitmap::GetTileOpacity(int row, int col) const {
 	return !tile_opacity.empty() ? tile_opacity[row][col] : Partial;
 }
 
+Bitmap::TileOpacity Bitmap::GetOpacity(Rect const& rect) const {
+	// Pixels outside of the bitmap are transparent
+	Rect area = rect;
+	area.Adjust(GetRect());
+	if (area.IsEmpty())
+		return Transparent;
+
+	if (row_opacity.empty() || opacity != Partial)
+		return opacity;
+
+	bool all = area == rect;
+	bool any = false;
+	for (int y = area.y; y < area.y + area.height; y++) {
+		const RowOpacity& row = row_opacity[y];
+		if (std::max(row.begin, area.x) < std::min(row.end, area.x + area.width))
+			any = true;
+		if (!row.opaque || row.begin > area.x || row.end < area.x + area.width)
+			all = false;
+		if (any && !all)
+			return Partial;
+	}
+
+	return
+		all ? Bitmap::Opaque :
+		any ? Bitmap::Partial :
+		Bitmap::Transparent;
+}
+
 Color Bitmap::GetBackgroundColor() const {
 	return bg_color;
 }
@@ -324,12 +488,11 @@ void Bitmap::HueChangeBlit(int x, int y, Bitmap const& src, Rect const& src_rect
 		hue -= (hue / 0x600) * 0x600;
 
 	DynamicFormat format(32,8,24,8,16,8,8,8,0,PF::Alpha);
-	std::vector<uint32_t> pixels;
-	pixels.resize(src_rect.width * src_rect.height);
-	Bitmap bmp(reinterpret_cast<void*>(&pixels.front()), src_rect.width, src_rect.height, src_rect.width * 4, format);
+	ScratchArena::Buffer<uint32_t> pixels(src_rect.width * src_rect.height);
+	Bitmap bmp(reinterpret_cast<void*>(pixels.data()), src_rect.width, src_rect.height, src_rect.width * 4, format);
 	bmp.Blit(0, 0, src, src_rect, Opacity::opaque);
 
-	for (std::vector<uint32_t>::iterator p = pixels.begin(); p != pixels.end(); ++p) {
+	for (uint32_t* p = pixels.begin(); p != pixels.end(); ++p) {
 		uint32_t pixel = *p;
 		uint8_t r = (pixel>>24) & 0xFF;
 		uint8_t g = (pixel>>16) & 0xFF;
@@ -492,6 +655,9 @@ void Bitmap::SetFormat(const DynamicFormat& format) {
 	opaque_pixel_format.alpha_type = PF::NoAlpha;
 	image_format = format_R8G8B8A8_a().format();
 	opaque_image_format = format_R8G8B8A8_n().format();
+
+	// Pooled bitmaps still use the previous format
+	BitmapPool::Clear();
 }
 
 DynamicFormat Bitmap::ChooseFormat(const DynamicFormat& format) {
@@ -551,27 +717,35 @@ void Bitmap::Init(int width, int height, void* data, int pitch, bool destroy) {
 
 	if (data != NULL && destroy)
 		pixman_image_set_destroy_function(bitmap, destroy_func, data);
+
+	// Wrapped pixels are owned by somebody else
+	if (bitmap && (data == NULL || destroy)) {
+		ReleaseMemory();
+		memory_size = (int64_t)pixman_image_get_stride(bitmap) * height;
+		MemoryStats::Add(memory_category, memory_size);
+		memory_fresh = true;
+	}
 }
 
-void Bitmap::ConvertImage(int& width, int& height, void*& pixels, bool transparent) {
-	const DynamicFormat& img_format = transparent ? image_format : opaque_image_format;
+void Bitmap::ReleaseMemory() {
+	if (memory_size > 0) {
+		MemoryStats::Remove(memory_category, memory_size);
+		memory_size = 0;
+		memory_fresh = false;
+	}
+}
 
-	// premultiply alpha
-	for (int y = 0; y < height; y++) {
-		uint8_t* dst = (uint8_t*) pixels + y * width * 4;
-		for (int x = 0; x < width; x++) {
-			uint8_t &r = *dst++;
-			uint8_t &g = *dst++;
-			uint8_t &b = *dst++;
-			uint8_t &a = *dst++;
-			MultiplyAlpha(r, g, b, a);
-		}
+void Bitmap::SetMemoryCategory(MemoryStats::Category category) {
+	if (category == memory_category) {
+		memory_fresh = false;
+		return;
 	}
 
-	Bitmap src(pixels, width, height, 0, img_format);
-	Clear();
-	Blit(0, 0, src, src.GetRect(), Opacity::opaque);
-	free(pixels);
+	if (memory_size > 0) {
+		MemoryStats::Move(memory_category, category, memory_size, memory_fresh);
+	}
+	memory_category = category;
+	memory_fresh = false;
 }
 
 void* Bitmap::pixels() {
@@ -602,16 +776,40 @@ int Bitmap::pitch() const {
 }
 
 namespace {
+	/** Solid masks by opacity, only used by the thread owning the ScratchArena */
+	pixman_image_t* solid_masks[256];
+
+	void ReleaseMaskBits(pixman_image_t* /* image */, void* data) {
+		ScratchArena::Release(data, 8);
+	}
+
 	pixman_image_t *CreateMask(Opacity const& opacity, Rect const& src_rect, Transform const* pxform = nullptr) {
 		if (opacity.IsOpaque())
 			return (pixman_image_t*) NULL;
 
+		bool scratch = ScratchArena::IsAvailable();
+
 		if (!opacity.IsSplit()) {
-			pixman_color_t tcolor = {0, 0, 0, static_cast<uint16_t>(opacity.Value() << 8)};
-			return pixman_image_create_solid_fill(&tcolor);
+			int value = std::min(std::max(opacity.Value(), 0), 255);
+			pixman_color_t tcolor = {0, 0, 0, static_cast<uint16_t>(value << 8)};
+			if (!scratch) {
+				return pixman_image_create_solid_fill(&tcolor);
+			}
+
+			// Reused, the caller releases its reference as usual
+			if (!solid_masks[value]) {
+				solid_masks[value] = pixman_image_create_solid_fill(&tcolor);
+			}
+			return pixman_image_ref(solid_masks[value]);
 		}
 
-		pixman_image_t *mask = pixman_image_create_bits(PIXMAN_a8, 1, 2, (uint32_t*) NULL, 4);
+		// The two mask pixels only live until the blit finished, they are
+		// returned to the arena when the caller releases the mask
+		uint32_t* bits = scratch ? static_cast<uint32_t*>(ScratchArena::Allocate(8)) : (uint32_t*) NULL;
+		pixman_image_t *mask = pixman_image_create_bits(PIXMAN_a8, 1, 2, bits, 4);
+		if (bits) {
+			pixman_image_set_destroy_function(mask, ReleaseMaskBits, bits);
+		}
 		uint32_t* pixels = pixman_image_get_data(mask);
 		*reinterpret_cast<uint8_t*>(&pixels[0]) = (opacity.top & 0xFF);
 		*reinterpret_cast<uint8_t*>(&pixels[1]) = (opacity.bottom & 0xFF);
@@ -626,15 +824,149 @@ namespace {
 
 		return mask;
 	}
+
+	/** x * y / 255, rounded like pixman does */
+	inline uint32_t MulUn8(uint32_t x, uint32_t y) {
+		uint32_t t = x * y + 0x80;
+		return ((t >> 8) + t) >> 8;
+	}
+
+	bool IsRgba8888(const DynamicFormat& format) {
+		return format.bits == 32 && format.r.bits == 8 && format.g.bits == 8 && format.b.bits == 8;
+	}
+
+	/**
+	 * The span rasteriser works on two channels of a 32 bit pixel at once
+	 * and requires that source and destination share the same layout.
+	 */
+	bool IsSpanCompatible(const DynamicFormat& dst, const DynamicFormat& src) {
+		return IsRgba8888(dst) && IsRgba8888(src) &&
+			dst.r.shift == src.r.shift && dst.g.shift == src.g.shift && dst.b.shift == src.b.shift;
+	}
+
+	/** Multiplies all channels of a premultiplied pixel with m / 255 */
+	inline uint32_t MulPixel(uint32_t p, uint32_t m) {
+		uint32_t rb = (p & 0x00FF00FF) * m + 0x00800080;
+		rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+		uint32_t ag = ((p >> 8) & 0x00FF00FF) * m + 0x00800080;
+		ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+		return rb | ag;
+	}
+
+	/** Adds all channels of two pixels, saturating at 255 */
+	inline uint32_t AddPixel(uint32_t a, uint32_t b) {
+		uint32_t rb = (a & 0x00FF00FF) + (b & 0x00FF00FF);
+		rb = (rb | (0x01000100 - ((rb >> 8) & 0x00010001))) & 0x00FF00FF;
+		uint32_t ag = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF);
+		ag = (ag | (0x01000100 - ((ag >> 8) & 0x00010001))) & 0x00FF00FF;
+		return rb | (ag << 8);
+	}
+
+	/** Linear interpolation between two pixels, w is the weight of b in 1/256 */
+	inline uint32_t LerpPixel(uint32_t a, uint32_t b, uint32_t w) {
+		uint32_t rb = (((a & 0x00FF00FF) * (256 - w) + (b & 0x00FF00FF) * w) >> 8) & 0x00FF00FF;
+		uint32_t ag = (((a >> 8) & 0x00FF00FF) * (256 - w) + ((b >> 8) & 0x00FF00FF) * w) & 0xFF00FF00;
+		return rb | ag;
+	}
+
+	/**
+	 * Source of the span rasteriser.
+	 * Pixels outside of the source rect are transparent, sources without
+	 * alpha channel are read as opaque.
+	 */
+	struct SpanSource {
+		const uint8_t* pixels;
+		int pitch;
+		Rect rect;
+		uint32_t alpha_fill;
+
+		SpanSource(const uint8_t* pixels, int pitch, Rect const& rect, const DynamicFormat& format) :
+			pixels(pixels), pitch(pitch), rect(rect),
+			alpha_fill(format.alpha_type == PF::NoAlpha ? ~(format.r.mask | format.g.mask | format.b.mask) : 0) {}
+
+		inline uint32_t Get(int x, int y) const {
+			if (x < rect.x || y < rect.y || x >= rect.x + rect.width || y >= rect.y + rect.height)
+				return 0;
+			return reinterpret_cast<const uint32_t*>(pixels + y * pitch)[x] | alpha_fill;
+		}
+
+		/** Bilinear sample, u and v are 16.16 fixed point coordinates */
+		inline uint32_t Sample(int32_t u, int32_t v) const {
+			u -= 0x8000;
+			v -= 0x8000;
+			int x0 = u >> 16;
+			int y0 = v >> 16;
+			uint32_t wx = (u >> 8) & 0xFF;
+			uint32_t wy = (v >> 8) & 0xFF;
+			uint32_t top = LerpPixel(Get(x0, y0), Get(x0 + 1, y0), wx);
+			uint32_t bottom = LerpPixel(Get(x0, y0 + 1), Get(x0 + 1, y0 + 1), wx);
+			return LerpPixel(top, bottom, wy);
+		}
+	};
+
+	/** PIXMAN_OP_OVER of a premultiplied span pixel scaled by opacity */
+	inline void OverSpanPixel(uint32_t& d, uint32_t s, uint32_t opacity, int alpha_shift) {
+		if (opacity < 255)
+			s = MulPixel(s, opacity);
+		uint32_t a = (s >> alpha_shift) & 0xFF;
+		if (a == 255)
+			d = s;
+		else if (a != 0)
+			// Bilinear sampling can produce channels above alpha, the sum
+			// must not carry into the next channel
+			d = AddPixel(s, MulPixel(d, 255 - a));
+	}
+
+	/**
+	 * Narrows [t0, t1) to the steps t at which start + t * step
+	 * is inside of [lo, hi).
+	 */
+	void ClipSpan(int64_t start, int64_t step, int64_t lo, int64_t hi, int& t0, int& t1) {
+		if (step == 0) {
+			if (start < lo || start >= hi)
+				t1 = t0;
+			return;
+		}
+		// first and last step inside the range, rounded outwards
+		int64_t a = (step > 0 ? lo - start : hi - 1 - start);
+		int64_t b = (step > 0 ? hi - 1 - start : lo - start);
+		if (step < 0) {
+			a = -a;
+			b = -b;
+			step = -step;
+		}
+		int64_t first = a <= 0 ? -((-a) / step) : (a + step - 1) / step;
+		int64_t last = b < 0 ? -((-b + step - 1) / step) : b / step;
+		t0 = static_cast<int>(std::max<int64_t>(t0, first));
+		t1 = static_cast<int>(std::min<int64_t>(t1, last + 1));
+		if (t1 < t0)
+			t1 = t0;
+	}
 } // anonymous namespace
 
+void Bitmap::ReleaseMasks() {
+	for (pixman_image_t*& mask : solid_masks) {
+		if (mask) {
+			pixman_image_unref(mask);
+			mask = nullptr;
+		}
+	}
+}
+
 void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity const& opacity) {
 	if (opacity.IsTransparent())
 		return;
 
+	// Read only sources know which parts of them are opaque
+	TileOpacity src_opacity = src.GetOpacity(src_rect);
+	if (src_opacity == Transparent)
+		return;
+
 	pixman_image_t* mask = CreateMask(opacity, src_rect);
 
-	pixman_image_composite32(src.GetOperator(mask),
+	pixman_op_t op = (!mask && src_opacity == Opaque) ? PIXMAN_OP_SRC : src.GetOperator(mask);
+
+	pixman_image_composite32(op,
 							 src.bitmap,
 							 mask, bitmap,
 							 src_rect.x, src_rect.y,
@@ -731,13 +1063,67 @@ void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& sr
 		pixman_image_unref(mask);
 }
 
-void Bitmap::TransformBlit(Rect const& dst_rect, Bitmap const& src, Rect const& /* src_rect */, const Transform& xform, Opacity const& opacity) {
+void Bitmap::TransformBlit(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect, const Transform& xform, Opacity const& opacity) {
 	if (opacity.IsTransparent())
 		return;
 
+	const pixman_fixed_t (*m)[3] = xform.matrix.matrix;
+	bool affine = m[2][0] == 0 && m[2][1] == 0 && m[2][2] == pixman_fixed_1;
+	if (affine && IsSpanCompatible(format, src.format)) {
+		Rect rect = dst_rect;
+		rect.Adjust(GetRect());
+		Rect clip = src_rect;
+		clip.Adjust(src.GetRect());
+		if (rect.IsEmpty() || clip.IsEmpty())
+			return;
+
+		SpanSource source(reinterpret_cast<const uint8_t*>(src.pixels()), src.pitch(), clip, src.format);
+		int alpha_shift = 48 - format.r.shift - format.g.shift - format.b.shift;
+		uint32_t top = std::min(std::max(opacity.top, 0), 255);
+		uint32_t bottom = std::min(std::max(opacity.bottom, 0), 255);
+		bool split = opacity.IsSplit();
+		int split_row = src_rect.y + src_rect.height - opacity.split;
+
+		// The bilinear footprint reaches half a pixel beyond the source rect
+		int64_t u_lo = (static_cast<int64_t>(clip.x) << 16) - 0x8000;
+		int64_t u_hi = (static_cast<int64_t>(clip.x + clip.width) << 16) + 0x8000;
+		int64_t v_lo = (static_cast<int64_t>(clip.y) << 16) - 0x8000;
+		int64_t v_hi = (static_cast<int64_t>(clip.y + clip.height) << 16) + 0x8000;
+		int32_t du = m[0][0];
+		int32_t dv = m[1][0];
+
+		uint8_t* dst_pixels = reinterpret_cast<uint8_t*>(pixels());
+		for (int dy = rect.y; dy < rect.y + rect.height; ++dy) {
+			// Source position of the first pixel center in the row
+			int64_t px = (static_cast<int64_t>(rect.x) << 16) + 0x8000;
+			int64_t py = (static_cast<int64_t>(dy) << 16) + 0x8000;
+			int64_t u = ((m[0][0] * px + m[0][1] * py) >> 16) + m[0][2];
+			int64_t v = ((m[1][0] * px + m[1][1] * py) >> 16) + m[1][2];
+
+			int t0 = 0;
+			int t1 = rect.width;
+			ClipSpan(u, du, u_lo, u_hi, t0, t1);
+			ClipSpan(v, dv, v_lo, v_hi, t0, t1);
+
+			if (t0 >= t1)
+				continue;
+
+			uint32_t* dst = reinterpret_cast<uint32_t*>(dst_pixels + dy * pitch()) + rect.x + t0;
+			int32_t su = static_cast<int32_t>(u + static_cast<int64_t>(t0) * du);
+			int32_t sv = static_cast<int32_t>(v + static_cast<int64_t>(t0) * dv);
+			for (int t = t0; t < t1; ++t) {
+				uint32_t op = (!split || (sv >> 16) < split_row) ? top : bottom;
+				OverSpanPixel(*dst++, source.Sample(su, sv), op, alpha_shift);
+				su += du;
+				sv += dv;
+			}
+		}
+		return;
+	}
+
 	pixman_image_set_transform(src.bitmap, &xform.matrix);
 
-	pixman_image_t* mask = CreateMask(opacity, src.GetRect(), &xform);
+	pixman_image_t* mask = CreateMask(opacity, src_rect, &xform);
 
 	pixman_image_composite32(PIXMAN_OP_OVER,
 							 src.bitmap, mask, bitmap,
@@ -756,6 +1142,58 @@ void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const&
 	if (opacity.IsTransparent())
 		return;
 
+	if (IsSpanCompatible(format, src.format)) {
+		// Samples the same source pixels as the pixman path below: the
+		// whole source is visible, the row is not offset by src_rect.y and
+		// src_rect.x is scaled like the destination columns
+		SpanSource source(reinterpret_cast<const uint8_t*>(src.pixels()), src.pitch(), src.GetRect(), src.format);
+		int alpha_shift = 48 - format.r.shift - format.g.shift - format.b.shift;
+		uint32_t top = std::min(std::max(opacity.top, 0), 255);
+		uint32_t bottom = std::min(std::max(opacity.bottom, 0), 255);
+		int split_row = opacity.IsSplit() ? src_rect.height - opacity.split : src_rect.height;
+
+		// The wave offset only depends on the source row
+		ScratchArena::Buffer<int> offsets(src_rect.height);
+		for (int sy = 0; sy < src_rect.height; ++sy) {
+			offsets[sy] = (int) (2 * zoom_x * depth * sin((phase + (src_rect.y + sy) * 11.2) * 3.14159 / 180));
+		}
+
+		int height = static_cast<int>(std::floor(src_rect.height * zoom_y));
+		int width  = static_cast<int>(std::floor(src_rect.width * zoom_x));
+		bool nearest = zoom_x == 1.0 && zoom_y == 1.0;
+		int32_t du = static_cast<int32_t>(65536.0 / zoom_x);
+
+		uint8_t* dst_pixels = reinterpret_cast<uint8_t*>(pixels());
+		for (int i = std::max(0, -y); i < std::min(height, this->height() - y); i++) {
+			int sy = std::min(static_cast<int>(std::floor((i+0.5) / zoom_y)), src_rect.height - 1);
+			uint32_t op = sy < split_row ? top : bottom;
+			if (op == 0)
+				continue;
+
+			int dx = x + offsets[sy];
+			int t0 = std::max(0, -dx);
+			int t1 = std::min(width, this->width() - dx);
+			if (t0 >= t1)
+				continue;
+
+			uint32_t* dst = reinterpret_cast<uint32_t*>(dst_pixels + (y + i) * pitch()) + dx + t0;
+
+			if (nearest) {
+				for (int t = t0; t < t1; ++t) {
+					OverSpanPixel(*dst++, source.Get(src_rect.x + t, sy), op, alpha_shift);
+				}
+			} else {
+				int32_t su = static_cast<int32_t>((src_rect.x + t0 + 0.5) / zoom_x * 65536.0);
+				int32_t sv = static_cast<int32_t>((i + 0.5) / zoom_y * 65536.0);
+				for (int t = t0; t < t1; ++t) {
+					OverSpanPixel(*dst++, source.Sample(su, sv), op, alpha_shift);
+					su += du;
+				}
+			}
+		}
+		return;
+	}
+
 	Transform xform = Transform::Scale(1.0 / zoom_x, 1.0 / zoom_y);
 
 	pixman_image_set_transform(src.bitmap, &xform.matrix);
@@ -843,6 +1281,12 @@ void Bitmap::ClearRect(Rect const& dst_rect) {
 static uint8_t hard_light_lookup[256][256];
 
 static void make_hard_light_lookup() {
+	static bool index_made = false;
+	if (index_made) {
+		return;
+	}
+	index_made = true;
+
 	for (int i = 0; i < 256; ++i) {
 		for (int j = 0; j < 256; ++j) {
 			int res = 0;
@@ -928,11 +1372,7 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 	}
 
 	if (tone.red != 128 || tone.green != 128 || tone.blue != 128) {
-		static bool index_made = false;
-		if (!index_made) {
-			make_hard_light_lookup();
-			index_made = true;
-		}
+		make_hard_light_lookup();
 
 		int as = pixel_format.a.shift;
 		int rs = pixel_format.r.shift;
@@ -995,6 +1435,152 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 	pixman_image_unref(timage);
 }
 
+void Bitmap::ToneBlendFlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect,
+							   const Tone& tone, const Color& color, bool horizontal, bool vertical,
+							   Opacity const& opacity) {
+	if (opacity.IsTransparent()) {
+		return;
+	}
+
+	if (!IsRgba8888(format) || !IsRgba8888(src.format)) {
+		// Render the effects into a temporary bitmap first
+		BitmapRef effects = BitmapPool::Get(src_rect.width, src_rect.height, true);
+		effects->BlendBlit(0, 0, src, src_rect, color, Opacity::opaque);
+		effects->ToneBlit(0, 0, *effects, effects->GetRect(), tone, Opacity::opaque);
+		effects->Flip(effects->GetRect(), horizontal, vertical);
+		Blit(x, y, *effects, effects->GetRect(), opacity);
+		return;
+	}
+
+	int x0 = std::max(0, -x);
+	int y0 = std::max(0, -y);
+	int x1 = std::min(src_rect.width, width() - x);
+	int y1 = std::min(src_rect.height, height() - y);
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	bool gray = tone.gray != 128;
+	bool hard_light = tone.red != 128 || tone.green != 128 || tone.blue != 128;
+	if (hard_light) {
+		make_hard_light_lookup();
+	}
+
+	int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+	uint32_t flash = color.alpha;
+
+	const Component& sr = src.format.r;
+	const Component& sg = src.format.g;
+	const Component& sb = src.format.b;
+	const Component& sa = src.format.a;
+	bool src_alpha = src.format.alpha_type != PF::NoAlpha && sa.bits == 8;
+
+	const Component& dr = format.r;
+	const Component& dg = format.g;
+	const Component& db = format.b;
+	const Component& da = format.a;
+	uint32_t dst_alpha_mask = da.bits == 8 ? 0xFFu << da.shift : 0;
+
+	// Rows below the split use the bottom opacity (bush depth)
+	int split_row = opacity.IsSplit() ? src_rect.height - opacity.split : src_rect.height;
+
+	const uint8_t* src_pixels = (const uint8_t*) src.pixels();
+	uint8_t* dst_pixels = (uint8_t*) pixels();
+
+	for (int i = y0; i < y1; ++i) {
+		int op = i < split_row ? opacity.top : opacity.bottom;
+		if (op <= 0) {
+			continue;
+		}
+		uint32_t m = op >= 255 ? 255 : op;
+
+		int sy = src_rect.y + (vertical ? src_rect.height - 1 - i : i);
+		const uint32_t* src_row = (const uint32_t*) (src_pixels + sy * src.pitch());
+		uint32_t* dst_row = (uint32_t*) (dst_pixels + (y + i) * pitch()) + x;
+
+		for (int j = x0; j < x1; ++j) {
+			int sx = src_rect.x + (horizontal ? src_rect.width - 1 - j : j);
+			uint32_t pixel = src_row[sx];
+
+			uint32_t a = src_alpha ? (pixel >> sa.shift) & 0xFF : 255;
+			if (a == 0) {
+				continue;
+			}
+			uint32_t r = (pixel >> sr.shift) & 0xFF;
+			uint32_t g = (pixel >> sg.shift) & 0xFF;
+			uint32_t b = (pixel >> sb.shift) & 0xFF;
+
+			// Flash color, masked by the source alpha (see BlendBlit)
+			if (flash != 0) {
+				uint32_t f = MulUn8(flash, a);
+				r = MulUn8(color.red, f) + MulUn8(r, 255 - f);
+				g = MulUn8(color.green, f) + MulUn8(g, 255 - f);
+				b = MulUn8(color.blue, f) + MulUn8(b, 255 - f);
+				a = f + MulUn8(a, 255 - f);
+			}
+
+			// Saturation and color tone (see ToneBlit)
+			if (gray) {
+				int lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
+				int red = (lum * 1024 + ((int) r - lum) * sat) >> 10;
+				int green = (lum * 1024 + ((int) g - lum) * sat) >> 10;
+				int blue = (lum * 1024 + ((int) b - lum) * sat) >> 10;
+				r = red > 255 ? 255 : red < 0 ? 0 : red;
+				g = green > 255 ? 255 : green < 0 ? 0 : green;
+				b = blue > 255 ? 255 : blue < 0 ? 0 : blue;
+			}
+			if (hard_light) {
+				r = hard_light_lookup[tone.red][r];
+				g = hard_light_lookup[tone.green][g];
+				b = hard_light_lookup[tone.blue][b];
+			}
+
+			// Composite with PIXMAN_OP_OVER
+			if (m != 255) {
+				r = MulUn8(r, m);
+				g = MulUn8(g, m);
+				b = MulUn8(b, m);
+				a = MulUn8(a, m);
+			}
+
+			if (a != 255) {
+				// The tone can raise a color above the alpha, saturate like pixman
+				uint32_t d = dst_row[j];
+				uint32_t inv = 255 - a;
+				r = std::min(r + MulUn8((d >> dr.shift) & 0xFF, inv), 255u);
+				g = std::min(g + MulUn8((d >> dg.shift) & 0xFF, inv), 255u);
+				b = std::min(b + MulUn8((d >> db.shift) & 0xFF, inv), 255u);
+				a += dst_alpha_mask ? MulUn8((d >> da.shift) & 0xFF, inv) : 0;
+			}
+
+			dst_row[j] = (r << dr.shift) | (g << dg.shift) | (b << db.shift) |
+				((a << da.shift) & dst_alpha_mask);
+		}
+	}
+}
+
+void Bitmap::ToneTiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, const Tone& tone, Opacity const& opacity) {
+	if (opacity.IsTransparent() || src_rect.IsEmpty())
+		return;
+
+	// Source offset of the first tile, same direction as TiledBlit
+	ox %= src_rect.width;
+	oy %= src_rect.height;
+	if (ox < 0) ox += src_rect.width;
+	if (oy < 0) oy += src_rect.height;
+
+	for (int ty = 0, sy = oy; ty < dst_rect.height; sy = 0) {
+		int h = std::min(src_rect.height - sy, dst_rect.height - ty);
+		for (int tx = 0, sx = ox; tx < dst_rect.width; sx = 0) {
+			int w = std::min(src_rect.width - sx, dst_rect.width - tx);
+			ToneBlendFlipBlit(dst_rect.x + tx, dst_rect.y + ty, src,
+				Rect(src_rect.x + sx, src_rect.y + sy, w, h), tone, Color(), false, false, opacity);
+			tx += w;
+		}
+		ty += h;
+	}
+}
+
 void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool horizontal, bool vertical, Opacity const& opacity) {
 	if (!horizontal && !vertical) {
 		Blit(x, y, src, src_rect, opacity);
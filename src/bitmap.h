@@ -28,6 +28,7 @@
 #include "system.h"
 #include "color.h"
 #include "rect.h"
+#include "memory_stats.h"
 #include "pixel_format.h"
 #include "tone.h"
 #include "text.h"
@@ -213,6 +214,18 @@ public:
 	 */
 	TileOpacity GetTileOpacity(int row, int col) const;
 
+	/**
+	 * Provides opacity information about an area of the image.
+	 * Uses the per row summary of read only bitmaps, for other bitmaps
+	 * this is the same as GetOpacity(). Areas outside of the bitmap are
+	 * Transparent.
+	 *
+	 * @param rect area to check
+	 *
+	 * @return opacity information
+	 */
+	TileOpacity GetOpacity(Rect const& rect) const;
+
 	/**
 	 * Writes PNG converted bitmap to output stream.
 	 *
@@ -237,6 +250,12 @@ public:
 	 */
 	Color GetShadowColor() const;
 
+	/**
+	 * Collects the information requested by the flags, see Flags.
+	 * The opacity information is gathered in one pass over the pixels.
+	 *
+	 * @param flags Flags
+	 */
 	void CheckPixels(uint32_t flags);
 
 	/**
@@ -482,6 +501,40 @@ public:
 	 */
 	void BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Color &color, Opacity const& opacity);
 
+	/**
+	 * Blits a bitmap with flash color, tone and flip applied in one pass.
+	 * The result matches BlendBlit, ToneBlit and Flip into a temporary
+	 * bitmap followed by a Blit of it, without rendering the temporary
+	 * bitmap.
+	 *
+	 * @param x x position.
+	 * @param y y position.
+	 * @param src source bitmap.
+	 * @param src_rect source bitmap rect, must be inside of src.
+	 * @param tone tone to apply.
+	 * @param color flash color to apply.
+	 * @param horizontal flip horizontally (mirror).
+	 * @param vertical flip vertically.
+	 * @param opacity opacity.
+	 */
+	void ToneBlendFlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect,
+						   const Tone& tone, const Color& color, bool horizontal, bool vertical,
+						   Opacity const& opacity);
+
+	/**
+	 * Blits source bitmap in tiles with tone applied.
+	 * Only the parts of the source that end up in dst_rect are toned.
+	 *
+	 * @param ox tile start x offset.
+	 * @param oy tile start y offset.
+	 * @param src_rect source bitmap rect, must be inside of src.
+	 * @param src source bitmap.
+	 * @param dst_rect destination rect.
+	 * @param tone tone to apply.
+	 * @param opacity opacity, split opacity is applied per tile.
+	 */
+	void ToneTiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, const Tone& tone, Opacity const& opacity);
+
 	/**
 	 * Flips the bitmap pixels.
 	 *
@@ -575,12 +628,44 @@ public:
 	int bpp() const;
 	int pitch() const;
 
-protected:
-	TileOpacity CheckOpacity(Rect const& rect);
+	/**
+	 * Accounts the pixel memory to a subsystem, see MemoryStats.
+	 * New bitmaps are accounted to Category_Bitmap. The first call after
+	 * the pixels were allocated moves the allocation as well, later calls
+	 * only move the live memory.
+	 *
+	 * @param category owning subsystem.
+	 */
+	void SetMemoryCategory(MemoryStats::Category category);
 
+	/**
+	 * Frees the opacity masks that are reused while the ScratchArena is
+	 * available. Called before the ScratchArena quits.
+	 */
+	static void ReleaseMasks();
+
+protected:
 	DynamicFormat format;
 
+	/** Size of the owned pixel memory */
+	int64_t memory_size = 0;
+	MemoryStats::Category memory_category = MemoryStats::Category_Bitmap;
+	/** Pixel memory was allocated but not assigned to a subsystem yet */
+	bool memory_fresh = false;
+
+	/** Removes the owned pixel memory from the statistics. */
+	void ReleaseMemory();
+
+	/** Columns of a row that are not fully transparent. */
+	struct RowOpacity {
+		int begin;
+		int end;
+		/** All pixels in [begin, end) are fully opaque */
+		bool opaque;
+	};
+
 	std::vector<std::vector<TileOpacity>> tile_opacity;
+	std::vector<RowOpacity> row_opacity;
 	TileOpacity opacity = Partial;
 	Color bg_color, sh_color;
 
@@ -598,7 +683,20 @@ protected:
 	pixman_format_code_t pixman_format;
 
 	void Init(int width, int height, void* data, int pitch = 0, bool destroy = true);
-	void ConvertImage(int& width, int& height, void*& pixels, bool transparent);
+
+	/** Receives the rows of the image decoders, see bitmap.cpp. */
+	class ImageConverter;
+
+	/**
+	 * Decodes an image file that is in memory.
+	 *
+	 * @param data image file contents
+	 * @param bytes size of data
+	 * @param transparent allow transparency on bitmap
+	 * @param flags see Flags
+	 * @return false when the image format is not supported
+	 */
+	bool Decode(const uint8_t* data, unsigned bytes, bool transparent, uint32_t flags);
 
 	static pixman_image_t* GetSubimage(Bitmap const& src, const Rect& src_rect);
 	static inline void MultiplyAlpha(uint8_t &r, uint8_t &g, uint8_t &b, const uint8_t &a) {
@@ -0,0 +1,118 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "bitmap.h"
+#include "bitmap_pool.h"
+#include "font.h"
+#include "scratch_arena.h"
+
+namespace {
+	/** Unused bitmaps are freed after 5 seconds */
+	const int max_idle_frames = 300;
+	/** Upper bound of the memory held by unused bitmaps */
+	const int64_t max_idle_bytes = 2 * 1024 * 1024;
+	const int trim_interval = 60;
+
+	struct Entry {
+		BitmapRef bitmap;
+		int last_use;
+	};
+
+	std::unordered_map<uint64_t, std::vector<Entry>> pool;
+	int frame = 0;
+
+	uint64_t Key(int width, int height, bool transparent) {
+		return ((uint64_t)(uint32_t)width << 32) | ((uint64_t)(uint32_t)height << 1) | (transparent ? 1 : 0);
+	}
+
+	bool IsUnused(const Entry& entry) {
+		return entry.bitmap.use_count() == 1;
+	}
+
+	int64_t Size(const Entry& entry) {
+		return (int64_t)entry.bitmap->pitch() * entry.bitmap->height();
+	}
+}
+
+BitmapRef BitmapPool::Get(int width, int height, bool transparent) {
+	if (!ScratchArena::IsAvailable()) {
+		return Bitmap::Create(width, height, transparent);
+	}
+
+	std::vector<Entry>& entries = pool[Key(width, height, transparent)];
+	for (Entry& entry : entries) {
+		if (IsUnused(entry)) {
+			entry.last_use = frame;
+			entry.bitmap->Clear();
+			entry.bitmap->SetFont(Font::Default());
+			// The previous user may have accounted it to its subsystem
+			entry.bitmap->SetMemoryCategory(MemoryStats::Category_Bitmap);
+			return entry.bitmap;
+		}
+	}
+
+	BitmapRef bitmap = Bitmap::Create(width, height, transparent);
+	entries.push_back({bitmap, frame});
+	return bitmap;
+}
+
+void BitmapPool::Update() {
+	if (++frame % trim_interval != 0) {
+		return;
+	}
+
+	std::vector<Entry*> idle;
+	int64_t idle_bytes = 0;
+	for (auto& item : pool) {
+		for (Entry& entry : item.second) {
+			if (IsUnused(entry)) {
+				idle.push_back(&entry);
+				idle_bytes += Size(entry);
+			}
+		}
+	}
+
+	// Free bitmaps unused for too long and the oldest ones while over budget
+	std::sort(idle.begin(), idle.end(), [](const Entry* a, const Entry* b) { return a->last_use < b->last_use; });
+	for (Entry* entry : idle) {
+		if (frame - entry->last_use <= max_idle_frames && idle_bytes <= max_idle_bytes) {
+			break;
+		}
+		idle_bytes -= Size(*entry);
+		entry->bitmap.reset();
+	}
+
+	for (auto it = pool.begin(); it != pool.end(); ) {
+		std::vector<Entry>& entries = it->second;
+		entries.erase(std::remove_if(entries.begin(), entries.end(),
+			[](const Entry& entry) { return !entry.bitmap; }), entries.end());
+
+		if (entries.empty()) {
+			it = pool.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void BitmapPool::Clear() {
+	pool.clear();
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_BITMAP_POOL_H
+#define EASYRPG_BITMAP_POOL_H
+
+// Headers
+#include "system.h"
+
+/**
+ * BitmapPool recycles short-lived bitmaps (text surfaces, window frames,
+ * effect buffers) by size and format instead of allocating new pixels
+ * every time. A pooled bitmap returns to the pool when its last
+ * reference outside of the pool is dropped.
+ * Like the ScratchArena the pool only serves the main thread, other
+ * threads get normal bitmaps.
+ */
+namespace BitmapPool {
+	/**
+	 * Gets a cleared bitmap from the pool. A new bitmap is created when no
+	 * unused bitmap of that size and format is pooled.
+	 *
+	 * @param width bitmap width.
+	 * @param height bitmap height.
+	 * @param transparent allow transparency on bitmap.
+	 * @return bitmap owned by the caller until released.
+	 */
+	BitmapRef Get(int width, int height, bool transparent = true);
+
+	/**
+	 * Frees pooled bitmaps that were unused for a while.
+	 * Called once per frame.
+	 */
+	void Update();
+
+	/**
+	 * Frees all pooled bitmaps.
+	 * Also called when the pixel format changes because pooled bitmaps keep
+	 * the format they were created with.
+	 */
+	void Clear();
+}
+
+#endif
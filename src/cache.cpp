@@ -68,6 +68,14 @@ namespace {
 		}
 	}
 
+	/** Accounts the memory of a cached bitmap to the cache */
+	BitmapRef Account(BitmapRef bitmap) {
+		if (bitmap) {
+			bitmap->SetMemoryCategory(MemoryStats::Category_Cache);
+		}
+		return bitmap;
+	}
+
 	BitmapRef LoadBitmap(std::string const& folder_name, const std::string& filename,
 						 bool transparent, uint32_t const flags) {
 		string_pair const key(folder_name, filename);
@@ -90,7 +98,7 @@ namespace {
 
 			FreeBitmapMemory();
 
-			return (cache[key] = {bmp, DisplayUi->GetTicks()}).bitmap;
+			return (cache[key] = {Account(bmp), DisplayUi->GetTicks()}).bitmap;
 		} else {
 			it->second.last_access = DisplayUi->GetTicks();
 			return it->second.bitmap;
@@ -200,7 +208,7 @@ namespace {
 
 		BitmapRef bitmap = s.dummy_renderer();
 
-		return (cache[key] = {bitmap, DisplayUi->GetTicks()}).bitmap;
+		return (cache[key] = {Account(bitmap), DisplayUi->GetTicks()}).bitmap;
 	}
 
 	template<Material::Type T>
@@ -278,7 +286,7 @@ BitmapRef Cache::Exfont() {
 	cache_type::iterator const it = cache.find(hash);
 
 	if (it == cache.end() || !it->second.bitmap) {
-		return(cache[hash] = {Bitmap::Create(exfont_h, sizeof(exfont_h), true), DisplayUi->GetTicks()}).bitmap;
+		return(cache[hash] = {Account(DecodeExfont()), DisplayUi->GetTicks()}).bitmap;
 	} else {
 		it->second.last_access = DisplayUi->GetTicks();
 		return it->second.bitmap;
@@ -314,7 +322,7 @@ BitmapRef Cache::Tile(const std::string& filename, int tile_id) {
 		rect.x += sub_tile_id % 6 * 16;
 		rect.y += sub_tile_id / 6 * 16;
 
-		return(cache_tiles[key] = Bitmap::Create(*chipset, rect)).lock();
+		return(cache_tiles[key] = Account(Bitmap::Create(*chipset, rect))).lock();
 	} else { return it->second.lock(); }
 }
 
@@ -346,3 +354,28 @@ BitmapRef Cache::System() {
 		}
 	}
 }
+
+BitmapRef Cache::DecodeSystem(const std::string& filename) {
+	Spec const& s = spec[Material::System];
+
+	std::string const path = FileFinder::FindImage(s.directory, filename);
+	if (path.empty()) {
+		return BitmapRef();
+	}
+
+	return Bitmap::Create(path, s.transparent, Bitmap::Flag_System | Bitmap::Flag_ReadOnly);
+}
+
+void Cache::AddSystem(const std::string& filename, BitmapRef bitmap) {
+	if (bitmap) {
+		cache[string_pair(spec[Material::System].directory, filename)] = {Account(bitmap), DisplayUi->GetTicks()};
+	}
+}
+
+BitmapRef Cache::DecodeExfont() {
+	return Bitmap::Create(exfont_h, sizeof(exfont_h), true);
+}
+
+void Cache::AddExfont(BitmapRef bitmap) {
+	cache[string_pair("ExFont", "ExFont")] = {bitmap, DisplayUi->GetTicks()};
+}
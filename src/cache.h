@@ -54,6 +54,38 @@ namespace Cache {
 
 	BitmapRef System();
 	void SetSystemName(std::string const& filename);
+
+	/**
+	 * Decodes a System graphic without adding it to the cache.
+	 * Unlike the other functions this is safe to call from worker threads.
+	 * The result is passed to AddSystem on the main thread.
+	 *
+	 * @param filename name of the System graphic
+	 * @return decoded graphic or null when it was not found
+	 */
+	BitmapRef DecodeSystem(const std::string& filename);
+
+	/**
+	 * Adds a System graphic returned by DecodeSystem to the cache.
+	 *
+	 * @param filename name of the System graphic
+	 * @param bitmap decoded graphic, null is ignored
+	 */
+	void AddSystem(const std::string& filename, BitmapRef bitmap);
+
+	/**
+	 * Decodes the ExFont, see DecodeSystem.
+	 *
+	 * @return decoded ExFont
+	 */
+	BitmapRef DecodeExfont();
+
+	/**
+	 * Adds the ExFont returned by DecodeExfont to the cache.
+	 *
+	 * @param bitmap decoded ExFont
+	 */
+	void AddExfont(BitmapRef bitmap);
 }
 
 #endif
@@ -20,11 +20,17 @@
 #ifdef WANT_FMMIDI
 
 // Headers
+#include <algorithm>
 #include <cassert>
 #include "audio_decoder.h"
 #include "output.h"
 #include "decoder_fmmidi.h"
 
+namespace {
+	/** Number of frames synthesized between two sequencer updates */
+	const size_t block_samples = 256;
+}
+
 FmMidiDecoder::FmMidiDecoder() {
 	note_factory.reset(new midisynth::fm_note_factory());
 	synth.reset(new midisynth::synthesizer(note_factory.get()));
@@ -61,7 +67,32 @@ bool FmMidiDecoder::Seek(size_t offset, Origin origin) {
 		return true;
 	}
 
-	return false;
+	// Offset is in milliseconds
+	float total = seq->get_total_time();
+	float time = offset / 1000.0f;
+	if (origin == Origin::Current) {
+		time += mtime;
+	} else if (origin == Origin::End) {
+		time = std::max(total - time, 0.0f);
+	}
+	time = std::min(time, total);
+
+	// Replay all events up to the new position without starting notes.
+	// This restores programs, controllers and pitch bends.
+	synth->all_sound_off_immediately();
+	seq->rewind();
+	seeking = true;
+	seq->play(time, this);
+	seeking = false;
+
+	mtime = time;
+	begin = false;
+
+	return true;
+}
+
+size_t FmMidiDecoder::Tell() const {
+	return (size_t)(mtime * 1000.0f);
 }
 
 bool FmMidiDecoder::IsFinished() const {
@@ -96,19 +127,27 @@ int FmMidiDecoder::GetTicks() const {
 
 int FmMidiDecoder::FillBuffer(uint8_t* buffer, int length) {
 	size_t samples = (size_t)length / sizeof(int_least16_t) / 2;
-
-	float delta = (float)samples / (frequency * pitch);
-
-	// FM Midi somehow returns immediately at the beginning when mtime is too small
-	// This increments mtime until FM Midi is happy
-	int notes = 0;
-	do {
-		seq->play(mtime, this);
-		notes = synthesize(reinterpret_cast<int_least16_t*>(buffer), samples, frequency);
-		mtime += delta;
-	} while (begin && notes == 0 && !IsFinished());
-
-	begin = false;
+	int_least16_t* output = reinterpret_cast<int_least16_t*>(buffer);
+
+	// The sequencer is advanced in fixed blocks, this way the timing of the
+	// MIDI events does not depend on the buffer size of the audio backend
+	size_t offset = 0;
+	while (offset < samples) {
+		size_t block = std::min(samples - offset, block_samples);
+		float delta = (float)block / (frequency * pitch);
+
+		// FM Midi somehow returns immediately at the beginning when mtime is too small
+		// This increments mtime until FM Midi is happy
+		int notes = 0;
+		do {
+			seq->play(mtime, this);
+			notes = synthesize(output + offset * 2, block, frequency);
+			mtime += delta;
+		} while (begin && notes == 0 && !IsFinished());
+
+		begin = false;
+		offset += block;
+	}
 
 	return length;
 }
@@ -118,6 +157,11 @@ int FmMidiDecoder::synthesize(int_least16_t * output, std::size_t samples, float
 }
 
 void FmMidiDecoder::midi_message(int, uint_least32_t message) {
+	// Note on with a velocity, skipped while seeking
+	if (seeking && (message & 0xF0) == 0x90 && (message & 0xFF0000) != 0) {
+		return;
+	}
+
 	synth->midi_event(message);
 }
 
@@ -39,6 +39,8 @@ public:
 
 	bool Seek(size_t offset, Origin origin) override;
 
+	size_t Tell() const override;
+
 	bool IsFinished() const override;
 
 	void GetFormat(int& frequency, AudioDecoder::Format& format, int& channels) const override;
@@ -56,6 +58,7 @@ private:
 	float pitch = 1.0f;
 	int frequency = 44100;
 	bool begin = true;
+	bool seeking = false;
 
 	// midisequencer::output interface
 	int synthesize(int_least16_t* output, std::size_t samples, float rate);
@@ -71,6 +71,11 @@ Mpg123Decoder::Mpg123Decoder() :
 		return;
 	}
 
+	// Strip encoder delay and padding, otherwise loops have a gap.
+	// The frame index grows with the stream to make seeking sample accurate.
+	mpg123_param(handle.get(), MPG123_ADD_FLAGS, MPG123_GAPLESS, 0.0);
+	mpg123_param(handle.get(), MPG123_INDEX_SIZE, -1, 0.0);
+
 	init = true;
 }
 
@@ -87,6 +92,7 @@ bool Mpg123Decoder::Open(FILE* file) {
 	}
 
 	finished = false;
+	scanned = false;
 
 	err = mpg123_open_handle(handle.get(), file);
 	if (err != MPG123_OK) {
@@ -99,11 +105,39 @@ bool Mpg123Decoder::Open(FILE* file) {
 
 bool Mpg123Decoder::Seek(size_t offset, Origin origin) {
 	finished = false;
-	mpg123_seek_frame(handle.get(), offset, (int)origin);
+
+	if (offset == 0 && origin == Origin::Begin) {
+		mpg123_seek(handle.get(), 0, SEEK_SET);
+		return true;
+	}
+
+	// mpg123 can only seek to frames it has seen already, the whole stream
+	// is indexed once on the first real seek
+	if (!scanned) {
+		mpg123_scan(handle.get());
+		scanned = true;
+	}
+
+	off_t res;
+	if (origin == Origin::End) {
+		res = mpg123_seek(handle.get(), -(off_t)offset, SEEK_END);
+	} else {
+		res = mpg123_seek(handle.get(), (off_t)offset, (int)origin);
+	}
+
+	if (res < 0) {
+		error_message = "mpg123: " + std::string(mpg123_strerror(handle.get()));
+		return false;
+	}
 
 	return true;
 }
 
+size_t Mpg123Decoder::Tell() const {
+	off_t pos = mpg123_tell(handle.get());
+	return pos < 0 ? (size_t)-1 : (size_t)pos;
+}
+
 bool Mpg123Decoder::IsFinished() const {
 	return finished;
 }
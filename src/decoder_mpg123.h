@@ -41,6 +41,8 @@ public:
 
 	bool Seek(size_t offset, Origin origin) override;
 
+	size_t Tell() const override;
+
 	bool IsFinished() const override;
 
 	void GetFormat(int& frequency, AudioDecoder::Format& format, int& channels) const override;
@@ -57,6 +59,7 @@ private:
 	FILE* file_handle;
 	int err = 0;
 	bool finished = false;
+	bool scanned = false;
 
 	int frequency = 44100;
 };
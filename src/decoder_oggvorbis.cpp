@@ -20,6 +20,7 @@
 #if defined(HAVE_TREMOR) || defined(HAVE_OGGVORBIS)
 
 // Headers
+#include <algorithm>
 #include <cassert>
 #ifdef HAVE_TREMOR
 #include <tremor/ivorbiscodec.h>
@@ -76,15 +77,39 @@ bool OggVorbisDecoder::Open(FILE* file) {
 }
 
 bool OggVorbisDecoder::Seek(size_t offset, Origin origin) {
+	if (!ovf)
+		return false;
+
 	if (offset == 0 && origin == Origin::Begin) {
-		if (ovf) {
-			ov_raw_seek(ovf, 0);
-		}
+		// Raw seek is cheaper and always works for rewinding
+		ov_raw_seek(ovf, 0);
 		finished = false;
 		return true;
 	}
 
-	return false;
+	ogg_int64_t pos = offset;
+	if (origin == Origin::Current) {
+		pos += ov_pcm_tell(ovf);
+	} else if (origin == Origin::End) {
+		ogg_int64_t total = ov_pcm_total(ovf, -1);
+		if (total < 0)
+			return false;
+		pos = total - std::min<ogg_int64_t>(total, offset);
+	}
+
+	// Seeks sample accurate
+	if (ov_pcm_seek(ovf, pos) != 0)
+		return false;
+
+	finished = false;
+	return true;
+}
+
+size_t OggVorbisDecoder::Tell() const {
+	if (!ovf)
+		return -1;
+
+	return (size_t)ov_pcm_tell(ovf);
 }
 
 bool OggVorbisDecoder::IsFinished() const {
@@ -44,6 +44,8 @@ public:
 
 	bool Seek(size_t offset, Origin origin) override;
 
+	size_t Tell() const override;
+
 	bool IsFinished() const override;
 
 	void GetFormat(int& frequency, AudioDecoder::Format& format, int& channels) const override;
@@ -20,6 +20,7 @@
 #ifdef WANT_FASTWAV
 
 // Headers
+#include <algorithm>
 #include <cstring>
 #include "decoder_wav.h"
 #include "utils.h"
@@ -102,13 +103,35 @@ bool WavDecoder::Seek(size_t offset, Origin origin) {
 	finished = false;
 	if (file_ == NULL)
 		return false;
-	if (origin != Origin::End) {
-		offset += audiobuf_offset;
+
+	// Offset is in frames, the data chunk is seeked directly
+	size_t frame_size = nchannels * AudioDecoder::GetSamplesizeForFormat(output_format);
+	size_t frames = chunk_size / frame_size;
+	size_t pos = (cur_pos - audiobuf_offset) / frame_size;
+
+	switch (origin) {
+		case Origin::Begin:
+			pos = offset;
+			break;
+		case Origin::Current:
+			pos += offset;
+			break;
+		case Origin::End:
+			pos = offset > frames ? 0 : frames - offset;
+			break;
 	}
+	pos = std::min(pos, frames);
+
+	cur_pos = audiobuf_offset + pos * frame_size;
+	return fseek(file_, cur_pos, SEEK_SET) == 0;
+}
+
+size_t WavDecoder::Tell() const {
+	if (file_ == NULL)
+		return -1;
 
-	bool success = fseek(file_,offset,(int)origin) == 0;
-	cur_pos = ftell(file_);
-	return success;
+	size_t frame_size = nchannels * AudioDecoder::GetSamplesizeForFormat(output_format);
+	return (cur_pos - audiobuf_offset) / frame_size;
 }
 
 bool WavDecoder::IsFinished() const {
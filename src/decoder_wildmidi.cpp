@@ -124,7 +124,15 @@ bool WildMidiDecoder::Open(FILE* file) {
 		Output::Debug("WildMidi: Previous handle was not closed.");
 	}
 
-	handle = WildMidi_Open(filename.c_str());
+	// Parse the mapped file instead of letting WildMidi read it again,
+	// this works for files inside of a game archive, too
+	data = FileFinder::MapFile(filename);
+	if (!data) {
+		error_message = "WildMidi: Error reading file";
+		return false;
+	}
+
+	handle = WildMidi_OpenBuffer(const_cast<uint8_t*>(data->data()), (uint32_t) data->size());
 	if (!handle) {
 		error_message = "WildMidi: Error reading file";
 		return false;
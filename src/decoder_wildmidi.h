@@ -25,6 +25,7 @@
 #include <wildmidi_lib.h>
 #endif
 #include "audio_decoder.h"
+#include "file_span.h"
 
 /**
  * Audio decoder for MIDI powered by WildMidi
@@ -51,6 +52,7 @@ private:
 	int FillBuffer(uint8_t* buffer, int length) override;
 
 	std::string filename;
+	FileSpanRef data;
 #ifdef HAVE_WILDMIDI
 	midi* handle = NULL;
 #endif
@@ -0,0 +1,160 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <cstdio>
+#include "file_span.h"
+#include "filefinder.h"
+#include "output.h"
+#include "utils.h"
+
+#if defined(_WIN32) && !defined(__WINRT__)
+#  define FILE_SPAN_WIN32_MAPPING
+#  include <windows.h>
+#elif !defined(_WIN32) && !defined(GEKKO) && !defined(_3DS) && !defined(PSP2) && !defined(EMSCRIPTEN)
+#  define FILE_SPAN_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+FileSpan::FileSpan() {
+}
+
+FileSpan::~FileSpan() {
+	if (!mapping) {
+		return;
+	}
+#if defined(FILE_SPAN_MMAP)
+	munmap(mapping, length);
+#elif defined(FILE_SPAN_WIN32_MAPPING)
+	UnmapViewOfFile(mapping);
+#endif
+}
+
+namespace {
+	/** Maps the file, returns null when the platform can't or the file is empty */
+	void* MapWholeFile(const std::string& filename, size_t& size) {
+#if defined(FILE_SPAN_MMAP)
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return nullptr;
+		}
+
+		struct stat sb;
+		void* addr = nullptr;
+		if (fstat(fd, &sb) == 0 && sb.st_size > 0) {
+			addr = mmap(nullptr, (size_t) sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr == MAP_FAILED) {
+				addr = nullptr;
+			} else {
+				size = (size_t) sb.st_size;
+			}
+		}
+		// The mapping stays valid after closing
+		close(fd);
+		return addr;
+#elif defined(FILE_SPAN_WIN32_MAPPING)
+		HANDLE file = CreateFileW(Utils::ToWideString(filename).c_str(), GENERIC_READ, FILE_SHARE_READ,
+			NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			return nullptr;
+		}
+
+		void* addr = nullptr;
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+			HANDLE map = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (map) {
+				addr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+				if (addr) {
+					size = (size_t) file_size.QuadPart;
+				}
+				// The view keeps the mapping alive
+				CloseHandle(map);
+			}
+		}
+		CloseHandle(file);
+		return addr;
+#else
+		(void)filename;
+		(void)size;
+		return nullptr;
+#endif
+	}
+}
+
+FileSpanRef FileSpan::Map(const std::string& filename) {
+	std::shared_ptr<FileSpan> span(new FileSpan());
+
+	size_t size = 0;
+	span->mapping = MapWholeFile(filename, size);
+	if (span->mapping) {
+		span->begin = static_cast<const uint8_t*>(span->mapping);
+		span->length = size;
+		return span;
+	}
+
+	// Not mappable, read it instead
+	FILE* file = FileFinder::fopenUTF8(filename, "rb");
+	if (!file) {
+		return FileSpanRef();
+	}
+
+	std::vector<uint8_t>& buffer = span->buffer;
+	uint8_t chunk[4096];
+	size_t read;
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+		buffer.insert(buffer.end(), chunk, chunk + read);
+	}
+	bool error = ferror(file) != 0;
+	fclose(file);
+
+	if (error) {
+		Output::Debug("Error reading %s", filename.c_str());
+		return FileSpanRef();
+	}
+
+	span->begin = buffer.empty() ? nullptr : &buffer.front();
+	span->length = buffer.size();
+	return span;
+}
+
+FileSpanRef FileSpan::Sub(const FileSpanRef& parent, size_t offset, size_t size) {
+	if (!parent || offset > parent->size() || size > parent->size() - offset) {
+		return FileSpanRef();
+	}
+
+	std::shared_ptr<FileSpan> span(new FileSpan());
+	span->begin = parent->data() + offset;
+	span->length = size;
+	span->parent = parent;
+	return span;
+}
+
+FileSpanRef FileSpan::FromBuffer(std::vector<uint8_t> buffer) {
+	std::shared_ptr<FileSpan> span(new FileSpan());
+	span->buffer.swap(buffer);
+	span->begin = span->buffer.empty() ? nullptr : &span->buffer.front();
+	span->length = span->buffer.size();
+	return span;
+}
+
+bool FileSpan::IsMapped() const {
+	return mapping != nullptr || (parent && parent->IsMapped());
+}
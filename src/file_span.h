@@ -0,0 +1,96 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_FILE_SPAN_H
+#define EASYRPG_FILE_SPAN_H
+
+// Headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FileSpan;
+typedef std::shared_ptr<const FileSpan> FileSpanRef;
+
+/**
+ * FileSpan is a read only view of the contents of a file.
+ * Files are memory mapped when the platform supports it, otherwise they are
+ * read into memory. Sub spans share the memory of their parent.
+ */
+class FileSpan {
+public:
+	~FileSpan();
+
+	/**
+	 * Maps a whole file into memory.
+	 *
+	 * @param filename path to the file (UTF-8)
+	 * @return span of the file contents or null on error
+	 */
+	static FileSpanRef Map(const std::string& filename);
+
+	/**
+	 * Creates a span sharing the memory of another span.
+	 *
+	 * @param parent span to take the memory from
+	 * @param offset start of the sub span
+	 * @param size size of the sub span
+	 * @return sub span or null when out of range
+	 */
+	static FileSpanRef Sub(const FileSpanRef& parent, size_t offset, size_t size);
+
+	/**
+	 * Creates a span that owns a buffer.
+	 *
+	 * @param buffer buffer to take over
+	 * @return span of the buffer
+	 */
+	static FileSpanRef FromBuffer(std::vector<uint8_t> buffer);
+
+	/** @return first byte of the span */
+	const uint8_t* data() const;
+
+	/** @return size of the span in bytes */
+	size_t size() const;
+
+	/** @return whether the span is backed by a memory mapping */
+	bool IsMapped() const;
+
+private:
+	FileSpan();
+	FileSpan(const FileSpan&) = delete;
+	FileSpan& operator=(const FileSpan&) = delete;
+
+	const uint8_t* begin = nullptr;
+	size_t length = 0;
+
+	/** Platform mapping handle, null when not mapped */
+	void* mapping = nullptr;
+	std::vector<uint8_t> buffer;
+	FileSpanRef parent;
+};
+
+inline const uint8_t* FileSpan::data() const {
+	return begin;
+}
+
+inline size_t FileSpan::size() const {
+	return length;
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <algorithm>
 #include <fstream>
 #include <string>
@@ -67,6 +68,10 @@
 #   include <SDL_system.h>
 #endif
 
+#ifdef USE_SDL
+#   include <SDL.h>
+#endif
+
 #include "system.h"
 #include "options.h"
 #include "utils.h"
@@ -76,6 +81,7 @@
 #include "registry.h"
 #include "rtp_table.h"
 #include "main_data.h"
+#include "game_archive.h"
 
 // MinGW shlobj.h does not define this
 #ifndef SHGFP_TYPE_CURRENT
@@ -92,6 +98,333 @@ namespace {
 	search_path_list search_paths;
 	std::string fonts_path;
 
+	/** Mounted game archives, see GameArchive */
+	std::vector<std::shared_ptr<GameArchive>> archives;
+
+	/** { path inside of an archive, extracted file } */
+	std::unordered_map<std::string, std::string> extracted_files;
+
+	/** Directory only accessible by the Player holding extracted_files */
+	std::string extract_directory;
+
+	/** Larger archive entries are not extracted by MakeLocal */
+	const int64_t MAX_EXTRACT_SIZE = 256 * 1024 * 1024;
+
+	/**
+	 * Holds the lock of archives, extracted_files and extract_directory
+	 * while in scope. Files are read from archives on worker threads.
+	 */
+	class ArchiveLock {
+	public:
+		ArchiveLock() {
+#ifdef USE_SDL
+			static SDL_mutex* const mutex = SDL_CreateMutex();
+			archive_mutex = mutex;
+			SDL_LockMutex(archive_mutex);
+#endif
+		}
+
+		~ArchiveLock() {
+#ifdef USE_SDL
+			SDL_UnlockMutex(archive_mutex);
+#endif
+		}
+
+	private:
+#ifdef USE_SDL
+		SDL_mutex* archive_mutex;
+#endif
+	};
+
+	/**
+	 * Splits a case lowered path into "directory/name" and extension
+	 * (including the dot), the keys of DirectoryTree::index.
+	 */
+	void SplitExtension(std::string const& path, std::string& base, std::string& ext) {
+		size_t slash = path.find_last_of('/');
+		size_t dot = path.find_last_of('.');
+		if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+			base = path.substr(0, dot);
+			ext = path.substr(dot);
+		} else {
+			base = path;
+			ext.clear();
+		}
+	}
+
+	std::string NormalizeSeparators(std::string path) {
+		std::replace(path.begin(), path.end(), '\\', '/');
+		return path;
+	}
+
+	void BuildIndex(FileFinder::DirectoryTree& tree) {
+		tree.index.clear();
+
+		std::string base, ext;
+		for (auto& dir : tree.sub_members) {
+			FileFinder::string_map::const_iterator dir_it = tree.directories.find(dir.first);
+			if (dir_it == tree.directories.end()) { continue; }
+
+			for (auto& file : dir.second) {
+				SplitExtension(dir.first + "/" + NormalizeSeparators(file.first), base, ext);
+				tree.index[base].push_back(std::make_pair(ext, dir_it->second + "/" + file.second));
+			}
+		}
+	}
+
+	/**
+	 * Finds the archive a path points into.
+	 *
+	 * @param path path as returned by the FileFinder
+	 * @param name set to the path relative to the archive
+	 * @return archive or null when the path is not inside of an archive
+	 */
+	std::shared_ptr<GameArchive> FindArchive(std::string const& path, std::string& name) {
+		ArchiveLock lock;
+		for (auto& archive : archives) {
+			std::string const& prefix = archive->GetPath();
+			if (path.size() > prefix.size() + 1 &&
+				(path[prefix.size()] == '/' || path[prefix.size()] == '\\') &&
+				path.compare(0, prefix.size(), prefix) == 0) {
+				name = path.substr(prefix.size() + 1);
+				return archive;
+			}
+		}
+		return std::shared_ptr<GameArchive>();
+	}
+
+	/**
+	 * Builds a directory tree from the contents of an archive. The archive
+	 * path acts as the directory, so found files are "archive/name".
+	 */
+	std::shared_ptr<FileFinder::DirectoryTree> CreateArchiveTree(std::string const& path, bool recursive) {
+		std::shared_ptr<GameArchive> archive;
+		{
+			ArchiveLock lock;
+			for (auto& a : archives) {
+				if (a->GetPath() == path) {
+					archive = a;
+				}
+			}
+			if (!archive) {
+				archive = GameArchive::Open(path);
+				if (!archive) {
+					return std::shared_ptr<FileFinder::DirectoryTree>();
+				}
+				archives.push_back(archive);
+			}
+		}
+
+		std::shared_ptr<FileFinder::DirectoryTree> tree = std::make_shared<FileFinder::DirectoryTree>();
+		tree->directory_path = path;
+
+		for (std::string const& name : archive->GetNames()) {
+			size_t slash = name.find('/');
+			if (slash == std::string::npos) {
+				tree->files[Utils::LowerCase(name)] = name;
+				continue;
+			}
+
+			std::string dir = name.substr(0, slash);
+			std::string lower_dir = Utils::LowerCase(dir);
+			tree->directories[lower_dir] = dir;
+			if (recursive) {
+				std::string member = name.substr(slash + 1);
+				tree->sub_members[lower_dir][Utils::LowerCase(member)] = member;
+			}
+		}
+
+		if (recursive) {
+			BuildIndex(*tree);
+		}
+
+		return tree;
+	}
+
+	std::string GetTemporaryDirectory() {
+		if (!Main_Data::GetCachePath().empty()) {
+			return Main_Data::GetCachePath();
+		}
+#if defined(_WIN32)
+		wchar_t path[MAX_PATH + 1];
+		if (GetTempPathW(MAX_PATH + 1, path) > 0) {
+			return Utils::FromWideString(path);
+		}
+#elif !defined(GEKKO) && !defined(_3DS) && !defined(PSP2)
+		const char* tmpdir = getenv("TMPDIR");
+		return tmpdir ? tmpdir : "/tmp";
+#endif
+		return Main_Data::GetSavePath();
+	}
+
+	/**
+	 * Creates the directory for extracted files on first use. Its name is
+	 * not predictable and only the user running the Player can access it.
+	 * Must be called with ArchiveLock held.
+	 *
+	 * @return directory or empty string on failure
+	 */
+	std::string const& GetExtractDirectory() {
+		if (!extract_directory.empty()) {
+			return extract_directory;
+		}
+
+#if defined(_WIN32)
+		// The temporary directory of Windows belongs to the user
+		std::wstring temp = Utils::ToWideString(GetTemporaryDirectory());
+		wchar_t path[MAX_PATH + 1];
+		if (GetTempFileNameW(temp.c_str(), L"erp", 0, path) != 0) {
+			DeleteFileW(path);
+			if (CreateDirectoryW(path, NULL)) {
+				extract_directory = Utils::FromWideString(path);
+			}
+		}
+#elif !defined(GEKKO) && !defined(_3DS) && !defined(PSP2)
+		std::string path = FileFinder::MakePath(GetTemporaryDirectory(), "easyrpg_XXXXXX");
+		if (mkdtemp(&path[0])) {
+			extract_directory = path;
+		}
+#else
+		// Single user systems
+		extract_directory = GetTemporaryDirectory();
+#endif
+
+		if (extract_directory.empty()) {
+			Output::Warning("Could not create a directory for extracted files");
+		}
+		return extract_directory;
+	}
+
+	const char* const INDEX_HEADER = "EasyRPG Player directory index 1";
+
+	std::string GetIndexFilename(std::string const& path) {
+		// FNV-1a hash of the directory path
+		uint64_t hash = 14695981039346656037ULL;
+		for (char c : path) {
+			hash ^= (uint8_t) c;
+			hash *= 1099511628211ULL;
+		}
+
+		char name[32];
+		snprintf(name, sizeof(name), "index_%08x%08x.txt",
+			(unsigned)(hash >> 32), (unsigned)(hash & 0xFFFFFFFF));
+		return FileFinder::MakePath(Main_Data::GetCachePath(), name);
+	}
+
+	/**
+	 * Reads a directory tree stored by SaveIndex.
+	 * Returns null when the index is missing, belongs to another directory or
+	 * any of the directories was modified since.
+	 *
+	 * The index is a text file. After the header and the directory path
+	 * every line is a tab separated record:
+	 *  m mtime dir: modification time of a scanned directory
+	 *  f name: file in the root
+	 *  d name: directory in the root
+	 *  s dir name: file in a sub directory (sub_members)
+	 */
+	std::shared_ptr<FileFinder::DirectoryTree> LoadIndex(std::string const& index_file, std::string const& path) {
+		std::shared_ptr<std::fstream> in = FileFinder::openUTF8(index_file, std::ios_base::in | std::ios_base::binary);
+		if (!in) {
+			return std::shared_ptr<FileFinder::DirectoryTree>();
+		}
+
+		std::string line;
+		if (!std::getline(*in, line) || line != INDEX_HEADER ||
+			!std::getline(*in, line) || line != path) {
+			return std::shared_ptr<FileFinder::DirectoryTree>();
+		}
+
+		std::shared_ptr<FileFinder::DirectoryTree> tree = std::make_shared<FileFinder::DirectoryTree>();
+		tree->directory_path = path;
+
+		while (std::getline(*in, line)) {
+			if (line.size() < 2 || line[1] != '\t') {
+				continue;
+			}
+
+			std::string value = line.substr(2);
+			size_t tab = value.find('\t');
+
+			switch (line[0]) {
+			case 'm':
+				if (tab == std::string::npos ||
+					FileFinder::GetModificationTime(FileFinder::MakePath(path, value.substr(tab + 1))) != atoll(value.substr(0, tab).c_str())) {
+					Output::Debug("Directory index of %s is outdated", path.c_str());
+					return std::shared_ptr<FileFinder::DirectoryTree>();
+				}
+				break;
+			case 'f':
+				tree->files[Utils::LowerCase(value)] = value;
+				break;
+			case 'd':
+				tree->directories[Utils::LowerCase(value)] = value;
+				break;
+			case 's':
+				if (tab != std::string::npos) {
+					std::string name = value.substr(tab + 1);
+					tree->sub_members[value.substr(0, tab)][Utils::LowerCase(name)] = name;
+				}
+				break;
+			}
+		}
+
+		if (tree->files.count(Utils::LowerCase(GameArchive::DEFAULT_NAME))) {
+			return std::shared_ptr<FileFinder::DirectoryTree>();
+		}
+
+		BuildIndex(*tree);
+
+		Output::Debug("Using directory index of %s", path.c_str());
+		return tree;
+	}
+
+	void SaveIndex(std::string const& index_file, FileFinder::DirectoryTree const& tree,
+			std::vector<std::string> const& scanned_dirs) {
+		std::vector<int64_t> mtimes;
+		int64_t now = (int64_t) time(NULL);
+		for (auto& dir : scanned_dirs) {
+			int64_t mtime = FileFinder::GetModificationTime(FileFinder::MakePath(tree.directory_path, dir));
+			// Changes within the same second would go unnoticed
+			if (mtime < 0 || now - mtime < 2) {
+				return;
+			}
+			mtimes.push_back(mtime);
+		}
+
+		std::string tmp_file = index_file + ".tmp";
+		std::shared_ptr<std::fstream> out = FileFinder::openUTF8(tmp_file,
+			std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!out) {
+			Output::Debug("Could not write directory index %s", index_file.c_str());
+			return;
+		}
+
+		*out << INDEX_HEADER << "\n" << tree.directory_path << "\n";
+		for (size_t i = 0; i < scanned_dirs.size(); ++i) {
+			*out << "m\t" << mtimes[i] << "\t" << scanned_dirs[i] << "\n";
+		}
+		for (auto& i : tree.files) {
+			*out << "f\t" << i.second << "\n";
+		}
+		for (auto& i : tree.directories) {
+			*out << "d\t" << i.second << "\n";
+		}
+		for (auto& dir : tree.sub_members) {
+			for (auto& i : dir.second) {
+				*out << "s\t" << dir.first << "\t" << i.second << "\n";
+			}
+		}
+
+		bool ok = out->good();
+		out.reset();
+
+		std::remove(index_file.c_str());
+		if (!ok || std::rename(tmp_file.c_str(), index_file.c_str()) != 0) {
+			std::remove(tmp_file.c_str());
+		}
+	}
+
 	std::string FindFile(FileFinder::DirectoryTree const& tree,
 										  std::string const& dir,
 										  std::string const& name,
@@ -140,17 +473,23 @@ namespace {
 		}
 #endif
 
-		string_map::const_iterator dir_it = tree.directories.find(lower_dir);
-		if(dir_it == tree.directories.end()) { return ""; }
-
-		string_map const& dir_map = tree.sub_members.find(lower_dir)->second;
+		std::string const key = NormalizeSeparators(lower_dir + "/" + corrected_name);
+		std::string base, ext, last_base;
+		file_index_type::const_iterator entry = tree.index.end();
 
+		// Usually all extensions share the same base and one lookup is enough
 		for(char const** c = exts; *c != NULL; ++c) {
-			string_map::const_iterator const name_it = dir_map.find(corrected_name + *c);
-			if(name_it != dir_map.end()) {
-				return MakePath
-					(std::string(tree.directory_path).append("/")
-					 .append(dir_it->second), name_it->second);
+			SplitExtension(key + *c, base, ext);
+			if (entry == tree.index.end() || base != last_base) {
+				entry = tree.index.find(base);
+				last_base = base;
+				if (entry == tree.index.end()) { continue; }
+			}
+
+			for (auto& file : entry->second) {
+				if (file.first == ext) {
+					return MakePath(tree.directory_path, file.second);
+				}
 			}
 		}
 
@@ -163,11 +502,34 @@ namespace {
 		return std::find_if(n.begin(), n.end(), &is_not_ascii_char) != n.end();
 	}
 
+	/**
+	 * { case lowered directory, { Japanese file name, English file name } }
+	 */
+	typedef std::unordered_map<std::string, FileFinder::string_map> rtp_reverse_table_type;
+
+	rtp_reverse_table_type const& get_reverse_rtp_table(bool rpg2k) {
+		static rtp_reverse_table_type reverse_2000, reverse_2003;
+		rtp_reverse_table_type& reverse = rpg2k ? reverse_2000 : reverse_2003;
+
+		if (reverse.empty()) {
+			rtp_table_type const& table = rpg2k ? RTP::RTP_TABLE_2000 : RTP::RTP_TABLE_2003;
+			for (auto& dir : table) {
+				FileFinder::string_map& names = reverse[dir.first];
+				for (auto& file : dir.second) {
+					// First entry wins, like the ordered search did
+					names.insert(std::make_pair(file.second, file.first));
+				}
+			}
+		}
+		return reverse;
+	}
+
 	std::string const& translate_rtp(std::string const& dir, std::string const& name) {
 		rtp_table_type const& table =
 			Player::IsRPG2k() ? RTP::RTP_TABLE_2000 : RTP::RTP_TABLE_2003;
 
-		rtp_table_type::const_iterator dir_it = table.find(Utils::LowerCase(dir));
+		std::string lower_dir = Utils::LowerCase(dir);
+		rtp_table_type::const_iterator dir_it = table.find(lower_dir);
 		std::string lower_name = Utils::LowerCase(name);
 
 		if (dir_it == table.end()) { return name; }
@@ -176,10 +538,13 @@ namespace {
 			dir_it->second.find(lower_name);
 		if (file_it == dir_it->second.end()) {
 			if (is_not_ascii_filename(lower_name)) {
-				// Linear Search: Japanese file name to English file name
-				for (std::map<std::string, std::string>::const_iterator it = dir_it->second.begin(); it != file_it; ++it) {
-					if (it->second == lower_name) {
-						return it->first;
+				// Japanese file name to English file name
+				rtp_reverse_table_type const& reverse = get_reverse_rtp_table(Player::IsRPG2k());
+				rtp_reverse_table_type::const_iterator rdir_it = reverse.find(lower_dir);
+				if (rdir_it != reverse.end()) {
+					FileFinder::string_map::const_iterator it = rdir_it->second.find(lower_name);
+					if (it != rdir_it->second.end()) {
+						return it->second;
 					}
 				}
 			}
@@ -242,10 +607,30 @@ void FileFinder::SetDirectoryTree(std::shared_ptr<FileFinder::DirectoryTree> dir
 
 std::shared_ptr<FileFinder::DirectoryTree> FileFinder::CreateDirectoryTree(std::string const& p, bool recursive) {
 	if(! (Exists(p) && IsDirectory(p))) { return std::shared_ptr<DirectoryTree>(); }
+
+	std::string index_file;
+	if (recursive && !Main_Data::GetCachePath().empty()) {
+		index_file = GetIndexFilename(p);
+		std::shared_ptr<DirectoryTree> tree = LoadIndex(index_file, p);
+		if (tree) {
+			return tree;
+		}
+	}
+
 	std::shared_ptr<DirectoryTree> tree = std::make_shared<DirectoryTree>();
 	tree->directory_path = p;
 
 	Directory mem = GetDirectoryMembers(tree->directory_path, ALL);
+
+	// A packed game is read from the archive only
+	string_map::const_iterator archive_it = mem.files.find(Utils::LowerCase(GameArchive::DEFAULT_NAME));
+	if (archive_it != mem.files.end()) {
+		std::shared_ptr<DirectoryTree> archive_tree = CreateArchiveTree(MakePath(p, archive_it->second), recursive);
+		if (archive_tree) {
+			return archive_tree;
+		}
+	}
+
 	for (auto& i : mem.files) {
 		tree->files[i.first] = i.second;
 	}
@@ -253,11 +638,26 @@ std::shared_ptr<FileFinder::DirectoryTree> FileFinder::CreateDirectoryTree(std::
 		tree->directories[i.first] = i.second;
 	}
 
+	// Relative paths of all scanned directories, the root is ""
+	std::vector<std::string> scanned_dirs(1);
+
 	if (recursive) {
 		for (auto& i : mem.directories) {
-			GetDirectoryMembers(MakePath(tree->directory_path, i.second), RECURSIVE).files.swap(tree->sub_members[i.first]);
+			Directory sub = GetDirectoryMembers(MakePath(tree->directory_path, i.second), RECURSIVE);
+			sub.files.swap(tree->sub_members[i.first]);
+
+			scanned_dirs.push_back(i.second);
+			for (auto& d : sub.directories) {
+				scanned_dirs.push_back(i.second + "/" + NormalizeSeparators(d.second));
+			}
 		}
+		BuildIndex(*tree);
 	}
+
+	if (!index_file.empty()) {
+		SaveIndex(index_file, *tree, scanned_dirs);
+	}
+
 	return tree;
 }
 
@@ -505,9 +905,53 @@ void FileFinder::InitRtpPaths(bool warn_no_rtp_found) {
 void FileFinder::Quit() {
 	search_paths.clear();
 	game_directory_tree.reset();
+
+	ArchiveLock lock;
+	archives.clear();
+
+	for (auto& i : extracted_files) {
+		std::remove(i.second.c_str());
+	}
+	extracted_files.clear();
+
+#if defined(_WIN32)
+	if (!extract_directory.empty()) {
+		RemoveDirectoryW(Utils::ToWideString(extract_directory).c_str());
+	}
+#elif !defined(GEKKO) && !defined(_3DS) && !defined(PSP2)
+	if (!extract_directory.empty()) {
+		rmdir(extract_directory.c_str());
+	}
+#endif
+	extract_directory.clear();
 }
 
 FILE* FileFinder::fopenUTF8(const std::string& name_utf8, char const* mode) {
+	std::string name;
+	std::shared_ptr<GameArchive> archive;
+	if (mode[0] == 'r' && (archive = FindArchive(name_utf8, name))) {
+		bool shared;
+		FileSpanRef data = archive->Read(name, &shared);
+		if (!data) {
+			return nullptr;
+		}
+#ifdef __GLIBC__
+		// Stored entries live as long as the archive is mounted
+		if (shared && data->size() > 0) {
+			return fmemopen(const_cast<uint8_t*>(data->data()), data->size(), "rb");
+		}
+#endif
+		FILE* file = tmpfile();
+		if (file && data->size() > 0 && fwrite(data->data(), 1, data->size(), file) != data->size()) {
+			fclose(file);
+			return nullptr;
+		}
+		if (file) {
+			rewind(file);
+		}
+		return file;
+	}
+
 #ifdef _WIN32
 	return _wfopen(Utils::ToWideString(name_utf8).c_str(),
 				   Utils::ToWideString(mode).c_str());
@@ -516,9 +960,11 @@ FILE* FileFinder::fopenUTF8(const std::string& name_utf8, char const* mode) {
 #endif
 }
 
-std::shared_ptr<std::fstream> FileFinder::openUTF8(const std::string& name,
+std::shared_ptr<std::fstream> FileFinder::openUTF8(const std::string& name_utf8,
 													  std::ios_base::openmode m)
 {
+	std::string name = (m & std::ios_base::out) ? name_utf8 : MakeLocal(name_utf8);
+
 	std::shared_ptr<std::fstream> ret(new std::fstream(
 #ifdef _MSC_VER
 		Utils::ToWideString(name).c_str(),
@@ -529,6 +975,70 @@ std::shared_ptr<std::fstream> FileFinder::openUTF8(const std::string& name,
 	return (*ret)? ret : std::shared_ptr<std::fstream>();
 }
 
+FileSpanRef FileFinder::MapFile(std::string const& path) {
+	std::string name;
+	std::shared_ptr<GameArchive> archive = FindArchive(path, name);
+	return archive ? archive->Read(name) : FileSpan::Map(path);
+}
+
+std::string FileFinder::MakeLocal(std::string const& path) {
+	std::string name;
+	std::shared_ptr<GameArchive> archive = FindArchive(path, name);
+	if (!archive) {
+		return path;
+	}
+
+	// Held while extracting, the same file is not extracted twice
+	ArchiveLock lock;
+
+	auto it = extracted_files.find(path);
+	if (it != extracted_files.end()) {
+		return it->second;
+	}
+
+	int64_t size = archive->GetSize(name);
+	if (size > MAX_EXTRACT_SIZE) {
+		Output::Warning("Not extracting %s, it is too large (%d MiB)", path.c_str(), (int) (size / (1024 * 1024)));
+		return path;
+	}
+
+	std::string const& directory = GetExtractDirectory();
+	if (directory.empty()) {
+		return path;
+	}
+
+	FileSpanRef data = archive->Read(name);
+	if (!data) {
+		return path;
+	}
+
+	// FNV-1a hash of the path keeps files with the same name apart
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : path) {
+		hash ^= (uint8_t) c;
+		hash *= 1099511628211ULL;
+	}
+	std::string base = name.substr(name.find_last_of("/\\") + 1);
+	char prefix[32];
+	snprintf(prefix, sizeof(prefix), "%08x_", (unsigned)(hash & 0xFFFFFFFF));
+	std::string local = MakePath(directory, prefix + base);
+
+	FILE* out = fopenUTF8(local, "wb");
+	if (!out) {
+		Output::Warning("Could not extract %s", path.c_str());
+		return path;
+	}
+	bool ok = data->size() == 0 || fwrite(data->data(), 1, data->size(), out) == data->size();
+	ok = fclose(out) == 0 && ok;
+	if (!ok) {
+		std::remove(local.c_str());
+		return path;
+	}
+
+	extracted_files[path] = local;
+	return local;
+}
+
 std::string FileFinder::FindImage(const std::string& dir, const std::string& name) {
 #ifdef EMSCRIPTEN
 	return FindDefault(dir, name);
@@ -596,6 +1106,20 @@ bool FileFinder::IsEasyRpgProject(DirectoryTree const& dir){
 	return(ldb_it != dir.files.end() && lmt_it != dir.files.end());
 }
 
+bool FileFinder::IsValidProjectDirectory(std::string const& path) {
+	Directory mem = GetDirectoryMembers(path, FILES);
+
+	// Archives are not opened here, CreateDirectoryTree checks their content
+	if (mem.files.count(Utils::LowerCase(GameArchive::DEFAULT_NAME))) {
+		return true;
+	}
+
+	return (mem.files.count(Utils::LowerCase(DATABASE_NAME)) &&
+			mem.files.count(Utils::LowerCase(TREEMAP_NAME))) ||
+		(mem.files.count(Utils::LowerCase(DATABASE_NAME_EASYRPG)) &&
+			mem.files.count(Utils::LowerCase(TREEMAP_NAME_EASYRPG)));
+}
+
 bool FileFinder::HasSavegame() {
 	std::shared_ptr<FileFinder::DirectoryTree> tree = FileFinder::CreateSaveDirectoryTree();
 
@@ -632,6 +1156,12 @@ std::string FileFinder::FindSound(const std::string& name) {
 }
 
 bool FileFinder::Exists(std::string const& filename) {
+	std::string name;
+	std::shared_ptr<GameArchive> archive = FindArchive(filename, name);
+	if (archive) {
+		return archive->Contains(name);
+	}
+
 #ifdef _WIN32
 	return ::GetFileAttributesW(Utils::ToWideString(filename).c_str()) != (DWORD)-1;
 #elif defined(GEKKO)
@@ -787,6 +1317,7 @@ FileFinder::Directory FileFinder::GetDirectoryMembers(const std::string& path, F
 				Directory rdir = GetDirectoryMembers(MakePath(path, name), RECURSIVE, MakePath(parent, name));
 				result.files.insert(rdir.files.begin(), rdir.files.end());
 				result.directories.insert(rdir.directories.begin(), rdir.directories.end());
+				result.directories[Utils::LowerCase(MakePath(parent, name))] = MakePath(parent, name);
 				continue;
 			}
 
@@ -814,7 +1345,34 @@ FileFinder::Directory FileFinder::GetDirectoryMembers(const std::string& path, F
 	return result;
 }
 
+int64_t FileFinder::GetModificationTime(std::string const& file) {
+	// Archives are only replaced as a whole
+	std::string name;
+	std::shared_ptr<GameArchive> archive = FindArchive(file, name);
+
+	return GetDirectoryModificationTime(archive ? archive->GetPath() : file);
+}
+
+int64_t FileFinder::GetDirectoryModificationTime(std::string const& path) {
+	StatBuf sb;
+	if (GetStat(path.c_str(), &sb) < 0) {
+		return -1;
+	}
+#ifdef PSP2
+	const SceDateTime& t = sb.st_mtime;
+	return ((((((int64_t) t.year * 12 + t.month) * 31 + t.day) * 24 + t.hour) * 60 + t.minute) * 60 + t.second);
+#else
+	return (int64_t) sb.st_mtime;
+#endif
+}
+
 Offset FileFinder::GetFileSize(std::string const& file) {
+	std::string name;
+	std::shared_ptr<GameArchive> archive = FindArchive(file, name);
+	if (archive) {
+		return (Offset) archive->GetSize(name);
+	}
+
 	StatBuf sb;
 	int result = GetStat(file.c_str(), &sb);
 	return (result == 0) ? sb.st_size : -1;
@@ -26,6 +26,7 @@
 #include <ios>
 #include <unordered_map>
 #include <vector>
+#include "file_span.h"
 
 #ifdef PSP2
 #  include <psp2/types.h>
@@ -61,10 +62,18 @@ namespace FileFinder {
 	 */
 	typedef std::unordered_map<std::string, string_map> sub_members_type;
 
+	/**
+	 * { case lowered "directory/name" without extension,
+	 *   list of { case lowered extension, real path relative to the tree } }
+	 */
+	typedef std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>> file_index_type;
+
 	struct DirectoryTree {
 		std::string directory_path;
 		string_map files, directories;
 		sub_members_type sub_members;
+		/** All files of the sub directories, for lookups with one hash access */
+		file_index_type index;
 	}; // struct DirectoryTree
 
 	/**
@@ -162,6 +171,26 @@ namespace FileFinder {
 	 */
 	std::shared_ptr<std::fstream> openUTF8(const std::string& name, std::ios_base::openmode m);
 
+	/**
+	 * Maps a file into memory, see FileSpan::Map.
+	 * Files stored uncompressed in a game archive (see GameArchive) are
+	 * not copied either.
+	 *
+	 * @param path path as returned by the Find functions
+	 * @return contents of the file or null on failure
+	 */
+	FileSpanRef MapFile(std::string const& path);
+
+	/**
+	 * Returns a path that libraries doing their own file handling can open.
+	 * Files stored in a game archive are extracted to a temporary file which
+	 * is deleted by Quit.
+	 *
+	 * @param path path as returned by the Find functions
+	 * @return path of a file on disk
+	 */
+	std::string MakeLocal(std::string const& path);
+
 	struct Directory {
 		std::string base;
 		string_map files;
@@ -220,7 +249,7 @@ namespace FileFinder {
 		ALL, /**< list files and directory */
 		FILES, /**< list only non-directory files */
 		DIRECTORIES, /**< list only directories */
-		RECURSIVE /**< list non-directory files recursively */
+		RECURSIVE /**< list non-directory files recursively, directories contains the nested directories */
 	};
 
 	/**
@@ -248,12 +277,33 @@ namespace FileFinder {
 	 */
 	const std::shared_ptr<DirectoryTree> GetDirectoryTree();
 	const std::shared_ptr<DirectoryTree> CreateSaveDirectoryTree();
+
+	/**
+	 * Scans a directory.
+	 * When recursive and a cache path is configured the result is stored in
+	 * the cache directory. Later calls reuse it as long as the modification
+	 * times of all scanned directories are unchanged.
+	 *
+	 * @param p directory to scan
+	 * @param recursive also scan the files of all sub directories
+	 * @return directory tree or null when p is not a directory
+	 */
 	std::shared_ptr<DirectoryTree> CreateDirectoryTree(std::string const& p, bool recursive = true);
 
 	bool IsValidProject(DirectoryTree const& dir);
 	bool IsRPG2kProject(DirectoryTree const& dir);
 	bool IsEasyRpgProject(DirectoryTree const& dir);
 
+	/**
+	 * Checks whether a directory contains a RPG Maker 2000/2003 game, an
+	 * EasyRPG game or a game archive without creating a DirectoryTree.
+	 * Unlike IsValidProject this is safe to call from worker threads.
+	 *
+	 * @param path directory to check
+	 * @return whether path contains a game
+	 */
+	bool IsValidProjectDirectory(std::string const& path);
+
 	/**
 	 * Checks whether the save directory contains any savegame with name
 	 * SaveXX.lsd (XX from 00 to 15).
@@ -269,6 +319,25 @@ namespace FileFinder {
          */
 	Offset GetFileSize(std::string const& file);
 
+	/**
+	 * Gets the modification time of a file. For files inside of a game
+	 * archive the time of the archive is returned.
+	 *
+	 * @param file the path to a file
+	 * @return modification time in seconds, or -1 on error
+	 */
+	int64_t GetModificationTime(std::string const& file);
+
+	/**
+	 * Gets the modification time of a file or directory on disk.
+	 * Game archives are not considered, this is safe to call from worker
+	 * threads.
+	 *
+	 * @param path the path to a file or directory
+	 * @return modification time in seconds, or -1 on error
+	 */
+	int64_t GetDirectoryModificationTime(std::string const& path);
+
 	/**
          * Known file sizes
          */
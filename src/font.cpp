@@ -153,6 +153,7 @@ BitmapRef ShinonomeFont::Glyph(char32_t code) {
 	size_t const width = glyph->is_full? FULL_WIDTH : HALF_WIDTH;
 
 	BitmapRef bm = Bitmap::Create(nullptr, width, HEIGHT, 0, DynamicFormat(8,8,0,8,0,8,0,8,0,PF::Alpha));
+	bm->SetMemoryCategory(MemoryStats::Category_Text);
 	uint8_t* data = reinterpret_cast<uint8_t*>(bm->pixels());
 	int pitch = bm->pitch();
 	for(size_t y_ = 0; y_ < HEIGHT; ++y_)
@@ -202,6 +203,7 @@ BitmapRef FTFont::Glyph(char32_t glyph) {
 	int const height = ft_bitmap.rows;
 
 	BitmapRef bm = Bitmap::Create(nullptr, width, height, 0, DynamicFormat(8,8,0,8,0,8,0,8,0,PF::Alpha));
+	bm->SetMemoryCategory(MemoryStats::Category_Text);
 	uint8_t* data = reinterpret_cast<uint8_t*>(bm->pixels());
 	int dst_pitch = bm->pitch();
 
@@ -235,7 +237,7 @@ bool FTFont::check_face() {
 	if (!face_ || face_name_ != name) {
 		face_cache_type::const_iterator it = face_cache.find(name);
 		if (it == face_cache.end() || it->second.expired()) {
-			std::string const face_path = FileFinder::FindFont(name);
+			std::string const face_path = FileFinder::MakeLocal(FileFinder::FindFont(name));
 			FT_Face face;
 			if (FT_New_Face(library_.get(), face_path.c_str(), 0, &face) != FT_Err_Ok) {
 				Output::Error("Couldn't initialize FreeType face: %s(%s)",
@@ -348,7 +350,9 @@ FontRef Font::exfont = std::make_shared<ExFont>();
 BitmapRef ExFont::Glyph(char32_t code) {
 	BitmapRef exfont = Cache::Exfont();
 	Rect const rect((code % 13) * 12, (code / 13) * 12, 12, 12);
-	return Bitmap::Create(*exfont, rect, true);
+	BitmapRef bm = Bitmap::Create(*exfont, rect, true);
+	bm->SetMemoryCategory(MemoryStats::Category_Text);
+	return bm;
 }
 
 Rect ExFont::GetSize(std::u32string const& /* txt */) const {
@@ -0,0 +1,67 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "frame_pacer.h"
+
+FramePacer::FramePacer(int64_t frame_interval, int max_frameskip, int max_catchup) :
+	frame_interval(frame_interval),
+	max_frameskip(max_frameskip),
+	max_catchup(max_catchup) {
+}
+
+void FramePacer::Reset(int64_t now) {
+	next_frame = now + frame_interval;
+	consecutive_skips = 0;
+	skipped_frames = 0;
+}
+
+bool FramePacer::BeginFrame(int64_t now) {
+	if (now - next_frame > max_catchup * frame_interval) {
+		// Too far behind, drop the backlog instead of never rendering again
+		next_frame = now + frame_interval;
+	}
+
+	// With vsync presenting blocks until the vertical blank, so being
+	// a bit late is the normal case
+	int64_t deadline = vsync ? next_frame + frame_interval : next_frame;
+
+	if (now <= deadline || consecutive_skips >= max_frameskip) {
+		consecutive_skips = 0;
+		return true;
+	}
+
+	++consecutive_skips;
+	++skipped_frames;
+	return false;
+}
+
+int64_t FramePacer::EndFrame(int64_t now) {
+	int64_t wait = next_frame - now;
+	next_frame += frame_interval;
+
+	if (wait <= 0) {
+		return 0;
+	}
+
+	// Presenting the next frame waits for the display
+	if (vsync && wait < frame_interval) {
+		return 0;
+	}
+
+	return wait;
+}
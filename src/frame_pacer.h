@@ -0,0 +1,107 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_FRAME_PACER_H
+#define EASYRPG_FRAME_PACER_H
+
+// Headers
+#include <cstdint>
+
+/**
+ * FramePacer decides which logic frames are rendered and how long the
+ * main loop sleeps between frames.
+ *
+ * The game logic runs at a fixed rate. When the host is too slow, up to
+ * max_frameskip frames in a row are not rendered so the logic can catch
+ * up. When the logic falls behind by more than max_catchup frames the
+ * schedule is reset and the game runs slower instead of skipping
+ * rendering forever.
+ *
+ * All times are in microseconds.
+ */
+class FramePacer {
+public:
+	FramePacer() = default;
+
+	/**
+	 * Creates a frame pacer.
+	 *
+	 * @param frame_interval length of a logic frame.
+	 * @param max_frameskip maximum number of consecutive frames that are
+	 *                      not rendered, 0 renders every frame.
+	 * @param max_catchup maximum number of frames the logic may run behind.
+	 */
+	FramePacer(int64_t frame_interval, int max_frameskip, int max_catchup);
+
+	/**
+	 * Restarts the schedule, e.g. after the game was suspended.
+	 *
+	 * @param now current time.
+	 */
+	void Reset(int64_t now);
+
+	/**
+	 * Starts a logic frame.
+	 *
+	 * @param now current time.
+	 * @return whether the frame shall be rendered.
+	 */
+	bool BeginFrame(int64_t now);
+
+	/**
+	 * Ends a logic frame.
+	 *
+	 * @param now current time.
+	 * @return time to sleep before the next frame starts.
+	 */
+	int64_t EndFrame(int64_t now);
+
+	/**
+	 * Sets whether presenting a frame waits for a vertical blank of a
+	 * display running at the logic frame rate. The display paces the game
+	 * then and frames are only skipped when far behind.
+	 *
+	 * @param vsync vsync pacing flag.
+	 */
+	void SetVsync(bool vsync);
+
+	/**
+	 * @return number of frames that were not rendered since the last reset.
+	 */
+	int GetSkippedFrames() const;
+
+private:
+	int64_t frame_interval = 1000000 / 60;
+	int max_frameskip = 0;
+	int max_catchup = 0;
+	bool vsync = false;
+
+	/** End of the time slot of the current frame */
+	int64_t next_frame = 0;
+	int consecutive_skips = 0;
+	int skipped_frames = 0;
+};
+
+inline int FramePacer::GetSkippedFrames() const {
+	return skipped_frames;
+}
+
+inline void FramePacer::SetVsync(bool vsync) {
+	this->vsync = vsync;
+}
+
+#endif
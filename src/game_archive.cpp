@@ -0,0 +1,302 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <zlib.h>
+#include "game_archive.h"
+#include "filefinder.h"
+#include "output.h"
+#include "utils.h"
+
+const char* const GameArchive::DEFAULT_NAME = "Game.pack";
+
+namespace {
+	const char MAGIC[4] = { 'E', 'A', 'R', 'C' };
+	const uint32_t VERSION = 1;
+	const size_t HEADER_SIZE = 32;
+	const size_t TOC_ENTRY_SIZE = 40;
+	const size_t ALIGNMENT = 16;
+
+	enum Compression {
+		Compression_None = 0,
+		Compression_Zlib = 1
+	};
+
+	std::string NormalizeName(const std::string& name) {
+		std::string lower = Utils::LowerCase(name);
+		std::replace(lower.begin(), lower.end(), '\\', '/');
+		return lower;
+	}
+
+	uint64_t HashName(const std::string& name) {
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ULL;
+		for (char c : NormalizeName(name)) {
+			hash ^= (uint8_t) c;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	uint64_t Get(const uint8_t* p, int bytes) {
+		uint64_t value = 0;
+		for (int i = bytes - 1; i >= 0; --i) {
+			value = (value << 8) | p[i];
+		}
+		return value;
+	}
+
+	void Put(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+		for (int i = 0; i < bytes; ++i) {
+			out.push_back((uint8_t) (value >> (i * 8)));
+		}
+	}
+}
+
+std::shared_ptr<GameArchive> GameArchive::Open(const std::string& filename) {
+	FileSpanRef span = FileSpan::Map(filename);
+	if (!span || span->size() < HEADER_SIZE || memcmp(span->data(), MAGIC, sizeof(MAGIC)) != 0) {
+		return std::shared_ptr<GameArchive>();
+	}
+
+	const uint8_t* header = span->data();
+	if (Get(&header[4], 4) != VERSION) {
+		Output::Warning("Unsupported archive version: %s", filename.c_str());
+		return std::shared_ptr<GameArchive>();
+	}
+
+	uint64_t count = Get(&header[8], 4);
+	uint64_t names_size = Get(&header[12], 4);
+	uint64_t toc_offset = Get(&header[16], 8);
+	uint64_t names_offset = toc_offset + count * TOC_ENTRY_SIZE;
+
+	if (toc_offset > span->size() || names_offset > span->size() ||
+		names_size > span->size() - names_offset) {
+		Output::Warning("Corrupted archive: %s", filename.c_str());
+		return std::shared_ptr<GameArchive>();
+	}
+
+	std::shared_ptr<GameArchive> archive(new GameArchive());
+	archive->path = filename;
+	archive->span = span;
+	archive->entries.resize((size_t) count);
+
+	const char* names = reinterpret_cast<const char*>(span->data() + names_offset);
+	for (size_t i = 0; i < count; ++i) {
+		const uint8_t* p = span->data() + toc_offset + i * TOC_ENTRY_SIZE;
+		Entry& entry = archive->entries[i];
+		entry.hash = Get(&p[0], 8);
+		entry.offset = Get(&p[8], 8);
+		entry.stored_size = Get(&p[16], 8);
+		entry.size = Get(&p[24], 8);
+		uint64_t name_offset = Get(&p[32], 4);
+		uint64_t name_length = Get(&p[36], 2);
+		entry.compression = p[38];
+
+		// zlib compresses at most 1032:1, larger sizes would only allocate memory
+		if (name_offset + name_length > names_size ||
+			entry.offset > span->size() || entry.stored_size > span->size() - entry.offset ||
+			(entry.compression == Compression_None && entry.size != entry.stored_size) ||
+			(entry.compression == Compression_Zlib && entry.size / 1032 > entry.stored_size) ||
+			(i > 0 && entry.hash < archive->entries[i - 1].hash)) {
+			Output::Warning("Corrupted archive: %s", filename.c_str());
+			return std::shared_ptr<GameArchive>();
+		}
+		entry.name.assign(names + name_offset, (size_t) name_length);
+	}
+
+	Output::Debug("Opened archive %s (%d files)", filename.c_str(), (int) count);
+	return archive;
+}
+
+const std::string& GameArchive::GetPath() const {
+	return path;
+}
+
+std::vector<std::string> GameArchive::GetNames() const {
+	std::vector<std::string> names;
+	names.reserve(entries.size());
+	for (const Entry& entry : entries) {
+		names.push_back(entry.name);
+	}
+	return names;
+}
+
+const GameArchive::Entry* GameArchive::Find(const std::string& name) const {
+	uint64_t hash = HashName(name);
+
+	auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+		[](const Entry& entry, uint64_t hash) { return entry.hash < hash; });
+
+	std::string normalized = NormalizeName(name);
+	for (; it != entries.end() && it->hash == hash; ++it) {
+		if (NormalizeName(it->name) == normalized) {
+			return &*it;
+		}
+	}
+	return nullptr;
+}
+
+bool GameArchive::Contains(const std::string& name) const {
+	return Find(name) != nullptr;
+}
+
+int64_t GameArchive::GetSize(const std::string& name) const {
+	const Entry* entry = Find(name);
+	return entry ? (int64_t) entry->size : -1;
+}
+
+FileSpanRef GameArchive::Read(const std::string& name, bool* shared) const {
+	const Entry* entry = Find(name);
+	if (!entry) {
+		return FileSpanRef();
+	}
+
+	if (shared) {
+		*shared = entry->compression == Compression_None;
+	}
+
+	switch (entry->compression) {
+		case Compression_None:
+			return FileSpan::Sub(span, (size_t) entry->offset, (size_t) entry->size);
+		case Compression_Zlib: {
+			std::vector<uint8_t> buffer((size_t) entry->size);
+			uLongf size = (uLongf) entry->size;
+			if (uncompress(buffer.data(), &size, span->data() + entry->offset, (uLong) entry->stored_size) != Z_OK ||
+				size != entry->size) {
+				Output::Warning("Corrupted archive entry: %s", entry->name.c_str());
+				return FileSpanRef();
+			}
+			return FileSpan::FromBuffer(std::move(buffer));
+		}
+		default:
+			Output::Warning("Unsupported compression of archive entry: %s", entry->name.c_str());
+			return FileSpanRef();
+	}
+}
+
+bool GameArchive::Create(const std::string& directory, const std::string& filename) {
+	FileFinder::Directory mem = FileFinder::GetDirectoryMembers(directory, FileFinder::RECURSIVE);
+
+	FILE* out = FileFinder::fopenUTF8(filename, "wb");
+	if (!out) {
+		Output::Warning("Could not create archive %s", filename.c_str());
+		return false;
+	}
+
+	std::vector<Entry> written;
+	// Zeros for the header, which is written last, and the alignment
+	std::vector<uint8_t> padding(HEADER_SIZE);
+	uint64_t offset = HEADER_SIZE;
+	uint64_t total_size = 0;
+	bool ok = fwrite(padding.data(), 1, HEADER_SIZE, out) == HEADER_SIZE;
+
+	for (auto& file : mem.files) {
+		std::string name = file.second;
+		std::replace(name.begin(), name.end(), '\\', '/');
+
+		// Don't pack archives into themselves
+		if (Utils::LowerCase(name) == Utils::LowerCase(DEFAULT_NAME) ||
+			FileFinder::MakePath(directory, file.second) == filename) {
+			continue;
+		}
+
+		FileSpanRef data = FileSpan::Map(FileFinder::MakePath(directory, file.second));
+		if (!data) {
+			Output::Warning("Could not read %s", name.c_str());
+			ok = false;
+			break;
+		}
+
+		Entry entry;
+		entry.hash = HashName(name);
+		entry.offset = offset;
+		entry.size = data->size();
+		entry.stored_size = data->size();
+		entry.compression = Compression_None;
+		entry.name = name;
+
+		const uint8_t* stored = data->data();
+		std::vector<uint8_t> compressed;
+		if (data->size() >= 64) {
+			uLongf compressed_size = compressBound((uLong) data->size());
+			compressed.resize(compressed_size);
+			if (compress2(compressed.data(), &compressed_size, data->data(), (uLong) data->size(), Z_BEST_COMPRESSION) == Z_OK &&
+				compressed_size < data->size() - data->size() / 8) {
+				entry.compression = Compression_Zlib;
+				entry.stored_size = compressed_size;
+				stored = compressed.data();
+			}
+		}
+
+		size_t align = (size_t) ((ALIGNMENT - entry.stored_size % ALIGNMENT) % ALIGNMENT);
+		if ((entry.stored_size > 0 && fwrite(stored, 1, (size_t) entry.stored_size, out) != entry.stored_size) ||
+			fwrite(padding.data(), 1, align, out) != align) {
+			ok = false;
+			break;
+		}
+
+		offset += entry.stored_size + align;
+		total_size += entry.size;
+		written.push_back(entry);
+	}
+
+	std::sort(written.begin(), written.end(),
+		[](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+	std::vector<uint8_t> toc;
+	std::string names;
+	for (const Entry& entry : written) {
+		Put(toc, entry.hash, 8);
+		Put(toc, entry.offset, 8);
+		Put(toc, entry.stored_size, 8);
+		Put(toc, entry.size, 8);
+		Put(toc, names.size(), 4);
+		Put(toc, std::min<size_t>(entry.name.size(), 0xFFFF), 2);
+		Put(toc, entry.compression, 1);
+		Put(toc, 0, 1);
+		names.append(entry.name, 0, 0xFFFF);
+	}
+
+	std::vector<uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+	Put(header, VERSION, 4);
+	Put(header, written.size(), 4);
+	Put(header, names.size(), 4);
+	Put(header, offset, 8);
+	Put(header, 0, 8);
+
+	ok = ok &&
+		(toc.empty() || fwrite(toc.data(), 1, toc.size(), out) == toc.size()) &&
+		(names.empty() || fwrite(names.data(), 1, names.size(), out) == names.size()) &&
+		fseek(out, 0, SEEK_SET) == 0 &&
+		fwrite(header.data(), 1, header.size(), out) == header.size();
+
+	ok = fclose(out) == 0 && ok;
+
+	if (!ok) {
+		Output::Warning("Error writing archive %s", filename.c_str());
+		std::remove(filename.c_str());
+		return false;
+	}
+
+	Output::Debug("Packed %d files (%d KiB) into %s (%d KiB)", (int) written.size(),
+		(int) (total_size / 1024), filename.c_str(), (int) ((offset + toc.size() + names.size()) / 1024));
+	return true;
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_GAME_ARCHIVE_H
+#define EASYRPG_GAME_ARCHIVE_H
+
+// Headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "file_span.h"
+
+/**
+ * GameArchive reads a game that is packed into a single file.
+ *
+ * The archive starts with a 32 byte header:
+ *  "EARC", u32 version, u32 entry count, u32 size of the name table,
+ *  u64 offset of the table of contents, u64 reserved.
+ * The file data follows, every entry aligned to 16 bytes.
+ * The table of contents is sorted by hash and has 40 bytes per entry:
+ *  u64 hash, u64 offset, u64 stored size, u64 size, u32 name offset,
+ *  u16 name length, u8 compression (0 = none, 1 = zlib), u8 reserved.
+ * The name table with the relative paths ("/" separated) comes last.
+ * All numbers are little endian. The hash is 64 bit FNV-1a of the case
+ * lowered path.
+ *
+ * The archive is memory mapped, uncompressed entries are handed out
+ * without copying.
+ */
+class GameArchive {
+public:
+	/** Name of the archive inside of a game directory */
+	static const char* const DEFAULT_NAME;
+
+	/**
+	 * Opens an archive.
+	 *
+	 * @param filename path to the archive
+	 * @return archive or null when the file is not a valid archive
+	 */
+	static std::shared_ptr<GameArchive> Open(const std::string& filename);
+
+	/**
+	 * Packs all files of a directory into an archive.
+	 * Entries are compressed when that saves at least an eighth of their size.
+	 *
+	 * @param directory game directory to pack
+	 * @param filename path of the archive to write
+	 * @return whether the archive was written
+	 */
+	static bool Create(const std::string& directory, const std::string& filename);
+
+	/** @return path the archive was opened from */
+	const std::string& GetPath() const;
+
+	/**
+	 * @return relative paths of all files in the archive
+	 */
+	std::vector<std::string> GetNames() const;
+
+	/**
+	 * Checks whether a file is in the archive.
+	 *
+	 * @param name relative path, case insensitive
+	 * @return whether the file exists
+	 */
+	bool Contains(const std::string& name) const;
+
+	/**
+	 * Gets the uncompressed size of a file.
+	 *
+	 * @param name relative path, case insensitive
+	 * @return size or -1 when the file does not exist
+	 */
+	int64_t GetSize(const std::string& name) const;
+
+	/**
+	 * Reads a file from the archive.
+	 * Uncompressed files share the memory of the archive mapping.
+	 *
+	 * @param name relative path, case insensitive
+	 * @param shared set to whether the span shares the archive memory
+	 * @return contents of the file or null when not found or corrupted
+	 */
+	FileSpanRef Read(const std::string& name, bool* shared = nullptr) const;
+
+private:
+	struct Entry {
+		uint64_t hash;
+		uint64_t offset;
+		uint64_t stored_size;
+		uint64_t size;
+		uint8_t compression;
+		std::string name;
+	};
+
+	const Entry* Find(const std::string& name) const;
+
+	std::string path;
+	FileSpanRef span;
+	std::vector<Entry> entries;
+};
+
+#endif
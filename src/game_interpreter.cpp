@@ -45,6 +45,7 @@
 #include "main_data.h"
 #include "output.h"
 #include "player.h"
+#include "profiler.h"
 #include "util_macro.h"
 #include "reader_util.h"
 #include "game_battle.h"
@@ -134,6 +135,8 @@ void Game_Interpreter::SetContinuation(Game_Interpreter::ContinuationFunction fu
 
 // Update
 void Game_Interpreter::Update() {
+	Profiler::Scope scope("Game_Interpreter::Update");
+
 	updating = true;
 	// 10000 based on: https://gist.github.com/4406621
 	for (loop_count = 0; loop_count < 10000; ++loop_count) {
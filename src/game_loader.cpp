@@ -0,0 +1,276 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <sstream>
+#include "game_loader.h"
+#include "baseui.h"
+#include "bitmap.h"
+#include "cache.h"
+#include "data.h"
+#include "filefinder.h"
+#include "inireader.h"
+#include "ldb_reader.h"
+#include "lmt_reader.h"
+#include "main_data.h"
+#include "options.h"
+#include "output.h"
+#include "player.h"
+#include "reader_lcf.h"
+#include "reader_util.h"
+
+struct GameLoader::Results {
+	std::string project_path;
+	std::shared_ptr<FileFinder::DirectoryTree> tree;
+
+	bool easyrpg_project = false;
+	std::string database_file;
+	std::string treemap_file;
+	bool database_loaded = false;
+	bool treemap_loaded = false;
+	std::string database_error;
+	std::string treemap_error;
+
+	std::string ini_file;
+	bool ini_loaded = false;
+	std::string title;
+	bool full_package = false;
+
+	std::string system_name;
+	BitmapRef system;
+	BitmapRef exfont;
+};
+
+#define STEP(id) (1u << (id))
+
+GameLoader::GameLoader(ProgressCallback progress) :
+	results(std::make_shared<Results>()),
+	progress(progress),
+	binding(std::make_shared<int>()) {
+	start_ticks = DisplayUi->GetTicks();
+
+	std::shared_ptr<Results> r = results;
+
+	steps[StepTree] = { "game directory", 0, [r]() {
+		r->project_path = Main_Data::GetProjectPath();
+
+		std::string save_path = Main_Data::GetSavePath();
+		if (r->project_path == save_path) {
+			Output::Debug("Using %s as Game and Save directory", r->project_path.c_str());
+		} else {
+			Output::Debug("Using %s as Game directory", r->project_path.c_str());
+			Output::Debug("Using %s as Save directory", save_path.c_str());
+		}
+	}, nullptr, [r]() {
+		// FileFinder keeps global state, runs on the main thread
+		r->tree = FileFinder::CreateDirectoryTree(r->project_path);
+		if (!r->tree) {
+			Output::Error("%s is not a valid path", r->project_path.c_str());
+		}
+		FileFinder::SetDirectoryTree(r->tree);
+	}, false };
+
+	// Player::encoding is used by the main thread, detected on the main thread
+	steps[StepEncoding] = { "encoding", STEP(StepTree), []() {
+		Data::Clear();
+	}, nullptr, [r]() {
+		Player::GetEncoding();
+
+		Player::escape_symbol = ReaderUtil::Recode("\\", Player::encoding);
+		if (Player::escape_symbol.empty()) {
+			Output::Error("Invalid encoding: %s.", Player::encoding.c_str());
+		}
+
+		if (!FileFinder::IsRPG2kProject(*FileFinder::GetDirectoryTree()) &&
+			!FileFinder::IsEasyRpgProject(*FileFinder::GetDirectoryTree())) {
+			// Unlikely to happen because of the game browser only launches valid games
+
+			Output::Debug("%s is not a supported project", Main_Data::GetProjectPath().c_str());
+
+			Output::Error("%s\n\n%s\n\n%s\n\n%s","No valid game was found.",
+				"EasyRPG must be run from a game folder containing\nRPG_RT.ldb and RPG_RT.lmt.",
+				"This engine only supports RPG Maker 2000 and 2003\ngames.",
+				"RPG Maker XP, VX, VX Ace and MV are NOT supported.");
+		}
+
+		// Try loading EasyRPG project files first, then fallback to normal RPG Maker
+		std::string edb = FileFinder::FindDefault(DATABASE_NAME_EASYRPG);
+		std::string emt = FileFinder::FindDefault(TREEMAP_NAME_EASYRPG);
+
+		r->easyrpg_project = !edb.empty() && !emt.empty();
+		if (r->easyrpg_project) {
+			r->database_file = FileFinder::MakeLocal(edb);
+			r->treemap_file = FileFinder::MakeLocal(emt);
+		} else {
+			r->database_file = FileFinder::MakeLocal(FileFinder::FindDefault(DATABASE_NAME));
+			r->treemap_file = FileFinder::MakeLocal(FileFinder::FindDefault(TREEMAP_NAME));
+		}
+	}, false };
+
+	// The static state of liblcf (e.g. the error message of LcfReader) is not
+	// thread-safe, the map tree is parsed after the database
+	steps[StepDatabase] = { "database", STEP(StepEncoding), nullptr, [r]() {
+		r->database_loaded = r->easyrpg_project ?
+			LDB_Reader::LoadXml(r->database_file) :
+			LDB_Reader::Load(r->database_file, Player::encoding);
+		if (!r->database_loaded) {
+			r->database_error = LcfReader::GetError();
+		}
+	}, [r]() {
+		if (!r->database_loaded) {
+			Output::ErrorStr(r->database_error);
+		}
+	}, false };
+
+	steps[StepTreemap] = { "map tree", STEP(StepDatabase), nullptr, [r]() {
+		r->treemap_loaded = r->easyrpg_project ?
+			LMT_Reader::LoadXml(r->treemap_file) :
+			LMT_Reader::Load(r->treemap_file, Player::encoding);
+		if (!r->treemap_loaded) {
+			r->treemap_error = LcfReader::GetError();
+		}
+	}, [r]() {
+		if (!r->treemap_loaded) {
+			Output::ErrorStr(r->treemap_error);
+		}
+	}, false };
+
+	steps[StepIni] = { INI_NAME, STEP(StepEncoding), [r]() {
+		r->ini_file = FileFinder::MakeLocal(FileFinder::FindDefault(INI_NAME));
+	}, [r]() {
+		INIReader ini(r->ini_file);
+		if (ini.ParseError() != -1) {
+			r->ini_loaded = true;
+			r->title = ReaderUtil::Recode(ini.Get("RPG_RT", "GameTitle", GAME_TITLE), Player::encoding);
+			r->full_package = ini.Get("RPG_RT", "FullPackageFlag", "0") == "1";
+		}
+	}, [r]() {
+		if (r->ini_loaded) {
+			Player::game_title = r->title;
+			Player::no_rtp_flag = r->full_package ? true : Player::no_rtp_flag;
+		}
+
+		std::stringstream title;
+		if (!Player::game_title.empty()) {
+			Output::Debug("Loading game %s", Player::game_title.c_str());
+			title << Player::game_title << " - ";
+		} else {
+			Output::Warning("Could not read game title.");
+		}
+		title << GAME_TITLE;
+		DisplayUi->SetTitle(title.str());
+	}, false };
+
+	// Uses the game directory, runs on the main thread
+	steps[StepEngine] = { "engine", STEP(StepDatabase) | STEP(StepIni), nullptr, nullptr, []() {
+		Player::DetectEngine();
+	}, false };
+
+	// FileFinder keeps global state, runs on the main thread
+	steps[StepRtp] = { "RTP", STEP(StepEngine), nullptr, nullptr, []() {
+		if (!Player::no_rtp_flag) {
+			FileFinder::InitRtpPaths();
+		}
+	}, false };
+
+	steps[StepSystem] = { "System graphic", STEP(StepRtp), [r]() {
+		r->system_name = Data::system.system_name;
+	}, [r]() {
+		if (!r->system_name.empty()) {
+			r->system = Cache::DecodeSystem(r->system_name);
+		}
+	}, [r]() {
+		Cache::AddSystem(r->system_name, r->system);
+		r->system.reset();
+	}, false };
+
+	steps[StepFont] = { "font", 0, nullptr, [r]() {
+		r->exfont = Cache::DecodeExfont();
+	}, [r]() {
+		Cache::AddExfont(r->exfont);
+		r->exfont.reset();
+	}, false };
+
+	steps[StepObjects] = { "game objects", STEP(StepTreemap) | STEP(StepSystem) | STEP(StepFont), nullptr, nullptr, []() {
+		Player::ResetGameObjects();
+	}, false };
+}
+
+#undef STEP
+
+bool GameLoader::Update() {
+	bool started;
+	do {
+		started = false;
+		for (int i = 0; i < StepCount; ++i) {
+			Step& step = steps[i];
+			if (!step.started && (step.dependencies & finished_mask) == step.dependencies) {
+				StartStep(i);
+				started = true;
+			}
+		}
+	} while (started);
+
+	return IsFinished();
+}
+
+void GameLoader::Finish() {
+	while (!Update()) {
+		// Only wait for the own steps, tasks of others finish in WorkerPool::Update
+		for (int i = 0; i < StepCount; ++i) {
+			if (steps[i].started && (finished_mask & (1u << i)) == 0) {
+				WorkerPool::Wait(jobs[i]);
+			}
+		}
+	}
+}
+
+bool GameLoader::IsFinished() const {
+	return finished_steps == StepCount;
+}
+
+void GameLoader::StartStep(int id) {
+	Step& step = steps[id];
+	step.started = true;
+
+	if (step.prepare) {
+		step.prepare();
+	}
+
+	if (step.task) {
+		jobs[id] = WorkerPool::Run(step.task, [this, id]() { FinishStep(id); }, binding);
+	} else {
+		FinishStep(id);
+	}
+}
+
+void GameLoader::FinishStep(int id) {
+	Step& step = steps[id];
+
+	if (step.done) {
+		step.done();
+	}
+
+	finished_mask |= 1u << id;
+	++finished_steps;
+
+	Output::Debug("Loaded %s after %u ms", step.name, DisplayUi->GetTicks() - start_ticks);
+
+	if (progress) {
+		progress(finished_steps, StepCount);
+	}
+}
@@ -0,0 +1,116 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_GAME_LOADER_H
+#define EASYRPG_GAME_LOADER_H
+
+// Headers
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "worker_pool.h"
+
+/**
+ * GameLoader loads the game in the project directory in steps: scanning
+ * the directory, detecting the encoding, parsing the database and the map
+ * tree, reading RPG_RT.ini, detecting the engine, scanning the RTP and
+ * decoding the System graphic and the ExFont.
+ * The steps form a dependency graph. Steps that only parse or decode
+ * files run in parallel on the worker pool, steps touching global state
+ * run on the main thread. The main loop keeps running in the meantime.
+ */
+class GameLoader {
+public:
+	/**
+	 * Invoked on the main thread after every finished step.
+	 *
+	 * @param finished number of finished steps
+	 * @param total number of steps
+	 */
+	using ProgressCallback = std::function<void(int finished, int total)>;
+
+	/**
+	 * Constructor.
+	 *
+	 * @param progress invoked after every finished step
+	 */
+	GameLoader(ProgressCallback progress = ProgressCallback());
+
+	/**
+	 * Starts all steps whose dependencies finished.
+	 * Called once per frame until it returns true.
+	 *
+	 * @return whether all steps finished
+	 */
+	bool Update();
+
+	/**
+	 * Blocks until all steps finished.
+	 */
+	void Finish();
+
+	/**
+	 * @return whether all steps finished
+	 */
+	bool IsFinished() const;
+
+private:
+	enum StepId {
+		StepTree,
+		StepEncoding,
+		StepDatabase,
+		StepTreemap,
+		StepIni,
+		StepEngine,
+		StepRtp,
+		StepSystem,
+		StepFont,
+		StepObjects,
+		StepCount
+	};
+
+	struct Step {
+		const char* name;
+		/** Bit mask of the steps that must finish before this one */
+		uint32_t dependencies;
+		/** Invoked on the main thread before task */
+		std::function<void()> prepare;
+		/** Invoked on a worker thread, must only touch Results */
+		std::function<void()> task;
+		/** Invoked on the main thread after task */
+		std::function<void()> done;
+		bool started;
+	};
+
+	/** Data passed from the tasks to the done handlers */
+	struct Results;
+
+	void StartStep(int id);
+	void FinishStep(int id);
+
+	Step steps[StepCount];
+	/** WorkerPool ids of the started tasks */
+	int jobs[StepCount] = {};
+	std::shared_ptr<Results> results;
+	uint32_t finished_mask = 0;
+	int finished_steps = 0;
+	uint32_t start_ticks;
+	ProgressCallback progress;
+	WorkerBinding binding;
+};
+
+#endif
@@ -32,8 +32,8 @@
 #include "game_switches.h"
 #include "game_temp.h"
 #include "game_player.h"
-#include "lmu_reader.h"
 #include "reader_lcf.h"
+#include "map_cache.h"
 #include "map_data.h"
 #include "main_data.h"
 #include "output.h"
@@ -41,6 +41,7 @@
 #include "game_system.h"
 #include "filefinder.h"
 #include "player.h"
+#include "profiler.h"
 #include "input.h"
 
 namespace {
@@ -63,7 +64,7 @@ namespace {
 	std::vector<Game_Event> events;
 	std::vector<Game_CommonEvent> common_events;
 
-	std::unique_ptr<RPG::Map> map;
+	std::shared_ptr<const RPG::Map> map;
 	int scroll_direction;
 	int scroll_rest;
 	int scroll_speed;
@@ -237,11 +238,10 @@ void Game_Map::SetupCommon(int _id) {
 		ss.str("");
 		ss << "Map" << std::setfill('0') << std::setw(4) << location.map_id << ".lmu";
 		map_file = FileFinder::FindDefault(ss.str());
-
-		map = LMU_Reader::Load(map_file, Player::encoding);
-	} else {
-		map = LMU_Reader::LoadXml(map_file);
 	}
+
+	// Returning to a recently visited map doesn't parse it again
+	map = MapCache::Load(map_file);
 	Output::Debug("Loading Map %s", ss.str().c_str());
 
 	if (map.get() == NULL) {
@@ -871,6 +871,8 @@ void Game_Map::UpdateScroll() {
 }
 
 void Game_Map::Update(bool only_parallel) {
+	Profiler::Scope scope("Game_Map::Update");
+
 	if (GetNeedRefresh() != Refresh_None) Refresh();
 	UpdateScroll();
 	UpdatePan();
@@ -1071,11 +1073,11 @@ bool Game_Map::IsBattleAnimationWaiting() {
 	return (bool)animation;
 }
 
-std::vector<short>& Game_Map::GetMapDataDown() {
+const std::vector<short>& Game_Map::GetMapDataDown() {
 	return map->lower_layer;
 }
 
-std::vector<short>& Game_Map::GetMapDataUp() {
+const std::vector<short>& Game_Map::GetMapDataUp() {
 	return map->upper_layer;
 }
 
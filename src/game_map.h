@@ -357,14 +357,14 @@ namespace Game_Map {
 	 *
 	 * @return lower layer map data.
 	 */
-	std::vector<short>& GetMapDataDown();
+	const std::vector<short>& GetMapDataDown();
 
 	/**
 	 * Gets upper layer map data.
 	 *
 	 * @return upper layer map data.
 	 */
-	std::vector<short>& GetMapDataUp();
+	const std::vector<short>& GetMapDataUp();
 
 	/**
 	 * Gets chipset Id.
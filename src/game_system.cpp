@@ -34,6 +34,11 @@
 namespace {
 	FileRequestBinding music_request_id;
 	std::map<std::string, FileRequestBinding> se_request_ids;
+
+	// Playback position of the memorized BGM, not part of the savegame
+	size_t memorized_bgm_position = -1;
+	// Position the next requested BGM starts at
+	size_t bgm_start_position = -1;
 }
 
 static RPG::SaveSystem& data = Main_Data::game_data.system;
@@ -94,7 +99,7 @@ void Game_System::BgmPlay(RPG::Music const& bgm) {
 			Audio().BGM_Stop();
 			bgm_pending = true;
 			FileRequestAsync* request = AsyncHandler::RequestFile("Music", bgm.name);
-			music_request_id = request->Bind(&Game_System::OnBgmReady);
+			music_request_id = request->Bind(std::bind(&Game_System::OnBgmReady, std::placeholders::_1, bgm_start_position));
 			request->Start();
 		}
 	} else {
@@ -184,10 +189,15 @@ void Game_System::SetSystemBGM(int which, const RPG::Music& bgm) {
 
 void Game_System::MemorizeBGM() {
 	data.stored_music = data.current_music;
+	memorized_bgm_position = bgm_pending ? -1 : Audio().BGM_Tell();
 }
 
 void Game_System::PlayMemorizedBGM() {
+	// Continue where the music was memorized instead of decoding the
+	// intro again
+	bgm_start_position = memorized_bgm_position;
 	BgmPlay(data.stored_music);
+	bgm_start_position = -1;
 }
 
 RPG::Sound& Game_System::GetSystemSE(int which) {
@@ -341,7 +351,7 @@ void Game_System::SetTransition(int which, int transition) {
 	}
 }
 
-void Game_System::OnBgmReady(FileRequestResult* result) {
+void Game_System::OnBgmReady(FileRequestResult* result, size_t position) {
 	// Take from current_music, params could have changed over time
 	bgm_pending = false;
 	std::string const path = FileFinder::FindMusic(result->file);
@@ -377,12 +387,18 @@ void Game_System::OnBgmReady(FileRequestResult* result) {
 		}
 		
 		Audio().BGM_Play(ineluki_path, data.current_music.volume, data.current_music.tempo, data.current_music.fadein);
+		if (position != (size_t)-1) {
+			Audio().BGM_Seek(position);
+		}
 		
 		return;
 		#endif
 	}
 	
 	Audio().BGM_Play(path, data.current_music.volume, data.current_music.tempo, data.current_music.fadein);
+	if (position != (size_t)-1) {
+		Audio().BGM_Seek(position);
+	}
 }
 
 void Game_System::OnSeReady(FileRequestResult* result, int volume, int tempo) {
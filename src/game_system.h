@@ -234,7 +234,7 @@ namespace Game_System {
 	void MemorizeBGM();
 	void PlayMemorizedBGM();
 
-	void OnBgmReady(FileRequestResult* result);
+	void OnBgmReady(FileRequestResult* result, size_t position);
 	void OnSeReady(FileRequestResult* result, int volume, int tempo);
 }
 
@@ -19,16 +19,19 @@
 #include <algorithm>
 #include <sstream>
 #include <vector>
-#include <list>
+#include <unordered_map>
 
 #include "graphics.h"
 #include "bitmap.h"
+#include "bitmap_pool.h"
 #include "cache.h"
 #include "baseui.h"
 #include "drawable.h"
 #include "util_macro.h"
 #include "output.h"
 #include "player.h"
+#include "profiler.h"
+#include "scratch_arena.h"
 
 namespace Graphics {
 	void UpdateTitle();
@@ -53,10 +56,29 @@ namespace Graphics {
 
 	uint32_t next_fps_time;
 
+	/**
+	 * Entry of the draw list.
+	 * The z value is cached so sorting does not need virtual calls,
+	 * drawables with the same z are drawn in registration order.
+	 */
+	struct DrawableEntry {
+		int z;
+		uint32_t id;
+		Drawable* drawable;
+
+		bool operator<(const DrawableEntry& other) const {
+			return z < other.z || (z == other.z && id < other.id);
+		}
+	};
+
 	struct State {
 		State() {}
-		std::list<Drawable*> drawable_list;
-		bool zlist_dirty = false;
+		/** Sorted by z and registration order */
+		std::vector<DrawableEntry> drawable_list;
+		/** Entry of every drawable in drawable_list for lookups */
+		std::unordered_map<Drawable*, DrawableEntry> entries;
+		/** Drawables whose z changed since the last sort */
+		std::vector<Drawable*> zlist_changes;
 		bool draw_background = true;
 	};
 
@@ -66,7 +88,11 @@ namespace Graphics {
 	std::vector<std::shared_ptr<State> > stack;
 	std::shared_ptr<State> global_state;
 
-	bool SortDrawableList(const Drawable* first, const Drawable* second);
+	uint32_t next_drawable_id = 0;
+
+	State* GetDrawableState(Drawable* drawable);
+	void SortDrawableList(State& state);
+	void DrawList(State& state);
 }
 
 unsigned SecondToFrame(float const second) {
@@ -81,6 +107,8 @@ void Graphics::Init() {
 
 	black_screen = Bitmap::Create(DisplayUi->GetWidth(), DisplayUi->GetHeight(), Color(0,0,0,255));
 
+	ScratchArena::Init();
+
 	state.reset(new State());
 	global_state.reset(new State());
 
@@ -88,12 +116,17 @@ void Graphics::Init() {
 }
 
 void Graphics::Quit() {
-	state->drawable_list.clear();
-	global_state->drawable_list.clear();
+	state.reset(new State());
+	global_state.reset(new State());
+	stack.clear();
 
 	frozen_screen.reset();
 	black_screen.reset();
 
+	BitmapPool::Clear();
+	Bitmap::ReleaseMasks();
+	ScratchArena::Quit();
+
 	Cache::Clear();
 }
 
@@ -149,49 +182,40 @@ void Graphics::UpdateTitle() {
 }
 
 void Graphics::DrawFrame() {
+	Profiler::Scope scope("Graphics::DrawFrame");
+
 	if (transition_frames_left > 0) {
 		UpdateTransition();
 
-		for (Drawable* drawable : global_state->drawable_list) {
-			drawable->Draw();
-		}
+		SortDrawableList(*global_state);
+		DrawList(*global_state);
 
 		DrawOverlay();
 
+		Profiler::Scope display_scope("BaseUi::UpdateDisplay");
 		DisplayUi->UpdateDisplay();
-		return;
-	}
-
-	if (screen_erased) {
+	} else if (screen_erased) {
 		DisplayUi->CleanDisplay();
-		return;
-	}
+	} else {
+		SortDrawableList(*state);
+		SortDrawableList(*global_state);
 
-	if (state->zlist_dirty) {
-		state->drawable_list.sort(SortDrawableList);
-		state->zlist_dirty = false;
-	}
+		if (state->draw_background) {
+			DisplayUi->AddBackground();
+		}
 
-	if (global_state->zlist_dirty) {
-		global_state->drawable_list.sort(SortDrawableList);
-		global_state->zlist_dirty = false;
-	}
+		DrawList(*state);
+		DrawList(*global_state);
 
-	if (state->draw_background) {
-		DisplayUi->AddBackground();
-	}
-
-	for (Drawable* drawable : state->drawable_list) {
-		drawable->Draw();
-	}
+		DrawOverlay();
 
-	for (Drawable* drawable : global_state->drawable_list) {
-		drawable->Draw();
+		Profiler::Scope display_scope("BaseUi::UpdateDisplay");
+		DisplayUi->UpdateDisplay();
 	}
 
-	DrawOverlay();
-
-	DisplayUi->UpdateDisplay();
+	// Temporary memory of this frame is not used anymore
+	ScratchArena::Reset();
+	BitmapPool::Update();
 }
 
 void Graphics::DrawOverlay() {
@@ -206,6 +230,8 @@ void Graphics::DrawOverlay() {
 		DisplayUi->GetDisplaySurface()->Blit(1, 2, *black_screen, Rect(0, 0, rect.width + 1, rect.height - 1), 128);
 		DisplayUi->GetDisplaySurface()->TextDraw(2, 2, Color(255, 255, 255, 255), text.str());
 	}
+
+	Profiler::Draw(*DisplayUi->GetDisplaySurface());
 }
 
 BitmapRef Graphics::SnapToBitmap() {
@@ -213,13 +239,8 @@ BitmapRef Graphics::SnapToBitmap() {
 		DisplayUi->AddBackground();
 	}
 
-	for (Drawable* drawable : state->drawable_list) {
-		drawable->Draw();
-	}
-
-	for (Drawable* drawable : global_state->drawable_list) {
-		drawable->Draw();
-	}
+	DrawList(*state);
+	DrawList(*global_state);
 
 	return DisplayUi->CaptureScreen();
 }
@@ -240,15 +261,8 @@ void Graphics::Transition(TransitionType type, int duration, bool erase) {
 		transition_duration = type == TransitionErase ? 1 : duration;
 		transition_frames_left = transition_duration;
 
-		if (state->zlist_dirty) {
-			state->drawable_list.sort(SortDrawableList);
-			state->zlist_dirty = false;
-		}
-
-		if (global_state->zlist_dirty) {
-			global_state->drawable_list.sort(SortDrawableList);
-			global_state->zlist_dirty = false;
-		}
+		SortDrawableList(*state);
+		SortDrawableList(*global_state);
 
 		Freeze();
 
@@ -441,33 +455,136 @@ void Graphics::FrameReset() {
 }
 
 void Graphics::RegisterDrawable(Drawable* drawable) {
-	if (drawable->IsGlobal()) {
-		global_state->drawable_list.push_back(drawable);
-	} else {
-		state->drawable_list.push_back(drawable);
+	State& s = drawable->IsGlobal() ? *global_state : *state;
+
+	// Drawables of derived classes register again in their own constructor
+	if (s.entries.count(drawable)) {
+		s.zlist_changes.push_back(drawable);
+		return;
 	}
-	UpdateZCallback();
+
+	DrawableEntry entry = { drawable->GetZ(), next_drawable_id++, drawable };
+	s.drawable_list.insert(std::upper_bound(s.drawable_list.begin(), s.drawable_list.end(), entry), entry);
+	s.entries[drawable] = entry;
+
+	// Drawables register in their constructor, the final z is read on the next sort
+	s.zlist_changes.push_back(drawable);
 }
 
 void Graphics::RemoveDrawable(Drawable* drawable) {
-	std::list<Drawable*>::iterator it;
+	State* s = GetDrawableState(drawable);
+	if (!s) {
+		return;
+	}
+
+	auto it = s->entries.find(drawable);
+	auto pos = std::lower_bound(s->drawable_list.begin(), s->drawable_list.end(), it->second);
+	s->drawable_list.erase(pos);
+	s->entries.erase(it);
+
+	s->zlist_changes.erase(
+		std::remove(s->zlist_changes.begin(), s->zlist_changes.end(), drawable),
+		s->zlist_changes.end());
+}
+
+void Graphics::UpdateZCallback(Drawable* drawable) {
+	State* s = GetDrawableState(drawable);
+	if (s) {
+		s->zlist_changes.push_back(drawable);
+	}
+}
+
+Graphics::State* Graphics::GetDrawableState(Drawable* drawable) {
 	if (drawable->IsGlobal()) {
-		it = std::find(global_state->drawable_list.begin(), global_state->drawable_list.end(), drawable);
-		if (it != global_state->drawable_list.end()) { global_state->drawable_list.erase(it); }
-	} else {
-		it = std::find(state->drawable_list.begin(), state->drawable_list.end(), drawable);
-		if (it != state->drawable_list.end()) { state->drawable_list.erase(it); }
+		return global_state->entries.count(drawable) ? global_state.get() : nullptr;
+	}
+
+	if (state->entries.count(drawable)) {
+		return state.get();
+	}
+
+	// Drawables of scenes below the current one
+	for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+		if ((*it)->entries.count(drawable)) {
+			return it->get();
+		}
 	}
+
+	return nullptr;
 }
 
-void Graphics::UpdateZCallback() {
-	state->zlist_dirty = true;
-	global_state->zlist_dirty = true;
+void Graphics::SortDrawableList(State& s) {
+	if (s.zlist_changes.empty()) {
+		return;
+	}
+
+	if (s.zlist_changes.size() > s.drawable_list.size() / 4) {
+		// Many changes, cheaper to refresh all keys and sort once
+		for (DrawableEntry& entry : s.drawable_list) {
+			entry.z = entry.drawable->GetZ();
+			s.entries[entry.drawable].z = entry.z;
+		}
+		std::sort(s.drawable_list.begin(), s.drawable_list.end());
+	} else {
+		for (Drawable* drawable : s.zlist_changes) {
+			DrawableEntry& entry = s.entries[drawable];
+			int z = drawable->GetZ();
+			if (entry.z == z) {
+				continue;
+			}
+
+			auto pos = std::lower_bound(s.drawable_list.begin(), s.drawable_list.end(), entry);
+			s.drawable_list.erase(pos);
+
+			entry.z = z;
+			s.drawable_list.insert(std::upper_bound(s.drawable_list.begin(), s.drawable_list.end(), entry), entry);
+		}
+	}
+
+	s.zlist_changes.clear();
 }
 
-inline bool Graphics::SortDrawableList(const Drawable* first, const Drawable* second) {
-	if (first->GetZ() < second->GetZ()) return true;
-	return false;
+void Graphics::DrawList(State& s) {
+	// Indexed, a Draw call may register or remove drawables
+	if (!Profiler::IsEnabled()) {
+		for (size_t i = 0; i < s.drawable_list.size(); ++i) {
+			s.drawable_list[i].drawable->Draw();
+		}
+		return;
+	}
+
+	// One scope for every run of drawables of the same type
+	static const char* const scope_names[] = {
+		"Draw Window",
+		"Draw Tilemap",
+		"Draw Sprite",
+		"Draw Plane",
+		"Draw Background",
+		"Draw Screen",
+		"Draw Frame",
+		"Draw Weather",
+		"Draw MessageOverlay",
+		"Draw Other"
+	};
+	static_assert(sizeof(scope_names) / sizeof(scope_names[0]) == TypeDefault + 1, "Missing scope name");
+
+	DrawableType type = TypeDefault;
+	bool open = false;
+	for (size_t i = 0; i < s.drawable_list.size(); ++i) {
+		Drawable* drawable = s.drawable_list[i].drawable;
+		if (!open || drawable->GetType() != type) {
+			if (open) {
+				Profiler::End();
+			}
+			type = drawable->GetType();
+			Profiler::Begin(scope_names[type]);
+			open = true;
+		}
+		drawable->Draw();
+	}
+	if (open) {
+		Profiler::End();
+	}
 }
 
 void Graphics::Push(bool draw_background) {
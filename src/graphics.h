@@ -123,7 +123,13 @@ namespace Graphics {
 	void RegisterDrawable(Drawable* drawable);
 	void RemoveDrawable(Drawable* drawable);
 
-	void UpdateZCallback();
+	/**
+	 * Notifies that the z value of a drawable changes.
+	 * The draw list is reordered before the next frame is drawn.
+	 *
+	 * @param drawable drawable with changed z.
+	 */
+	void UpdateZCallback(Drawable* drawable);
 
 	void Push(bool draw_background = true);
 	void Pop();
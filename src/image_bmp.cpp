@@ -19,7 +19,6 @@
 #include "system.h"
 #ifdef SUPPORT_BMP
 
-#include <cstdlib>
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
@@ -35,10 +34,7 @@ static uint32_t get_4(const uint8_t *p) {
 	return (uint32_t) p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
 }
 
-bool ImageBMP::ReadBMP(const uint8_t* data, unsigned len, bool transparent,
-					   int& width, int& height, void*& pixels) {
-	pixels = nullptr;
-
+bool ImageBMP::ReadBMP(const uint8_t* data, unsigned len, bool transparent, ImageOut& out) {
 	if (len < 64) {
 		Output::Warning("Not a valid BMP file.");
 		return false;
@@ -76,15 +72,29 @@ bool ImageBMP::ReadBMP(const uint8_t* data, unsigned len, bool transparent,
 	if (num_colors == 0) // 0 means default, i.e. max.
 		num_colors = depth << 2;
 
-	uint8_t (*palette)[4] = (uint8_t(*)[4]) &data[BITMAPFILEHEADER_SIZE +
+	const uint8_t (*palette)[4] = (const uint8_t(*)[4]) &data[BITMAPFILEHEADER_SIZE +
 		get_4(&data[BITMAPFILEHEADER_SIZE + 0])];
 
+	// BMP palettes are stored as BGRX. Indices past num_colors still
+	// address the palette area, so convert every entry that is present.
+	int palette_size = std::min<int>(1 << depth,
+		(len - ((const uint8_t*) palette - data)) / 4);
+	palette_size = std::max(palette_size, num_colors);
+
+	uint8_t colors[256][4];
+	for (int i = 0; i < palette_size; i++) {
+		colors[i][0] = palette[i][2];
+		colors[i][1] = palette[i][1];
+		colors[i][2] = palette[i][0];
+		colors[i][3] = (transparent && i == 0) ? 0 : 255;
+	}
+
 	// Ensure no palette entry is an exact duplicate of the transparent color at #0
 	for (int i = 1; i < num_colors; i++) {
-		if (palette[i][0] == palette[0][0] &&
-			palette[i][1] == palette[0][1] &&
-			palette[i][2] == palette[0][2]) {
-			palette[i][0] ^= 1;
+		if (colors[i][0] == colors[0][0] &&
+			colors[i][1] == colors[0][1] &&
+			colors[i][2] == colors[0][2]) {
+			colors[i][2] ^= 1;
 		}
 	}
 
@@ -94,63 +104,32 @@ bool ImageBMP::ReadBMP(const uint8_t* data, unsigned len, bool transparent,
 	int line_width = (depth == 4) ? (w + 1) >> 1 : w;
 	int padding = (-line_width)&3;
 
-	pixels = malloc(w * h * 4);
-	if (!pixels) {
+	uint8_t* indices = out.Begin(w, h);
+	if (!indices) {
 		Output::Warning("Error allocating BMP pixel buffer.");
 		return false;
 	}
+	out.SetPalette(colors, palette_size);
 
-	uint8_t* dst = (uint8_t*) pixels;
 	for (unsigned int y = 0; y < h; y++) {
 		const uint8_t* src = src_pixels + (vflip ? h - 1 - y : y) * (line_width + padding);
+
+		if (depth == 8) {
+			out.WriteIndexedRow(y, src);
+			continue;
+		}
+
+		// split up packed pixels
 		for (unsigned int x = 0; x < w; x += 2) {
 			uint8_t pix = *src++;
-			uint8_t pix2 = 0;
-			const uint8_t* color;
-
-			// split up packed pixel
-			if (depth == 4) {
-				pix2 = pix & 15;
-				pix >>= 4;
-			}
-
-			color = palette[pix];
-			*dst++ = color[2];
-			*dst++ = color[1];
-			*dst++ = color[0];
-			*dst++ = (transparent && pix == 0) ? 0 : 255;
-
-			// end of line
-			if (x + 1 == w)
-				break;
-
-			pix = (depth == 8) ? *src++ : pix2;
-
-			color = palette[pix];
-			*dst++ = color[2];
-			*dst++ = color[1];
-			*dst++ = color[0];
-			*dst++ = (transparent && pix == 0) ? 0 : 255;
+			indices[x] = pix >> 4;
+			if (x + 1 < w)
+				indices[x + 1] = pix & 15;
 		}
+		out.WriteIndexedRow(y, indices);
 	}
 
-	width = w;
-	height = h;
 	return true;
 }
 
-bool ImageBMP::ReadBMP(FILE* stream, bool transparent,
-					int& width, int& height, void*& pixels) {
-	fseek(stream, 0, SEEK_END);
-	long size = ftell(stream);
-	fseek(stream, 0, SEEK_SET);
-	std::vector<uint8_t> buffer(size);
-	long size_read = fread((void*) &buffer.front(), 1, size, stream);
-	if (size_read != size) {
-		Output::Warning("Error reading BMP file.");
-		return false;
-	}
-	return ReadBMP(&buffer.front(), (unsigned) size, transparent, width, height, pixels);
-}
-
 #endif // SUPPORT_BMP
@@ -19,13 +19,13 @@
 #define _EASYRPG_IMAGE_BMP_H_
 
 #include "system.h"
+#include "image_out.h"
 #ifdef SUPPORT_BMP
 
 #include <cstdio>
 
 namespace ImageBMP {
-	bool ReadBMP(const uint8_t* data, unsigned len, bool transparent, int& width, int& height, void*& pixels);
-	bool ReadBMP(FILE* stream, bool transparent, int& width, int& height, void*& pixels);
+	bool ReadBMP(const uint8_t* data, unsigned len, bool transparent, ImageOut& out);
 }
 
 #endif // SUPPORT_BMP
@@ -0,0 +1,69 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _EASYRPG_IMAGE_OUT_H_
+#define _EASYRPG_IMAGE_OUT_H_
+
+#include <cstdint>
+
+/**
+ * Destination of the image decoders.
+ * The decoders hand over the image row by row so the receiver can convert
+ * the pixels straight into its own format without an intermediate RGBA
+ * copy of the whole image.
+ */
+class ImageOut {
+public:
+	virtual ~ImageOut() {}
+
+	/**
+	 * Called once the image dimensions are known.
+	 *
+	 * @param width image width
+	 * @param height image height
+	 * @return scratch buffer for one row (width * 4 bytes) or null when
+	 *         the destination could not be allocated
+	 */
+	virtual uint8_t* Begin(int width, int height) = 0;
+
+	/**
+	 * Writes one row of non-premultiplied 8 bit RGBA pixels.
+	 *
+	 * @param y row
+	 * @param rgba width RGBA pixels
+	 */
+	virtual void WriteRow(int y, const uint8_t* rgba) = 0;
+
+	/**
+	 * Sets the palette used by WriteIndexedRow.
+	 * Entries past count are opaque black.
+	 *
+	 * @param rgba non-premultiplied 8 bit RGBA colors
+	 * @param count number of colors (at most 256)
+	 */
+	virtual void SetPalette(const uint8_t (*rgba)[4], int count) = 0;
+
+	/**
+	 * Writes one row of 8 bit palette indices.
+	 *
+	 * @param y row
+	 * @param indices width palette indices
+	 */
+	virtual void WriteIndexedRow(int y, const uint8_t* indices) = 0;
+};
+
+#endif
@@ -23,15 +23,27 @@
 #include <cstdlib>
 #include <cstring>
 #include <csetjmp>
+#include <algorithm>
 #include <vector>
 
 #include "output.h"
 #include "image_png.h"
 
+namespace {
+	struct PngInput {
+		const uint8_t* data;
+		size_t remaining;
+	};
+}
+
 static void read_data(png_structp png_ptr, png_bytep data, png_size_t length) {
-    png_bytep* bufp = (png_bytep*) png_get_io_ptr(png_ptr);
-	memcpy(data, *bufp, length);
-	*bufp += length;
+	PngInput* input = (PngInput*) png_get_io_ptr(png_ptr);
+	if (length > input->remaining) {
+		png_error(png_ptr, "Unexpected end of file");
+	}
+	memcpy(data, input->data, length);
+	input->data += length;
+	input->remaining -= length;
 }
 
 static void on_png_warning(png_structp, png_const_charp warn_msg) {
@@ -42,16 +54,11 @@ static void on_png_error(png_structp, png_const_charp error_msg) {
 	Output::Warning("libpng: %s", error_msg);
 }
 
-static void ReadPalettedData(png_struct*, png_info*, png_uint_32, png_uint_32, bool, uint32_t*);
-static void ReadGrayData(png_struct*, png_info*, png_uint_32, png_uint_32, bool, uint32_t*);
-static void ReadGrayAlphaData(png_struct*, png_info*, png_uint_32, png_uint_32, uint32_t*);
-static void ReadRGBData(png_struct*, png_info*, png_uint_32, png_uint_32, uint32_t*);
-static void ReadRGBAData(png_struct*, png_info*, png_uint_32, png_uint_32, uint32_t*);
-
-bool ImagePNG::ReadPNG(FILE* stream, const void* buffer, bool transparent,
-					   int& width, int& height, void*& pixels) {
-	pixels = nullptr;
+static void ReadPalettedData(png_struct*, png_info*, png_uint_32, bool, ImageOut&, uint8_t*);
+static void ReadGrayData(png_struct*, png_info*, png_uint_32, bool, ImageOut&, uint8_t*);
+static void ReadRGBAData(png_struct*, png_info*, png_uint_32, ImageOut&, uint8_t*);
 
+bool ImagePNG::ReadPNG(const uint8_t* data, unsigned len, bool transparent, ImageOut& out) {
 	png_struct *png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, on_png_error, on_png_warning);
 	if (png_ptr == NULL) {
 		Output::Warning("Couldn't allocate PNG structure");
@@ -69,10 +76,8 @@ bool ImagePNG::ReadPNG(FILE* stream, const void* buffer, bool transparent,
 		return false;
 	}
 
-	if (stream != NULL)
-		png_init_io(png_ptr, stream);
-	else
-		png_set_read_fn(png_ptr, (png_voidp) &buffer, read_data);
+	PngInput input = { data, len };
+	png_set_read_fn(png_ptr, (png_voidp) &input, read_data);
 
 	png_read_info(png_ptr, info_ptr);
 
@@ -81,167 +86,128 @@ bool ImagePNG::ReadPNG(FILE* stream, const void* buffer, bool transparent,
 	png_get_IHDR(png_ptr, info_ptr, &w, &h,
 				 &bit_depth, &color_type, NULL, NULL, NULL);
 
-	pixels = malloc(w * h * 4);
-	if (!pixels) {
+	// The row buffer is owned by out, nothing leaks when libpng longjmps
+	uint8_t* row = out.Begin(w, h);
+	if (!row) {
 		Output::Warning("Error allocating PNG pixel buffer.");
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 		return false;
 	}
 
 	switch (color_type) {
 		case PNG_COLOR_TYPE_PALETTE:
-			ReadPalettedData(png_ptr, info_ptr, w, h, transparent, (uint32_t*)pixels);
+			ReadPalettedData(png_ptr, info_ptr, h, transparent, out, row);
 			break;
 		case PNG_COLOR_TYPE_GRAY:
-			ReadGrayData(png_ptr, info_ptr, w, h, transparent, (uint32_t*)pixels);
+			ReadGrayData(png_ptr, info_ptr, h, transparent, out, row);
 			break;
 		case PNG_COLOR_TYPE_GRAY_ALPHA:
-			ReadGrayAlphaData(png_ptr, info_ptr, w, h, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
+			png_set_gray_to_rgb(png_ptr);
+			ReadRGBAData(png_ptr, info_ptr, h, out, row);
 			break;
 		case PNG_COLOR_TYPE_RGB:
-			ReadRGBData(png_ptr, info_ptr, w, h, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+			ReadRGBAData(png_ptr, info_ptr, h, out, row);
 			break;
 		case PNG_COLOR_TYPE_RGB_ALPHA:
-			ReadRGBAData(png_ptr, info_ptr, w, h, (uint32_t*)pixels);
+			png_set_strip_16(png_ptr);
+			ReadRGBAData(png_ptr, info_ptr, h, out, row);
 			break;
 	}
 
 	png_read_end(png_ptr, NULL);
 	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 
-	width = w;
-	height = h;
 	return true;
 }
 
 static void ReadPalettedData(
 	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
+	png_uint_32 h,
 	bool transparent,
-	uint32_t* pixels
+	ImageOut& out, uint8_t* row
 ) {
-	// For transparent images, all the colors are opaque, except the
-	// color with index 0. So we'll need to do index->RGB conversion
-	// on our own.
-	if (transparent) {
-		png_set_packing(png_ptr);
-		png_read_update_info(png_ptr, info_ptr);
-
-		if (!png_get_valid(png_ptr, info_ptr, PNG_INFO_PLTE)) {
-			Output::Warning("Palette PNG without PLTE block");
-			return;
-		}
+	// The indices are passed through, out converts them with the palette
+	png_set_packing(png_ptr);
+	png_read_update_info(png_ptr, info_ptr);
 
-		png_colorp palette;
-		int num_palette;
-		png_get_PLTE(png_ptr, info_ptr, &palette, &num_palette);
-
-		for (png_uint_32 y = 0; y < h; y++) {
-			// We read the indices (w bytes) into the end of the pixel
-			// data for this row (4w bytes), then scan over them
-			// converting them into RGBA values. Putting them at the end
-			// gives us enough room that we don't overwrite an index
-			// we'll need later with an RGBA value.
-
-			uint32_t* beginning_of_row = pixels + y * w;
-
-			uint8_t* indices = (uint8_t*)beginning_of_row + w * 3;
-			png_read_row(png_ptr, (png_bytep)indices, NULL);
-
-			uint32_t* dst = beginning_of_row;
-			for (png_uint_32 x = 0; x < w; x++, dst++) {
-				uint8_t idx = indices[x];
-				png_color& color = palette[idx];
-				uint8_t alpha = idx == 0 ? 0 : 255;
-				uint8_t rgba[4] = { color.red, color.green, color.blue, alpha };
-				*dst = *(uint32_t*)rgba;
-			}
-		}
+	if (!png_get_valid(png_ptr, info_ptr, PNG_INFO_PLTE)) {
+		Output::Warning("Palette PNG without PLTE block");
+		return;
 	}
-	// Otherwise, libpng can convert to RGBA on its own
-	else {
-		png_set_palette_to_rgb(png_ptr);
-		png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-		png_read_update_info(png_ptr, info_ptr);
-
-		for (png_uint_32 y = 0; y < h; y++) {
-			png_bytep dst = (png_bytep) pixels + y * w * 4;
-			png_read_row(png_ptr, dst, NULL);
-		}
-	}
-}
 
-static void ReadGrayData(
-	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	bool transparent,
-	uint32_t* pixels
-) {
-	png_set_strip_16(png_ptr);
-	png_set_expand(png_ptr);
-	png_set_gray_to_rgb(png_ptr);
-	png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-	png_read_update_info(png_ptr, info_ptr);
+	png_colorp palette;
+	int num_palette;
+	png_get_PLTE(png_ptr, info_ptr, &palette, &num_palette);
 
-	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
+	// For transparent images, all the colors are opaque, except the
+	// color with index 0. Otherwise the tRNS block is honored.
+	png_bytep trans_alpha = NULL;
+	int num_trans = 0;
+	if (!transparent && png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
+		png_get_tRNS(png_ptr, info_ptr, &trans_alpha, &num_trans, NULL);
 	}
 
-	// Black pixels are transparent
-	if (transparent) {
-		uint8_t ck1[4] = {0, 0, 0, 255};
-		uint8_t ck2[4] = {0, 0, 0,   0};
-		uint32_t srckey = *(uint32_t*)ck1;
-		uint32_t dstkey = *(uint32_t*)ck2;
-		uint32_t* p = (uint32_t*) pixels;
-		for (unsigned i = 0; i < w * h; i++, p++)
-			if (*p == srckey)
-				*p = dstkey;
+	uint8_t colors[256][4];
+	for (int i = 0; i < num_palette && i < 256; i++) {
+		colors[i][0] = palette[i].red;
+		colors[i][1] = palette[i].green;
+		colors[i][2] = palette[i].blue;
+		if (transparent)
+			colors[i][3] = i == 0 ? 0 : 255;
+		else
+			colors[i][3] = i < num_trans ? trans_alpha[i] : 255;
 	}
-}
-
-static void ReadGrayAlphaData(
-	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	uint32_t* pixels
-) {
-	png_set_strip_16(png_ptr);
-	png_set_gray_to_rgb(png_ptr);
-	png_read_update_info(png_ptr, info_ptr);
+	out.SetPalette(colors, std::min(num_palette, 256));
 
 	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
+		png_read_row(png_ptr, (png_bytep) row, NULL);
+		out.WriteIndexedRow(y, row);
 	}
 }
 
-
-static void ReadRGBData(
+static void ReadGrayData(
 	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	uint32_t* pixels
+	png_uint_32 h,
+	bool transparent,
+	ImageOut& out, uint8_t* row
 ) {
 	png_set_strip_16(png_ptr);
+	png_set_expand(png_ptr);
+	png_set_gray_to_rgb(png_ptr);
 	png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
 	png_read_update_info(png_ptr, info_ptr);
 
+	png_uint_32 w = png_get_image_width(png_ptr, info_ptr);
+
 	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
+		png_read_row(png_ptr, (png_bytep) row, NULL);
+
+		// Black pixels are transparent
+		if (transparent) {
+			uint8_t* p = row;
+			for (png_uint_32 x = 0; x < w; x++, p += 4) {
+				if (p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 255)
+					p[3] = 0;
+			}
+		}
+
+		out.WriteRow(y, row);
 	}
 }
 
 static void ReadRGBAData(
 	png_struct* png_ptr, png_info* info_ptr,
-	png_uint_32 w, png_uint_32 h,
-	uint32_t* pixels
+	png_uint_32 h,
+	ImageOut& out, uint8_t* row
 ) {
-	png_set_strip_16(png_ptr);
 	png_read_update_info(png_ptr, info_ptr);
 
 	for (png_uint_32 y = 0; y < h; y++) {
-		png_bytep dst = (png_bytep) pixels + y * w * 4;
-		png_read_row(png_ptr, dst, NULL);
+		png_read_row(png_ptr, (png_bytep) row, NULL);
+		out.WriteRow(y, row);
 	}
 }
 
@@ -19,13 +19,14 @@
 #define _EASYRPG_IMAGE_PNG_H_
 
 #include "system.h"
+#include "image_out.h"
 #ifdef SUPPORT_PNG
 
 #include <cstdio>
 #include <ostream>
 
 namespace ImagePNG {
-	bool ReadPNG(FILE* stream, const void* buffer, bool transparent, int& width, int& height, void*& pixels);
+	bool ReadPNG(const uint8_t* data, unsigned len, bool transparent, ImageOut& out);
 	bool WritePNG(std::ostream& os, uint32_t width, uint32_t height, uint32_t* data);
 }
 
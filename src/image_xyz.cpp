@@ -19,17 +19,13 @@
 #include "system.h"
 #ifdef SUPPORT_XYZ
 
-#include <cstdlib>
 #include <cstring>
 #include <zlib.h>
 #include <vector>
 #include "output.h"
 #include "image_xyz.h"
 
-bool ImageXYZ::ReadXYZ(const uint8_t* data, unsigned len, bool transparent,
-					   int& width, int& height, void*& pixels) {
-	pixels = nullptr;
-
+bool ImageXYZ::ReadXYZ(const uint8_t* data, unsigned len, bool transparent, ImageOut& out) {
 	if (len < 8) {
 		Output::Warning("Not a valid XYZ file.");
 		return false;
@@ -49,42 +45,28 @@ bool ImageXYZ::ReadXYZ(const uint8_t* data, unsigned len, bool transparent,
 	}
 	const uint8_t (*palette)[3] = (const uint8_t(*)[3]) &dst_buffer.front();
 
-	pixels = malloc(w * h * 4);
-	if (!pixels) {
+	if (!out.Begin(w, h)) {
 		Output::Warning("Error allocating XYZ pixel buffer.");
 		return false;
 	}
 
-	uint8_t* dst = (uint8_t*) pixels;
+	uint8_t colors[256][4];
+	for (int i = 0; i < 256; i++) {
+		colors[i][0] = palette[i][0];
+		colors[i][1] = palette[i][1];
+		colors[i][2] = palette[i][2];
+		colors[i][3] = (transparent && i == 0) ? 0 : 255;
+	}
+	out.SetPalette(colors, 256);
+
+	// The decompressed indices are already laid out row by row
 	const uint8_t* src = (const uint8_t*) &dst_buffer[768];
 	for (int y = 0; y < h; y++) {
-		for (int x = 0; x < w; x++) {
-			uint8_t pix = *src++;
-			const uint8_t* color = palette[pix];
-			*dst++ = color[0];
-			*dst++ = color[1];
-			*dst++ = color[2];
-			*dst++ = (transparent && pix == 0) ? 0 : 255;
-		}
+		out.WriteIndexedRow(y, src);
+		src += w;
 	}
 
-	width = w;
-	height = h;
 	return true;
 }
 
-bool ImageXYZ::ReadXYZ(FILE* stream, bool transparent,
-					   int& width, int& height, void*& pixels) {
-	fseek(stream, 0, SEEK_END);
-	long size = ftell(stream);
-	fseek(stream, 0, SEEK_SET);
-	std::vector<uint8_t> buffer(size);
-	long size_read = fread((void*) &buffer.front(), 1, size, stream);
-	if (size_read != size) {
-		Output::Warning("Error reading XYZ file.");
-		return false;
-	}
-	return ReadXYZ(&buffer.front(), (unsigned) size, transparent, width, height, pixels);
-}
-
 #endif // SUPPORT_XYZ
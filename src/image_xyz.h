@@ -20,11 +20,11 @@
 
 #include <cstdio>
 #include "system.h"
+#include "image_out.h"
 #ifdef SUPPORT_XYZ
 
 namespace ImageXYZ {
-	bool ReadXYZ(const uint8_t* data, unsigned len, bool transparent, int& width, int& height, void*& pixels);
-	bool ReadXYZ(FILE* stream, bool transparent, int& width, int& height, void*& pixels);
+	bool ReadXYZ(const uint8_t* data, unsigned len, bool transparent, ImageOut& out);
 }
 
 #endif // SUPPORT_XYZ
@@ -17,11 +17,17 @@
 
 // Headers
 #include "input.h"
+#include "filefinder.h"
+#include "output.h"
 #include "player.h"
 #include "system.h"
 
 #include <algorithm>
 #include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 namespace Input {
 	std::array<int, BUTTON_COUNT> press_time;
@@ -36,6 +42,56 @@ namespace Input {
 	bool wait_input = false;
 }
 
+namespace {
+	/** Names of the buttons in the input log, in the order of InputButton */
+	const char* const button_names[] = {
+		"UP", "DOWN", "LEFT", "RIGHT", "DECISION", "CANCEL", "SHIFT",
+		"N0", "N1", "N2", "N3", "N4", "N5", "N6", "N7", "N8", "N9",
+		"PLUS", "MINUS", "MULTIPLY", "DIVIDE", "PERIOD",
+		"DEBUG_MENU", "DEBUG_THROUGH", "DEBUG_SAVE", "QUICK_SAVE", "QUICK_LOAD",
+		"TOGGLE_FPS", "TAKE_SCREENSHOT", "SHOW_LOG", "TOGGLE_PROFILER",
+		"PAGE_UP", "PAGE_DOWN"
+	};
+	static_assert(sizeof(button_names) / sizeof(button_names[0]) == Input::BUTTON_COUNT,
+		"button_names does not match InputButton");
+
+	const char* const log_header = "EasyRPG Player input log";
+
+	typedef std::bitset<Input::BUTTON_COUNT> ButtonState;
+
+	/** Frames passed since recording or replay started */
+	int log_frame = 0;
+
+	std::shared_ptr<std::fstream> record_log;
+	ButtonState recorded_state;
+
+	bool replaying = false;
+	/** Changes of the button state, sorted by frame */
+	std::vector<std::pair<int, ButtonState>> replay_log;
+	size_t replay_pos;
+	ButtonState replay_state;
+	int replay_end;
+
+	void WriteState(const ButtonState& state) {
+		*record_log << log_frame;
+		for (unsigned i = 0; i < Input::BUTTON_COUNT; ++i) {
+			if (state[i]) {
+				*record_log << " " << button_names[i];
+			}
+		}
+		*record_log << "\n";
+	}
+
+	int FindButton(const std::string& name) {
+		for (unsigned i = 0; i < Input::BUTTON_COUNT; ++i) {
+			if (name == button_names[i]) {
+				return i;
+			}
+		}
+		return -1;
+	}
+}
+
 bool Input::IsWaitingInput() { return wait_input; }
 void Input::WaitInput(bool v) { wait_input = v; }
 
@@ -54,21 +110,39 @@ void Input::Init() {
 void Input::Update() {
 	wait_input = false; // clear each frame
 
-	BaseUi::KeyStatus& keystates = DisplayUi->GetKeyStates();
+	ButtonState pressed_buttons;
 
-	// Check button states
-	for (unsigned i = 0; i < BUTTON_COUNT; ++i) {
-		bool pressed = false;
+	if (replaying && log_frame < replay_end) {
+		// Apply all changes up to this frame
+		while (replay_pos < replay_log.size() && replay_log[replay_pos].first <= log_frame) {
+			replay_state = replay_log[replay_pos].second;
+			++replay_pos;
+		}
+		pressed_buttons = replay_state;
+	} else {
+		BaseUi::KeyStatus& keystates = DisplayUi->GetKeyStates();
 
 		// Check state of keys assigned to button
-		for (unsigned e = 0; e < buttons[i].size(); e++) {
-			if (keystates[buttons[i][e]]) {
-				pressed = true;
-				break;
+		for (unsigned i = 0; i < BUTTON_COUNT; ++i) {
+			for (unsigned e = 0; e < buttons[i].size(); e++) {
+				if (keystates[buttons[i][e]]) {
+					pressed_buttons[i] = true;
+					break;
+				}
 			}
 		}
 
-		if (pressed) {
+		// Only changes of the state are logged
+		if (record_log && (log_frame == 0 || pressed_buttons != recorded_state)) {
+			WriteState(pressed_buttons);
+			recorded_state = pressed_buttons;
+		}
+	}
+	++log_frame;
+
+	// Check button states
+	for (unsigned i = 0; i < BUTTON_COUNT; ++i) {
+		if (pressed_buttons[i]) {
 			released[i] = false;
 			press_time[i] += 1;
 		} else {
@@ -224,3 +298,99 @@ std::vector<Input::InputButton> Input::GetAllReleased() {
 	}
 	return vector;
 }
+
+bool Input::StartRecording(const std::string& file, int32_t seed) {
+	record_log = FileFinder::openUTF8(file, std::ios_base::out | std::ios_base::trunc);
+	if (!record_log) {
+		Output::Warning("Input: Could not create log %s", file.c_str());
+		return false;
+	}
+
+	*record_log << log_header << "\n";
+	*record_log << "seed " << seed << "\n";
+
+	log_frame = 0;
+	recorded_state.reset();
+	Output::Debug("Input: Recording to %s", file.c_str());
+	return true;
+}
+
+void Input::StopRecording() {
+	if (!record_log) {
+		return;
+	}
+
+	*record_log << "end " << log_frame << "\n";
+	record_log.reset();
+}
+
+bool Input::StartReplay(const std::string& file, int32_t& seed) {
+	std::shared_ptr<std::fstream> in = FileFinder::openUTF8(file, std::ios_base::in);
+	if (!in) {
+		Output::Warning("Input: Could not open log %s", file.c_str());
+		return false;
+	}
+
+	std::string line;
+	if (!std::getline(*in, line) || line.compare(0, strlen(log_header), log_header) != 0) {
+		Output::Warning("Input: %s is not an input log", file.c_str());
+		return false;
+	}
+
+	seed = 0;
+	replay_log.clear();
+	replay_end = -1;
+
+	int line_number = 1;
+	while (std::getline(*in, line)) {
+		++line_number;
+		std::istringstream tokens(line);
+		std::string token;
+		if (!(tokens >> token) || token[0] == '#') {
+			continue;
+		}
+
+		if (token == "seed") {
+			tokens >> seed;
+		} else if (token == "end") {
+			tokens >> replay_end;
+		} else {
+			ButtonState state;
+			int frame = atoi(token.c_str());
+			while (tokens >> token) {
+				int button = FindButton(token);
+				if (button < 0) {
+					Output::Warning("Input: Unknown button %s in line %d of %s",
+						token.c_str(), line_number, file.c_str());
+					continue;
+				}
+				state[button] = true;
+			}
+			if (!replay_log.empty() && frame < replay_log.back().first) {
+				Output::Warning("Input: Line %d of %s is out of order", line_number, file.c_str());
+				continue;
+			}
+			replay_log.push_back({frame, state});
+		}
+	}
+
+	// Logs of a crashed session have no end, stop after the last change
+	if (replay_end < 0) {
+		replay_end = replay_log.empty() ? 0 : replay_log.back().first + 1;
+	}
+
+	log_frame = 0;
+	replay_pos = 0;
+	replay_state.reset();
+	replaying = true;
+	Output::Debug("Input: Replaying %s (%d frames)", file.c_str(), replay_end);
+	return true;
+}
+
+bool Input::IsRecordingOrReplaying() {
+	return record_log || (replaying && log_frame < replay_end);
+}
+
+bool Input::IsReplayFinished() {
+	return replaying && log_frame >= replay_end;
+}
@@ -21,6 +21,7 @@
 // Headers
 #include <vector>
 #include <bitset>
+#include <string>
 #include "system.h"
 #include "input_buttons.h"
 
@@ -139,6 +140,46 @@ namespace Input {
 	 */
 	std::vector<InputButton> GetAllReleased();
 
+	/**
+	 * Starts writing the pressed buttons of every following
+	 * frame to a log file which can be replayed later.
+	 *
+	 * @param file log file.
+	 * @param seed seed of the random number generator, stored in the log.
+	 * @return whether the log file could be created.
+	 */
+	bool StartRecording(const std::string& file, int32_t seed);
+
+	/**
+	 * Ends the log of a running recording.
+	 */
+	void StopRecording();
+
+	/**
+	 * Reads a log written by StartRecording. The following
+	 * frames use the button states of the log instead of the
+	 * keyboard until the end of the log is reached.
+	 *
+	 * @param file log file.
+	 * @param seed receives the seed of the random number generator.
+	 * @return whether the log could be read.
+	 */
+	bool StartReplay(const std::string& file, int32_t& seed);
+
+	/**
+	 * Gets if a recording or a replay is running.
+	 *
+	 * @return whether the button states are recorded or replayed.
+	 */
+	bool IsRecordingOrReplaying();
+
+	/**
+	 * Gets if a replay reached the end of its log.
+	 *
+	 * @return whether the replay is finished.
+	 */
+	bool IsReplayFinished();
+
 	/** Buttons press time (in frames). */
 	extern std::array<int, BUTTON_COUNT> press_time;
 
@@ -52,9 +52,12 @@ namespace Input {
 		DEBUG_MENU,
 		DEBUG_THROUGH,
 		DEBUG_SAVE,
+		QUICK_SAVE,
+		QUICK_LOAD,
 		TOGGLE_FPS,
 		TAKE_SCREENSHOT,
 		SHOW_LOG,
+		TOGGLE_PROFILER,
 		PAGE_UP,
 		PAGE_DOWN,
 		BUTTON_COUNT
@@ -74,9 +74,12 @@ void Input::InitButtons() {
 	buttons[DEBUG_THROUGH].push_back(Keys::LCTRL);
 	buttons[DEBUG_THROUGH].push_back(Keys::RCTRL);
 	buttons[DEBUG_SAVE].push_back(Keys::F11);
+	buttons[QUICK_SAVE].push_back(Keys::F6);
+	buttons[QUICK_LOAD].push_back(Keys::F7);
 	buttons[TAKE_SCREENSHOT].push_back(Keys::F10);
 	buttons[TOGGLE_FPS].push_back(Keys::F2);
 	buttons[SHOW_LOG].push_back(Keys::F3);
+	buttons[TOGGLE_PROFILER].push_back(Keys::F8);
 	buttons[PAGE_UP].push_back(Keys::PGUP);
 	buttons[PAGE_DOWN].push_back(Keys::PGDN);
 
@@ -27,6 +27,10 @@
 
 extern "C" int main(int argc, char* argv[]) {
 	Player::Init(argc, argv);
+	if (!Player::archive_file.empty()) {
+		return Player::CreateArchive() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	Graphics::Init();
 	Input::Init();
 
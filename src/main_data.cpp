@@ -61,6 +61,7 @@ Game_Switches_Class Game_Switches;
 
 std::string project_path;
 std::string save_path;
+std::string cache_path;
 
 namespace Main_Data {
 	// Dynamic Game Data
@@ -196,3 +197,11 @@ const std::string& Main_Data::GetSavePath() {
 void Main_Data::SetSavePath(const std::string& path) {
 	save_path = path;
 }
+
+const std::string& Main_Data::GetCachePath() {
+	return cache_path;
+}
+
+void Main_Data::SetCachePath(const std::string& path) {
+	cache_path = path;
+}
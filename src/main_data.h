@@ -48,6 +48,13 @@ namespace Main_Data {
 	
 	const std::string& GetSavePath();
 	void SetSavePath(const std::string& path);
+
+	/**
+	 * Directory for cache files (e.g. rendered MIDI music).
+	 * Caching is disabled when empty.
+	 */
+	const std::string& GetCachePath();
+	void SetCachePath(const std::string& path);
 }
 
 #endif
@@ -0,0 +1,130 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <list>
+#include <unordered_map>
+#include "filefinder.h"
+#include "lmu_reader.h"
+#include "map_cache.h"
+#include "output.h"
+#include "player.h"
+#include "utils.h"
+
+namespace {
+	struct CacheEntry {
+		std::string filename;
+		std::shared_ptr<const RPG::Map> map;
+		int64_t mtime;
+		Offset file_size;
+		size_t memory;
+	};
+
+	/** Most recently used map first */
+	typedef std::list<CacheEntry> cache_list;
+
+	cache_list entries;
+	std::unordered_map<std::string, cache_list::iterator> lookup;
+
+	const size_t cache_limit = 4 * 1024 * 1024;
+	size_t cache_size = 0;
+
+	template <typename T>
+	size_t VectorSize(const std::vector<T>& v) {
+		return v.capacity() * sizeof(T);
+	}
+
+	/** Estimates the heap memory used by a parsed map */
+	size_t EstimateMemory(const RPG::Map& map) {
+		size_t size = sizeof(RPG::Map) + VectorSize(map.lower_layer) + VectorSize(map.upper_layer) +
+			VectorSize(map.events);
+
+		for (const RPG::Event& ev : map.events) {
+			size += ev.name.capacity() + VectorSize(ev.pages);
+			for (const RPG::EventPage& page : ev.pages) {
+				size += VectorSize(page.event_commands) + VectorSize(page.move_route.move_commands);
+				for (const RPG::EventCommand& cmd : page.event_commands) {
+					size += cmd.string.capacity() + VectorSize(cmd.parameters);
+				}
+			}
+		}
+
+		return size;
+	}
+
+	void Drop(cache_list::iterator it) {
+		cache_size -= it->memory;
+		lookup.erase(it->filename);
+		entries.erase(it);
+	}
+
+	void FreeCacheMemory() {
+		// Keep at least the map that was loaded last
+		while (cache_size > cache_limit && entries.size() > 1) {
+			Drop(std::prev(entries.end()));
+		}
+	}
+}
+
+std::shared_ptr<const RPG::Map> MapCache::Load(const std::string& map_file) {
+	int64_t mtime = FileFinder::GetModificationTime(map_file);
+	Offset file_size = FileFinder::GetFileSize(map_file);
+
+	auto it = lookup.find(map_file);
+	if (it != lookup.end()) {
+		cache_list::iterator entry = it->second;
+		if (entry->mtime == mtime && entry->file_size == file_size) {
+			entries.splice(entries.begin(), entries, entry);
+			return entry->map;
+		}
+
+		Output::Debug("Map %s was modified", map_file.c_str());
+		Drop(entry);
+	}
+
+	std::shared_ptr<const RPG::Map> map;
+	if (Utils::EndsWith(Utils::LowerCase(map_file), ".emu")) {
+		map = LMU_Reader::LoadXml(FileFinder::MakeLocal(map_file));
+	} else {
+		map = LMU_Reader::Load(FileFinder::MakeLocal(map_file), Player::encoding);
+	}
+
+	if (!map) {
+		return map;
+	}
+
+	CacheEntry entry;
+	entry.filename = map_file;
+	entry.map = map;
+	entry.mtime = mtime;
+	entry.file_size = file_size;
+	entry.memory = EstimateMemory(*map);
+
+	entries.push_front(entry);
+	lookup[map_file] = entries.begin();
+	cache_size += entry.memory;
+
+	FreeCacheMemory();
+
+	return map;
+}
+
+void MapCache::Clear() {
+	entries.clear();
+	lookup.clear();
+	cache_size = 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_MAP_CACHE_H
+#define EASYRPG_MAP_CACHE_H
+
+// Headers
+#include <memory>
+#include <string>
+#include "rpg_map.h"
+
+/**
+ * MapCache keeps recently used maps in memory so going back and forth
+ * between maps doesn't parse the map file again.
+ * The least recently used maps are dropped when the maps exceed the memory
+ * limit (4 MB by default). A cached map is only used while its file was not
+ * modified.
+ */
+namespace MapCache {
+	/**
+	 * Loads a map file (lmu or emu) or returns the cached map.
+	 *
+	 * @param map_file path to the map file as returned by the FileFinder
+	 * @return parsed map or null on error (see LcfReader::GetError)
+	 */
+	std::shared_ptr<const RPG::Map> Load(const std::string& map_file);
+
+	/**
+	 * Drops all cached maps.
+	 */
+	void Clear();
+}
+
+#endif
@@ -0,0 +1,292 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32) && !defined(__WINRT__)
+#  define WIN32_LEAN_AND_MEAN
+#  include <Windows.h>
+#  include <psapi.h>
+#elif defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__)
+#  include <sys/resource.h>
+#  define HAVE_GETRUSAGE
+#endif
+
+#include "memory_stats.h"
+#include "output.h"
+#include "system.h"
+
+namespace {
+#ifdef COUNT_ALLOCATIONS
+	std::atomic<uint64_t> allocation_count(0);
+	std::atomic<uint64_t> allocated_bytes(0);
+#endif
+
+	struct CategoryStats {
+		std::atomic<int64_t> live_bytes;
+		std::atomic<int64_t> peak_bytes;
+		std::atomic<uint64_t> allocations;
+		std::atomic<uint64_t> allocated_bytes;
+	};
+
+	CategoryStats categories[MemoryStats::Category_Count];
+
+	const char* const category_names[MemoryStats::Category_Count] = {
+		"cache",
+		"sprite",
+		"tilemap",
+		"se",
+		"text",
+		"bitmap"
+	};
+
+	/** Rates are averaged over this many frames */
+	const int rate_frames = 60;
+	int rate_frame = 0;
+
+	/** Index Category_Count is the global heap */
+	uint64_t rate_start_allocations[MemoryStats::Category_Count + 1];
+	uint64_t rate_start_bytes[MemoryStats::Category_Count + 1];
+	double allocation_rate[MemoryStats::Category_Count + 1];
+	double byte_rate[MemoryStats::Category_Count + 1];
+
+	double ToKiB(int64_t bytes) {
+		return bytes / 1024.0;
+	}
+
+	double ToMiB(int64_t bytes) {
+		return bytes / (1024.0 * 1024.0);
+	}
+
+	/** Adds to the live bytes of a category and raises its peak */
+	void AddLive(CategoryStats& c, int64_t bytes) {
+		int64_t live = c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+		int64_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+		while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+	}
+
+#ifdef COUNT_ALLOCATIONS
+	void* Allocate(std::size_t size) {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+		return std::malloc(size == 0 ? 1 : size);
+	}
+#endif
+}
+
+#ifdef COUNT_ALLOCATIONS
+// Replaces the global allocator of the whole program, only built on request
+void* operator new(std::size_t size) {
+	void* ptr = Allocate(size);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+	std::free(ptr);
+}
+#endif
+
+void MemoryStats::Add(Category category, int64_t bytes) {
+	CategoryStats& c = categories[category];
+	c.allocations.fetch_add(1, std::memory_order_relaxed);
+	c.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	AddLive(c, bytes);
+}
+
+void MemoryStats::Remove(Category category, int64_t bytes) {
+	categories[category].live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryStats::Move(Category from, Category to, int64_t bytes, bool allocation) {
+	CategoryStats& f = categories[from];
+	CategoryStats& t = categories[to];
+
+	// The counters are running totals, Update ignores a window in which
+	// they went down
+	if (allocation) {
+		f.allocations.fetch_sub(1, std::memory_order_relaxed);
+		f.allocated_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+		t.allocations.fetch_add(1, std::memory_order_relaxed);
+		t.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+	f.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+	AddLive(t, bytes);
+}
+
+void MemoryStats::Update() {
+	if (++rate_frame < rate_frames) {
+		return;
+	}
+	rate_frame = 0;
+
+	for (int i = 0; i <= Category_Count; ++i) {
+		uint64_t allocations = i < Category_Count ?
+			categories[i].allocations.load(std::memory_order_relaxed) : GetAllocationCount();
+		uint64_t bytes = i < Category_Count ?
+			categories[i].allocated_bytes.load(std::memory_order_relaxed) : GetAllocatedBytes();
+
+		// A moved allocation can lower the totals of the previous owner
+		allocation_rate[i] = allocations > rate_start_allocations[i] ?
+			static_cast<double>(allocations - rate_start_allocations[i]) / rate_frames : 0.0;
+		byte_rate[i] = bytes > rate_start_bytes[i] ?
+			static_cast<double>(bytes - rate_start_bytes[i]) / rate_frames : 0.0;
+		rate_start_allocations[i] = allocations;
+		rate_start_bytes[i] = bytes;
+	}
+}
+
+std::vector<std::string> MemoryStats::GetSummary() {
+	std::vector<std::string> lines;
+	char line[64];
+
+	int64_t total = 0;
+	snprintf(line, sizeof(line), "%-7s %8s %7s", "KiB", "live", "alloc/f");
+	lines.push_back(line);
+	for (int i = 0; i < Category_Count; ++i) {
+		int64_t live = categories[i].live_bytes.load(std::memory_order_relaxed);
+		total += live;
+		snprintf(line, sizeof(line), "%-7s %8.1f %7.2f", category_names[i],
+			ToKiB(live), allocation_rate[i]);
+		lines.push_back(line);
+	}
+	snprintf(line, sizeof(line), "%-7s %8.1f", "total", ToKiB(total));
+	lines.push_back(line);
+
+	if (IsCountingAllocations()) {
+		snprintf(line, sizeof(line), "Heap: %.1f alloc/f", allocation_rate[Category_Count]);
+		lines.push_back(line);
+	}
+
+	int64_t peak_rss = GetPeakResidentSize();
+	if (peak_rss >= 0) {
+		snprintf(line, sizeof(line), "Peak RSS: %.1f MiB", ToMiB(peak_rss));
+		lines.push_back(line);
+	}
+
+	return lines;
+}
+
+void MemoryStats::Dump() {
+	Output::Debug("Memory statistics (sizes in KiB, rates per frame):");
+	for (int i = 0; i < Category_Count; ++i) {
+		const CategoryStats& c = categories[i];
+		Output::Debug("%s: live %.1f, peak %.1f, total %u allocations / %.1f, per frame %.2f / %.1f",
+			category_names[i],
+			ToKiB(c.live_bytes.load(std::memory_order_relaxed)),
+			ToKiB(c.peak_bytes.load(std::memory_order_relaxed)),
+			(unsigned)c.allocations.load(std::memory_order_relaxed),
+			ToKiB(c.allocated_bytes.load(std::memory_order_relaxed)),
+			allocation_rate[i], ToKiB(byte_rate[i]));
+	}
+
+	if (IsCountingAllocations()) {
+		Output::Debug("heap: total %llu allocations / %.1f MiB, per frame %.2f / %.1f",
+			(unsigned long long)GetAllocationCount(), ToMiB(GetAllocatedBytes()),
+			allocation_rate[Category_Count], ToKiB(byte_rate[Category_Count]));
+	}
+
+	int64_t peak_rss = GetPeakResidentSize();
+	if (peak_rss >= 0) {
+		Output::Debug("Peak RSS: %.1f MiB", ToMiB(peak_rss));
+	}
+}
+
+bool MemoryStats::IsCountingAllocations() {
+#ifdef COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64_t MemoryStats::GetAllocationCount() {
+#ifdef COUNT_ALLOCATIONS
+	return allocation_count.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+uint64_t MemoryStats::GetAllocatedBytes() {
+#ifdef COUNT_ALLOCATIONS
+	return allocated_bytes.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+int64_t MemoryStats::GetPeakResidentSize() {
+#if defined(_WIN32) && !defined(__WINRT__)
+	// Loaded at runtime, linking psapi differs between toolchains
+	typedef BOOL (WINAPI *GetProcessMemoryInfoFunc)(HANDLE, PPROCESS_MEMORY_COUNTERS, DWORD);
+	static HMODULE psapi = LoadLibrary(L"psapi.dll");
+	static GetProcessMemoryInfoFunc get_memory_info = psapi ?
+		(GetProcessMemoryInfoFunc) GetProcAddress(psapi, "GetProcessMemoryInfo") : nullptr;
+
+	PROCESS_MEMORY_COUNTERS counters;
+	if (get_memory_info && get_memory_info(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return static_cast<int64_t>(counters.PeakWorkingSetSize);
+	}
+	return -1;
+#elif defined(HAVE_GETRUSAGE)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+#  ifdef __APPLE__
+	// Bytes on macOS, kilobytes everywhere else
+	return static_cast<int64_t>(usage.ru_maxrss);
+#  else
+	return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#  endif
+#else
+	return -1;
+#endif
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_MEMORY_STATS_H
+#define EASYRPG_MEMORY_STATS_H
+
+// Headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * MemoryStats namespace.
+ * Counts the allocations done through the global operator new (only when
+ * built with COUNT_ALLOCATIONS) and queries the memory usage of the
+ * process.
+ * Large buffers (bitmap pixels, decoded sound effects) are additionally
+ * accounted per subsystem to find out who holds the memory.
+ * All functions are lock-free and can be called from worker threads.
+ */
+namespace MemoryStats {
+	/** Subsystems the buffers are accounted to */
+	enum Category {
+		/** Materials loaded through Cache */
+		Category_Cache,
+		/** Effect bitmaps of sprites (tone, flash, flip) */
+		Category_SpriteEffects,
+		/** Autotiles and effect bitmaps of tilemaps */
+		Category_Tilemap,
+		/** Decoded samples in the sound effect cache */
+		Category_AudioSe,
+		/** Glyphs and text surfaces */
+		Category_Text,
+		/** Bitmaps not assigned to a subsystem */
+		Category_Bitmap,
+		Category_Count
+	};
+
+	/**
+	 * Accounts an allocated buffer.
+	 *
+	 * @param category owning subsystem
+	 * @param bytes size of the buffer
+	 */
+	void Add(Category category, int64_t bytes);
+
+	/**
+	 * Accounts a freed buffer.
+	 *
+	 * @param category owning subsystem
+	 * @param bytes size of the buffer
+	 */
+	void Remove(Category category, int64_t bytes);
+
+	/**
+	 * Transfers an accounted buffer to another subsystem.
+	 * By default only the live bytes move and the allocation stays counted
+	 * for the previous owner.
+	 * A buffer that is handed over right after it was allocated should
+	 * move its allocation as well, otherwise the new owner never shows
+	 * any allocations.
+	 *
+	 * @param from previous owner
+	 * @param to new owner
+	 * @param bytes size of the buffer
+	 * @param allocation whether the allocation is moved too
+	 */
+	void Move(Category from, Category to, int64_t bytes, bool allocation = false);
+
+	/**
+	 * Updates the allocation rates, called once per frame.
+	 */
+	void Update();
+
+	/**
+	 * Returns a short summary suitable for the debug scene:
+	 * The live KiB and allocations per frame of every subsystem.
+	 *
+	 * @return summary lines
+	 */
+	std::vector<std::string> GetSummary();
+
+	/**
+	 * Writes all collected statistics to the log.
+	 */
+	void Dump();
+
+	/**
+	 * Gets if the global operator new is replaced by a counting one.
+	 * Enabled with the COUNT_ALLOCATIONS define.
+	 *
+	 * @return whether GetAllocationCount and GetAllocatedBytes are available.
+	 */
+	bool IsCountingAllocations();
+
+	/**
+	 * Gets the number of allocations since program start.
+	 *
+	 * @return number of operator new calls or 0 when not counting.
+	 */
+	uint64_t GetAllocationCount();
+
+	/**
+	 * Gets the number of bytes allocated since program start.
+	 * Freed memory is not subtracted.
+	 *
+	 * @return allocated bytes or 0 when not counting.
+	 */
+	uint64_t GetAllocatedBytes();
+
+	/**
+	 * Gets the peak resident set size of the process.
+	 *
+	 * @return peak RSS in bytes or -1 when not supported by the platform.
+	 */
+	int64_t GetPeakResidentSize();
+}
+
+#endif
@@ -453,11 +453,14 @@ namespace midisynth{
     int synthesizer::synthesize(int_least16_t* output, std::size_t samples, float rate)
     {
         std::size_t n = samples * 2;
-        std::vector<int_least32_t> buf(n);
-        int num_notes = synthesize_mixing(&buf[0], samples, rate);
+        if(mix_buffer.size() < n){
+            mix_buffer.resize(n);
+        }
+        std::fill(mix_buffer.begin(), mix_buffer.begin() + n, 0);
+        int num_notes = synthesize_mixing(&mix_buffer[0], samples, rate);
         if(num_notes){
             for(std::size_t i = 0; i < n; ++i){
-                int_least32_t x = buf[i];
+                int_least32_t x = mix_buffer[i];
                 if(x < -32767){
                     output[i] = -32767;
                 }else if(x > 32767){
@@ -665,31 +668,30 @@ namespace midisynth{
     {
         set_cycle(cycle);
     }
-    // changes the period of the sine wave.
-    void sine_wave_generator::set_cycle(float cycle)
-    {
-        if(cycle){
-            step = static_cast<uint_least32_t>(sine_table::DIVISION * 32768.0 / cycle);
-        }else{
-            step = 0;
+    // Converts the period of a sine wave to the phase step per sample.
+    namespace{
+        inline uint_least32_t cycle_to_step(float cycle)
+        {
+            if(cycle){
+                return static_cast<uint_least32_t>(sine_table::DIVISION * 32768.0 / cycle);
+            }
+            return 0;
         }
     }
-    // Adds modulation.
-    void sine_wave_generator::add_modulation(int_least32_t x)
+    // changes the period of the sine wave.
+    void sine_wave_generator::set_cycle(float cycle)
     {
-        position += static_cast<int_least32_t>(static_cast<int_least64_t>(step) * x >> 16);
+        step = cycle_to_step(cycle);
     }
     // Gets the next sample.
     inline int sine_wave_generator::get_next()
     {
         return sine_table.get((position += step) / 32768 % sine_table::DIVISION);
     }
-    // Gets the next sample (with frequency modulation).
-    inline int sine_wave_generator::get_next(int_least32_t modulation)
+    // Advances by a whole block and gets the last sample of it.
+    inline int sine_wave_generator::get_next_after(std::size_t samples)
     {
-        uint_least32_t m = modulation * sine_table::DIVISION / 65536;
-        uint_least32_t p = ((position += step) / 32768 + m) % sine_table::DIVISION;
-        return sine_table.get(p);
+        return sine_table.get((position += step * static_cast<uint_least32_t>(samples)) / 32768 % sine_table::DIVISION);
     }
 
     // Logarithmic conversion table. Use in the subsequent decay of the envelope generator.
@@ -867,69 +869,77 @@ namespace midisynth{
     // In fact it gets muted when lesser than 1 as it is rounded to an integer actually.
     // A higher value may sound not natural but improves performance
     #define SOUNDOFF_LEVEL 1024
-    // Gets the next sample.
-    int envelope_generator::get_next()
+    // Advances the envelope by a block of samples and gets the level reached.
+    int envelope_generator::get_next(std::size_t samples)
     {
         uint_least32_t current = this->current;
+        uint_least32_t n = static_cast<uint_least32_t>(samples);
+        uint_least32_t d;
         switch(state){
         case ATTACK:
             if(current < fTL){
-                return this->current = current + fAR;
+                this->current = current += fAR * n;
+                return std::min(current, fTL);
             }
             this->current = static_cast<uint_least32_t>(65536 * LOGTABLE_FACTOR * std::log10(static_cast<double>(fTL)));
             state = DECAY;
             return fTL;
         case DECAY:
             if(current > fSS){
-                this->current = current -= fDR;
+                d = fDR * n;
+                this->current = current = (current - fSL > d) ? current - d : fSL;
                 return log_table.get(current / 65536);
             }
             this->current = current = fSL;
             state = SASTAIN;
             return log_table.get(current / 65536);
         case SASTAIN:
-            if(current > fSR){
-                this->current = current -= fSR;
-                int n = log_table.get(current / 65536);
-                if(n > 1){
-                    return n;
+            d = fSR * n;
+            if(current > d){
+                this->current = current -= d;
+                int level = log_table.get(current / 65536);
+                if(level > 1){
+                    return level;
                 }
             }
             state = FINISHED;
             return 0;
         case ATTACK_RELEASE:
             if(current < fTL){
-                return this->current = current + fAR;
+                this->current = current += fAR * n;
+                return std::min(current, fTL);
             }
             this->current = static_cast<uint_least32_t>(65536 * LOGTABLE_FACTOR * std::log10(static_cast<double>(fTL)));
             state = DECAY_RELEASE;
             return fTL;
         case DECAY_RELEASE:
             if(current > fDSS){
-                this->current = current -= fDRR;
+                d = fDRR * n;
+                this->current = current = (current - fSL > d) ? current - d : fSL;
                 return log_table.get(current / 65536);
             }
             this->current = current = fSL;
             state = RELEASE;
             return log_table.get(current / 65536);
         case RELEASE:
-            if(current > fRR){
-                this->current = current -= fRR;
-                int n = log_table.get(current / 65536);
-                if(n > SOUNDOFF_LEVEL){
-                    return n;
+            d = fRR * n;
+            if(current > d){
+                this->current = current -= d;
+                int level = log_table.get(current / 65536);
+                if(level <= SOUNDOFF_LEVEL){
+                    state = SOUNDOFF;
                 }
-                state = SOUNDOFF;
-                return n;
+                return level;
             }
             state = FINISHED;
             return 0;
         case SOUNDOFF:
-            if(current > fOR){
-                this->current = current -= fOR;
-                int n = log_table.get(current / 65536);
-                if(n > 1){
-                    return n;
+            d = fOR * n;
+            if(current > d){
+                this->current = current -= d;
+                int level = log_table.get(current / 65536);
+                if(level > 1){
+                    return level;
                 }
             }
             state = FINISHED;
@@ -1079,26 +1089,33 @@ namespace midisynth{
         ams_factor = ams_table[AMS_] / 2;
         ams_bias = 32768 - ams_factor * 256;
     }
-    // Sets playback frequency rate.
-    void fm_operator::set_freq_rate(float freq, float rate)
+    // Sets playback frequency rate. Returns the phase step of the oscillator.
+    uint_least32_t fm_operator::set_freq_rate(float freq, float rate)
     {
         freq += DT;
         freq *= ML;
-        swg.set_cycle(rate / freq);
         eg.set_rate(rate);
+        return cycle_to_step(rate / freq);
     }
-    // Gets the next sample.
-    inline int fm_operator::get_next()
+    // Gets the envelope level for the next block.
+    inline int fm_operator::get_level(std::size_t samples)
     {
-        return static_cast<int_least32_t>(swg.get_next()) * eg.get_next() >> 15;
+        return eg.get_next(samples);
     }
-    inline int fm_operator::get_next(int modulate)
+    inline int fm_operator::get_level(std::size_t samples, int ams)
     {
-        return static_cast<int_least32_t>(swg.get_next(modulate)) * eg.get_next() >> 15;
+        return eg.get_next(samples) * (ams * ams_factor + ams_bias) >> 15;
     }
-    inline int fm_operator::get_next(int ams, int modulate)
-    {
-        return (static_cast<int_least32_t>(swg.get_next(modulate)) * eg.get_next() >> 15) * (ams * ams_factor + ams_bias) >> 15;
+
+    // Operator output. Advances the phase by one sample and applies the
+    // envelope level of the current block.
+    namespace{
+        inline int operator_output(uint_least32_t& position, uint_least32_t step, int_least32_t level, int_least32_t modulation)
+        {
+            uint_least32_t m = modulation * sine_table::DIVISION / 65536;
+            uint_least32_t p = ((position += step) / 32768 + m) % sine_table::DIVISION;
+            return static_cast<int_least32_t>(sine_table.get(p)) * level >> 15;
+        }
     }
 
     // Vibrato table.
@@ -1139,6 +1156,11 @@ namespace midisynth{
         damper(0),
         sostenute(0)
     {
+        for(int i = 0; i < 4; ++i){
+            position[i] = 0;
+            step[i] = 0;
+            level[i] = 0;
+        }
         assert(ALG >= 0 && ALG <= 7);
         assert(params.LFO >= 0 && params.LFO <= 7);
         assert(params.FB >= 0 && params.FB <= 7);
@@ -1162,22 +1184,23 @@ namespace midisynth{
             ams_lfo.set_cycle(rate / ams_freq);
             vibrato_lfo.set_cycle(rate / vibrato_freq);
             tremolo_lfo.set_cycle(rate / tremolo_freq);
-            float f = freq * freq_mul;
-            op1.set_freq_rate(f, rate);
-            op2.set_freq_rate(f, rate);
-            op3.set_freq_rate(f, rate);
-            op4.set_freq_rate(f, rate);
+            update_freq_rate();
         }
     }
     // Sets frequency multiplier.
     void fm_sound_generator::set_frequency_multiplier(float value)
     {
         freq_mul = value;
+        update_freq_rate();
+    }
+    // Recalculates the phase steps of the operators.
+    void fm_sound_generator::update_freq_rate()
+    {
         float f = freq * freq_mul;
-        op1.set_freq_rate(f, rate);
-        op2.set_freq_rate(f, rate);
-        op3.set_freq_rate(f, rate);
-        op4.set_freq_rate(f, rate);
+        step[0] = op1.set_freq_rate(f, rate);
+        step[1] = op2.set_freq_rate(f, rate);
+        step[2] = op3.set_freq_rate(f, rate);
+        step[3] = op4.set_freq_rate(f, rate);
     }
     // Sets damper effect.
     void fm_sound_generator::set_damper(int damper)
@@ -1259,88 +1282,103 @@ namespace midisynth{
             return true;
         }
     }
-    // Gets the next sample.
-    int fm_sound_generator::get_next()
+    // Renders a block with the envelope levels and phase steps of the block.
+    // The algorithm is a template parameter, so the connection of the
+    // operators is resolved outside of the per sample loop.
+    template<int ALGORITHM>
+    void fm_sound_generator::render(int_least32_t* out, std::size_t samples, const uint_least32_t* delta)
     {
-        if(vibrato_depth){
-            int x = static_cast<int_least32_t>(vibrato_lfo.get_next()) * vibrato_depth >> 15;
-            int_least32_t modulation = vibrato_table.get(x);
-            op1.add_modulation(modulation);
-            op2.add_modulation(modulation);
-            op3.add_modulation(modulation);
-            op4.add_modulation(modulation);
-        }
-        int feedback = (this->feedback << 1) >> FB;
-        int ret;
-        if(ams_enable){
-            int ams = ams_lfo.get_next() >> 7;
-            switch(ALG){
+        uint_least32_t* p = position;
+        const int_least32_t* l = level;
+        int fb = this->feedback;
+        for(std::size_t i = 0; i < samples; ++i){
+            int f = (fb << 1) >> FB;
+            int ret;
+            switch(ALGORITHM){
             case 0:
-                ret = op4(ams, op3(ams, op2(ams, this->feedback = op1(ams, feedback))));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], operator_output(p[2], delta[2], l[2], operator_output(p[1], delta[1], l[1], fb)));
                 break;
             case 1:
-                ret = op4(ams, op3(ams, op2(ams, 0) + (this->feedback = op1(ams, feedback))));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], operator_output(p[2], delta[2], l[2], operator_output(p[1], delta[1], l[1], 0) + fb));
                 break;
             case 2:
-                ret = op4(ams, op3(ams, op2(ams, 0)) + (this->feedback = op1(ams, feedback)));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], operator_output(p[2], delta[2], l[2], operator_output(p[1], delta[1], l[1], 0)) + fb);
                 break;
             case 3:
-                ret = op4(ams, op3(ams, 0) + op2(ams, this->feedback = op1(ams, feedback)));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], operator_output(p[2], delta[2], l[2], 0) + operator_output(p[1], delta[1], l[1], fb));
                 break;
             case 4:
-                ret = op4(ams, op3(ams, 0)) + op2(ams, this->feedback = op1(ams, feedback));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], operator_output(p[2], delta[2], l[2], 0)) + operator_output(p[1], delta[1], l[1], fb);
                 break;
             case 5:
-                this->feedback = feedback = op1(ams, feedback);
-                ret = op4(ams, feedback) + op3(ams, feedback) + op2(ams, feedback);
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], fb) + operator_output(p[2], delta[2], l[2], fb) + operator_output(p[1], delta[1], l[1], fb);
                 break;
             case 6:
-                ret = op4(ams, 0) + op3(ams, 0) + op2(ams, this->feedback = op1(ams, feedback));
-                break;
-            case 7:
-                ret = op4(ams, 0) + op3(ams, 0) + op2(ams, 0) + (this->feedback = op1(ams, feedback));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], 0) + operator_output(p[2], delta[2], l[2], 0) + operator_output(p[1], delta[1], l[1], fb);
                 break;
             default:
-                assert(!"fm_sound_generator: invalid algorithm number");
-                return 0;
-            }
-        }else{
-            switch(ALG){
-            case 0:
-                ret = op4(op3(op2(this->feedback = op1(feedback))));
-                break;
-            case 1:
-                ret = op4(op3(op2() + (this->feedback = op1(feedback))));
+                fb = operator_output(p[0], delta[0], l[0], f);
+                ret = operator_output(p[3], delta[3], l[3], 0) + operator_output(p[2], delta[2], l[2], 0) + operator_output(p[1], delta[1], l[1], 0) + fb;
                 break;
-            case 2:
-                ret = op4(op3(op2()) + (this->feedback = op1(feedback)));
-                break;
-            case 3:
-                ret = op4(op3() + op2(this->feedback = op1(feedback)));
-                break;
-            case 4:
-                ret = op4(op3()) + op2(this->feedback = op1(feedback));
-                break;
-            case 5:
-                this->feedback = feedback = op1(feedback);
-                ret = op4(feedback) + op3(feedback) + op2(feedback);
-                break;
-            case 6:
-                ret = op4() + op3() + op2(this->feedback = op1(feedback));
-                break;
-            case 7:
-                ret = op4() + op3() + op2() + (this->feedback = op1(feedback));
-                break;
-            default:
-                assert(!"fm_sound_generator: invalid algorithm number");
-                return 0;
             }
+            out[i] = ret;
+        }
+        this->feedback = fb;
+    }
+    // Synthesizes a block of at most BLOCK_SIZE mono samples.
+    void fm_sound_generator::synthesize(int_least32_t* out, std::size_t samples)
+    {
+        assert(samples <= BLOCK_SIZE);
+
+        uint_least32_t delta[4] = { step[0], step[1], step[2], step[3] };
+        if(vibrato_depth){
+            int x = static_cast<int_least32_t>(vibrato_lfo.get_next_after(samples)) * vibrato_depth >> 15;
+            int_least32_t modulation = vibrato_table.get(x);
+            for(int i = 0; i < 4; ++i){
+                delta[i] += static_cast<int_least32_t>(static_cast<int_least64_t>(step[i]) * modulation >> 16);
+            }
+        }
+        if(ams_enable){
+            int ams = ams_lfo.get_next_after(samples) >> 7;
+            level[0] = op1.get_level(samples, ams);
+            level[1] = op2.get_level(samples, ams);
+            level[2] = op3.get_level(samples, ams);
+            level[3] = op4.get_level(samples, ams);
+        }else{
+            level[0] = op1.get_level(samples);
+            level[1] = op2.get_level(samples);
+            level[2] = op3.get_level(samples);
+            level[3] = op4.get_level(samples);
+        }
+
+        switch(ALG){
+        case 0: render<0>(out, samples, delta); break;
+        case 1: render<1>(out, samples, delta); break;
+        case 2: render<2>(out, samples, delta); break;
+        case 3: render<3>(out, samples, delta); break;
+        case 4: render<4>(out, samples, delta); break;
+        case 5: render<5>(out, samples, delta); break;
+        case 6: render<6>(out, samples, delta); break;
+        case 7: render<7>(out, samples, delta); break;
+        default:
+            assert(!"fm_sound_generator: invalid algorithm number");
+            std::fill(out, out + samples, 0);
+            return;
         }
+
         if(tremolo_depth){
-            int_least32_t x = 4096 - (((static_cast<int_least32_t>(tremolo_lfo.get_next()) + 32768) * tremolo_depth) >> 11);
-            ret = ret * x >> 12;
+            int_least32_t x = 4096 - (((static_cast<int_least32_t>(tremolo_lfo.get_next_after(samples)) + 32768) * tremolo_depth) >> 11);
+            for(std::size_t i = 0; i < samples; ++i){
+                out[i] = out[i] * x >> 12;
+            }
         }
-        return ret;
     }
 
     // FM notes constructor.
@@ -1358,10 +1396,16 @@ namespace midisynth{
         left = (left * velocity) >> 7;
         right = (right * velocity) >> 7;
         fm.set_rate(rate);
-        for(std::size_t i = 0; i < samples; ++i){
-            int_least32_t sample = fm.get_next();
-            buf[i * 2 + 0] += (sample * left) >> 14;
-            buf[i * 2 + 1] += (sample * right) >> 14;
+        int_least32_t block[fm_sound_generator::BLOCK_SIZE];
+        while(samples && !fm.is_finished()){
+            std::size_t n = std::min<std::size_t>(samples, fm_sound_generator::BLOCK_SIZE);
+            fm.synthesize(block, n);
+            for(std::size_t i = 0; i < n; ++i){
+                buf[i * 2 + 0] += (block[i] * left) >> 14;
+                buf[i * 2 + 1] += (block[i] * right) >> 14;
+            }
+            buf += n * 2;
+            samples -= n;
         }
         return !fm.is_finished();
     }
@@ -249,6 +249,7 @@ namespace midisynth{
         int master_coarse_tuning;
         float master_frequency_multiplier;
         system_mode_t system_mode;
+        std::vector<int_least32_t> mix_buffer;
         void update_master_frequency_multiplier();
     };
 
@@ -259,9 +260,8 @@ namespace midisynth{
         sine_wave_generator();
         sine_wave_generator(float cycle);
         void set_cycle(float cycle);
-        void add_modulation(int_least32_t x);
         int get_next();
-        int get_next(int_least32_t modulation);
+        int get_next_after(std::size_t samples);
     private:
         uint_least32_t position;
         uint_least32_t step;
@@ -269,6 +269,7 @@ namespace midisynth{
 
     // Envelope generator.
     // Generates 0 to 32767 values when the TL = 0.
+    // The envelope is stepped once per block of samples instead of per sample.
     class envelope_generator{
     public:
         envelope_generator(int AR, int DR, int SR, int RR, int SL, int TL);
@@ -278,7 +279,7 @@ namespace midisynth{
         void key_off();
         void sound_off();
         bool is_finished()const{ return state == FINISHED; }
-        int get_next();
+        int get_next(std::size_t samples);
     private:
         enum{ ATTACK, ATTACK_RELEASE, DECAY, DECAY_RELEASE, SASTAIN, RELEASE, SOUNDOFF, FINISHED }state;
         int AR, DR, SR, RR, TL;
@@ -291,24 +292,21 @@ namespace midisynth{
     };
 
     // FM operator (modulator and carrier).
+    // Only holds the envelope and the frequency parameters. The phase of the
+    // oscillator is kept by fm_sound_generator, so the four operators of a
+    // voice can be stepped together.
     class fm_operator{
     public:
         fm_operator(int AR, int DR, int SR, int RR, int SL, int TL, int KS, int ML, int DT, int AMS, int key);
-        void set_freq_rate(float freq, float rate);
+        uint_least32_t set_freq_rate(float freq, float rate);
         void set_hold(float value){ eg.set_hold(value); }
         void set_freeze(float value){ eg.set_freeze(value); }
-        void add_modulation(int_least32_t x){ swg.add_modulation(x); }
         void key_off(){ eg.key_off(); }
         void sound_off(){ eg.sound_off(); }
         bool is_finished()const{ return eg.is_finished(); }
-        int get_next();
-        int get_next(int modulate);
-        int get_next(int lfo, int modulate);
-        inline int operator()(){ return get_next(); }
-        inline int operator()(int m){ return get_next(m); }
-        inline int operator()(int lfo, int m){ return get_next(lfo, m); }
+        int get_level(std::size_t samples);
+        int get_level(std::size_t samples, int ams);
     private:
-        sine_wave_generator swg;
         envelope_generator eg;
         float ML;
         float DT;
@@ -329,8 +327,12 @@ namespace midisynth{
     };
 
     // FM sound generator.
+    // Renders in blocks of up to BLOCK_SIZE samples. Envelopes and LFOs are
+    // evaluated once per block, the per sample loop only advances the phase
+    // accumulators and walks the algorithm.
     class fm_sound_generator{
     public:
+        enum{ BLOCK_SIZE = 16 };
         fm_sound_generator(const FMPARAMETER& params, int note, float frequency_multiplier);
         void set_rate(float rate);
         void set_frequency_multiplier(float value);
@@ -342,12 +344,16 @@ namespace midisynth{
         void key_off();
         void sound_off();
         bool is_finished()const;
-        int get_next();
+        void synthesize(int_least32_t* out, std::size_t samples);
     private:
         fm_operator op1;
         fm_operator op2;
         fm_operator op3;
         fm_operator op4;
+        // Per operator oscillator state (struct of arrays, op1 to op4).
+        uint_least32_t position[4];
+        uint_least32_t step[4];
+        int_least32_t level[4];
         sine_wave_generator ams_lfo;
         sine_wave_generator vibrato_lfo;
         sine_wave_generator tremolo_lfo;
@@ -365,6 +371,8 @@ namespace midisynth{
         int feedback;
         int damper;
         int sostenute;
+        void update_freq_rate();
+        template<int ALGORITHM> void render(int_least32_t* out, std::size_t samples, const uint_least32_t* delta);
     };
 
     // FM sound generator notes.
@@ -34,6 +34,10 @@
 #  include <emscripten.h>
 #endif
 
+#ifdef USE_SDL
+#  include <SDL.h>
+#endif
+
 #include "filefinder.h"
 #include "input.h"
 #include "options.h"
@@ -91,6 +95,14 @@ namespace {
 
 	std::vector<std::string> log_buffer;
 
+	/** Messages for the overlay logged by worker threads */
+	std::vector<std::pair<std::string, Color>> worker_messages;
+
+#ifdef USE_SDL
+	SDL_mutex* log_mutex = nullptr;
+	unsigned long main_thread_id;
+#endif
+
 #ifdef GEKKO
 	/* USBGecko Debugging on Wii */
 	bool usbgecko = false;
@@ -124,6 +136,17 @@ void Output::IgnorePause(bool const val) {
 }
 
 static void WriteLog(std::string const& type, std::string const& msg, Color const& c = Color()) {
+	bool main_thread = true;
+#ifdef USE_SDL
+	if (!log_mutex) {
+		// The first message is logged by Player::Init before any worker thread exists
+		log_mutex = SDL_CreateMutex();
+		main_thread_id = SDL_ThreadID();
+	}
+	main_thread = SDL_ThreadID() == main_thread_id;
+	SDL_LockMutex(log_mutex);
+#endif
+
 // Skip logging to file in the browser
 #ifndef EMSCRIPTEN
 	if (!Main_Data::GetSavePath().empty()) {
@@ -148,10 +171,17 @@ static void WriteLog(std::string const& type, std::string const& msg, Color cons
 #endif
 
 	if (type != "Debug") {
-		if (DisplayUi) {
+		if (!main_thread) {
+			// The overlay is only drawn by the main thread, see Output::Update
+			worker_messages.push_back(std::make_pair(msg, c));
+		} else if (DisplayUi) {
 			message_overlay().AddMessage(msg, c);
 		}
 	}
+
+#ifdef USE_SDL
+	SDL_UnlockMutex(log_mutex);
+#endif
 }
 
 static void HandleErrorOutput(const std::string& err) {
@@ -187,6 +217,28 @@ static void HandleErrorOutput(const std::string& err) {
 	}
 }
 
+void Output::Update() {
+	if (!DisplayUi) {
+		return;
+	}
+
+	std::vector<std::pair<std::string, Color>> messages;
+#ifdef USE_SDL
+	if (!log_mutex) {
+		return;
+	}
+	SDL_LockMutex(log_mutex);
+	messages.swap(worker_messages);
+	SDL_UnlockMutex(log_mutex);
+#else
+	messages.swap(worker_messages);
+#endif
+
+	for (auto& message : messages) {
+		message_overlay().AddMessage(message.first, message.second);
+	}
+}
+
 void Output::Quit() {
 	if (LOG_FILE.is_open()) {
 		LOG_FILE.close();
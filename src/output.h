@@ -24,8 +24,16 @@
 
 /**
  * Output Namespace.
+ * Debug, Warning and Post may be called from worker threads (see
+ * WorkerPool), Error and the other functions only from the main thread.
  */
 namespace Output {
+	/**
+	 * Shows the messages logged by worker threads in the message overlay.
+	 * Called once per frame by the main loop.
+	 */
+	void Update();
+
 	/**
 	 * Closes the log file handle and trims the file.
 	 */
@@ -38,24 +38,36 @@ Plane::~Plane() {
 void Plane::Draw() {
 	if (!visible || !bitmap) return;
 
-	if (needs_refresh) {
-		needs_refresh = false;
+	BitmapRef dst = DisplayUi->GetDisplaySurface();
+	Rect dst_rect(0, 0, DisplayUi->GetWidth(), DisplayUi->GetHeight());
 
-		if (!tone_bitmap ||
-			bitmap->GetWidth() != tone_bitmap->GetWidth() ||
-			bitmap->GetHeight() != tone_bitmap->GetHeight()) {
-			tone_bitmap = Bitmap::Create(bitmap->GetWidth(), bitmap->GetHeight());
-		}
-		tone_bitmap->Clear();
-		tone_bitmap->ToneBlit(0, 0, *bitmap, bitmap->GetRect(), tone_effect, Opacity::opaque);
+	if (tone_effect == Tone()) {
+		dst->TiledBlit(-ox, -oy, bitmap->GetRect(), *bitmap, dst_rect, 255);
+		return;
+	}
+
+	// Only the visible part of the panorama is toned and reused until
+	// the offset or the tone changes
+	if (!strip ||
+		strip->GetWidth() != dst_rect.width ||
+		strip->GetHeight() != dst_rect.height ||
+		strip->GetTransparent() != bitmap->GetTransparent()) {
+		strip = Bitmap::Create(dst_rect.width, dst_rect.height, bitmap->GetTransparent());
+		needs_refresh = true;
 	}
 
-	BitmapRef source = tone_effect == Tone() ? bitmap : tone_bitmap;
+	if (needs_refresh || strip_ox != ox || strip_oy != oy) {
+		needs_refresh = false;
+		strip_ox = ox;
+		strip_oy = oy;
 
-	BitmapRef dst = DisplayUi->GetDisplaySurface();
-	Rect dst_rect(0, 0, DisplayUi->GetWidth(), DisplayUi->GetHeight());
+		if (bitmap->GetTransparent()) {
+			strip->Clear();
+		}
+		strip->ToneTiledBlit(-ox, -oy, bitmap->GetRect(), *bitmap, strip->GetRect(), tone_effect, Opacity::opaque);
+	}
 
-	dst->TiledBlit(-ox, -oy, source->GetRect(), *source, dst_rect, 255);
+	dst->Blit(0, 0, *strip, strip->GetRect(), 255);
 }
 
 BitmapRef const& Plane::GetBitmap() const {
@@ -77,7 +89,7 @@ int Plane::GetZ() const {
 	return z;
 }
 void Plane::SetZ(int nz) {
-	if (z != nz) Graphics::UpdateZCallback();
+	if (z != nz) Graphics::UpdateZCallback(this);
 	z = nz;
 }
 int Plane::GetOx() const {
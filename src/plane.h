@@ -53,7 +53,10 @@ private:
 	DrawableType type;
 
 	BitmapRef bitmap;
-	BitmapRef tone_bitmap;
+	/** Toned screen area of the last frame, only used when a tone is set */
+	BitmapRef strip;
+	int strip_ox = 0;
+	int strip_oy = 0;
 
 	Tone tone_effect;
 
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <ctime>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -45,8 +46,12 @@
 
 #include "async_handler.h"
 #include "audio.h"
+#include "benchmark.h"
 #include "cache.h"
 #include "filefinder.h"
+#include "frame_pacer.h"
+#include "game_archive.h"
+#include "game_loader.h"
 #include "game_actors.h"
 #include "game_map.h"
 #include "game_message.h"
@@ -58,14 +63,15 @@
 #include "game_temp.h"
 #include "game_variables.h"
 #include "graphics.h"
-#include "inireader.h"
 #include "input.h"
-#include "ldb_reader.h"
-#include "lmt_reader.h"
 #include "lsd_reader.h"
 #include "main_data.h"
+#include "memory_stats.h"
 #include "output.h"
 #include "player.h"
+#include "profiler.h"
+#include "save_cache.h"
+#include "worker_pool.h"
 #include "reader_lcf.h"
 #include "reader_util.h"
 #include "scene_battle.h"
@@ -80,6 +86,10 @@ namespace Player {
 	bool hide_title_flag;
 	bool window_flag;
 	bool fps_flag;
+	bool vsync_flag;
+	int max_frameskip;
+	int max_catchup;
+	bool benchmark_flag;
 	bool battle_test_flag;
 	int battle_test_troop_id;
 	bool new_game_flag;
@@ -94,6 +104,7 @@ namespace Player {
 	std::string escape_symbol;
 	int engine;
 	std::string game_title;
+	std::string archive_file;
 	int frames;
 #ifdef EMSCRIPTEN
 	std::string emscripten_game_name;
@@ -105,12 +116,19 @@ namespace Player {
 }
 
 namespace {
-	double start_time;
-	double next_frame;
+	FramePacer frame_pacer;
 
 	// Overwritten by --encoding
 	std::string forced_encoding;
 
+	// Input logs of --record-input and --replay-input
+	std::string record_input_file;
+	std::string replay_input_file;
+
+	// Set by --seed
+	bool seed_set = false;
+	int32_t seed;
+
 	FileRequestBinding system_request_id;
 	FileRequestBinding save_request_id;
 	FileRequestBinding map_request_id;
@@ -195,6 +213,11 @@ void Player::Init(int argc, char *argv[]) {
 
 	ParseCommandLine(argc, argv);
 
+	// Packing a game doesn't need a window, see CreateArchive
+	if (!archive_file.empty()) {
+		return;
+	}
+
 #ifdef EMSCRIPTEN
 	Output::IgnorePause(true);
 
@@ -235,6 +258,36 @@ void Player::Run() {
 
 	reset_flag = false;
 
+	// available us per frame, game logic expects 60 fps
+	frame_pacer = FramePacer(1000000 / Graphics::GetDefaultFps(), max_frameskip, max_catchup);
+
+	// The random number generator must match the one of the recording
+	bool replaying = false;
+	if (!replay_input_file.empty()) {
+		int32_t log_seed;
+		replaying = Input::StartReplay(replay_input_file, log_seed);
+		if (replaying) {
+			srand(log_seed);
+			Utils::SeedRandomNumberGenerator(log_seed);
+		}
+	} else if (!record_input_file.empty()) {
+		if (!seed_set) {
+			seed = static_cast<int32_t>(time(NULL));
+			srand(seed);
+			Utils::SeedRandomNumberGenerator(seed);
+		}
+		Input::StartRecording(record_input_file, seed);
+	}
+
+	if (benchmark_flag) {
+		if (replaying) {
+			Benchmark::Start();
+		} else {
+			Output::Warning("--benchmark requires a log passed with --replay-input");
+			benchmark_flag = false;
+		}
+	}
+
 	// Reset frames before starting
 	FrameReset();
 
@@ -276,9 +329,7 @@ void Player::Resume() {
 }
 
 void Player::Update(bool update_scene) {
-	// available ms per frame, game logic expects 60 fps
-	static const double framerate_interval = 1000.0 / Graphics::GetDefaultFps();
-	next_frame = start_time + framerate_interval;
+	Profiler::BeginFrame();
 
 #ifdef EMSCRIPTEN
 	// Ticks in emscripten are unreliable due to how the main loop works:
@@ -286,18 +337,26 @@ void Player::Update(bool update_scene) {
 	// 1000s of times.
 	Graphics::Update(true);
 #else
-	// Time left before next frame? Let's render the current frame.
-	double cur_time = (double)DisplayUi->GetTicks();
-	if (cur_time < next_frame) {
+	int64_t frame_start = 0;
+	int64_t render_end = 0;
+
+	if (benchmark_flag) {
+		// Every frame is drawn and the game runs as fast as possible
+		frame_start = static_cast<int64_t>(DisplayUi->GetTicksMicro());
 		Graphics::Update(true);
+		render_end = static_cast<int64_t>(DisplayUi->GetTicksMicro());
+	} else {
+		frame_pacer.SetVsync(DisplayUi->IsFrameRateSynchronized());
+
+		// Render the frame unless the game is behind and may skip it
+		Graphics::Update(frame_pacer.BeginFrame(DisplayUi->GetTicksMicro()));
 
-		cur_time = (double)DisplayUi->GetTicks();
 		// Still time after graphic update? Yield until it's time for next one.
-		if (cur_time < next_frame) {
-			DisplayUi->Sleep((uint32_t)(next_frame - cur_time));
+		int64_t wait = frame_pacer.EndFrame(DisplayUi->GetTicksMicro());
+		if (wait >= 1000) {
+			Profiler::Scope scope("Sleep");
+			DisplayUi->Sleep(static_cast<uint32_t>(wait / 1000));
 		}
-	} else {
-		Graphics::Update(false);
 	}
 #endif
 
@@ -311,6 +370,9 @@ void Player::Update(bool update_scene) {
 	if (Input::IsTriggered(Input::SHOW_LOG)) {
 		Output::ToggleLog();
 	}
+	if (Input::IsTriggered(Input::TOGGLE_PROFILER)) {
+		Profiler::Toggle();
+	}
 
 	DisplayUi->ProcessEvents();
 
@@ -326,25 +388,42 @@ void Player::Update(bool update_scene) {
 		}
 	}
 
-	Audio().Update();
+	{
+		Profiler::Scope scope("Audio::Update");
+		Audio().Update();
+	}
 	Input::Update();
+	if (Input::IsRecordingOrReplaying()) {
+		// Tasks finish after a varying number of frames, a replay must see
+		// their results in the same frame as the recording
+		WorkerPool::WaitAll();
+	} else {
+		WorkerPool::Update();
+	}
+	Output::Update();
+	MemoryStats::Update();
 	if (update_scene) {
+		Profiler::Scope scope("Scene::Update");
 		Scene::instance->Update();
 	}
 
-	start_time = next_frame;
+#ifndef EMSCRIPTEN
+	if (benchmark_flag) {
+		Benchmark::AddFrame(static_cast<int64_t>(DisplayUi->GetTicksMicro()) - render_end,
+			render_end - frame_start);
+
+		if (!exit_flag && Input::IsReplayFinished()) {
+			Benchmark::Report();
+			exit_flag = true;
+		}
+	}
+#endif
+
 	++frames;
 }
 
 void Player::FrameReset() {
-	// When update started
-	start_time = (double)DisplayUi->GetTicks();
-
-	// available ms per frame, game logic expects 60 fps
-	static const double framerate_interval = 1000.0 / Graphics::GetDefaultFps();
-
-	// When next frame is expected
-	next_frame = start_time + framerate_interval;
+	frame_pacer.Reset(DisplayUi->GetTicksMicro());
 
 	Graphics::FrameReset();
 }
@@ -364,6 +443,14 @@ void Player::Exit() {
 	DisplayUi->UpdateDisplay();
 #endif
 
+	// Write the trace of a running profiler
+	if (Profiler::IsEnabled()) {
+		Profiler::Toggle();
+	}
+
+	Input::StopRecording();
+
+	WorkerPool::Quit();
 	Font::Dispose();
 	Graphics::Quit();
 	FileFinder::Quit();
@@ -398,6 +485,10 @@ void Player::ParseCommandLine(int argc, char *argv[]) {
 	window_flag = false;
 #endif
 	fps_flag = false;
+	vsync_flag = false;
+	max_frameskip = 5;
+	max_catchup = 15;
+	benchmark_flag = false;
 	debug_flag = false;
 	hide_title_flag = false;
 	exit_flag = false;
@@ -411,6 +502,7 @@ void Player::ParseCommandLine(int argc, char *argv[]) {
 	start_map_id = -1;
 	no_rtp_flag = false;
 	no_audio_flag = false;
+	archive_file.clear();
 
 	std::vector<std::string> args;
 
@@ -438,6 +530,23 @@ void Player::ParseCommandLine(int argc, char *argv[]) {
 		else if (*it == "--show-fps") {
 			fps_flag = true;
 		}
+		else if (*it == "--vsync") {
+			vsync_flag = true;
+		}
+		else if (*it == "--max-frameskip") {
+			++it;
+			if (it == args.end()) {
+				return;
+			}
+			max_frameskip = std::max(0, atoi((*it).c_str()));
+		}
+		else if (*it == "--max-catchup") {
+			++it;
+			if (it == args.end()) {
+				return;
+			}
+			max_catchup = std::max(0, atoi((*it).c_str()));
+		}
 		else if (*it == "testplay" || *it == "--test-play") {
 			debug_flag = true;
 		}
@@ -488,6 +597,22 @@ void Player::ParseCommandLine(int argc, char *argv[]) {
 			// case sensitive
 			Main_Data::SetSavePath(argv[it - args.begin() + 1]);
 		}
+		else if (*it == "--cache-path") {
+			++it;
+			if (it == args.end()) {
+				return;
+			}
+			// case sensitive
+			Main_Data::SetCachePath(argv[it - args.begin() + 1]);
+		}
+		else if (*it == "--create-archive") {
+			++it;
+			if (it == args.end()) {
+				return;
+			}
+			// case sensitive
+			archive_file = argv[it - args.begin() + 1];
+		}
 		else if (*it == "--new-game") {
 			new_game_flag = true;
 		}
@@ -515,8 +640,27 @@ void Player::ParseCommandLine(int argc, char *argv[]) {
 			if (it == args.end()) {
 				return;
 			}
-			srand(atoi((*it).c_str()));
-			Utils::SeedRandomNumberGenerator(atoi((*it).c_str()));
+			seed = atoi((*it).c_str());
+			seed_set = true;
+			srand(seed);
+			Utils::SeedRandomNumberGenerator(seed);
+		}
+		else if (*it == "--record-input") {
+			++it;
+			if (it == args.end()) {
+				return;
+			}
+			record_input_file = *it;
+		}
+		else if (*it == "--replay-input") {
+			++it;
+			if (it == args.end()) {
+				return;
+			}
+			replay_input_file = *it;
+		}
+		else if (*it == "--benchmark") {
+			benchmark_flag = true;
 		}
 		else if (*it == "--start-map-id") {
 			++it;
@@ -594,47 +738,21 @@ void Player::ParseCommandLine(int argc, char *argv[]) {
 	}
 }
 
+bool Player::CreateArchive() {
+	std::string project_path = Main_Data::GetProjectPath();
+	return GameArchive::Create(project_path.empty() ? "." : project_path, archive_file);
+}
+
 static void OnSystemFileReady(FileRequestResult* result) {
 	Game_System::SetSystemName(result->file);
 }
 
 void Player::CreateGameObjects() {
-	GetEncoding();
-	escape_symbol = ReaderUtil::Recode("\\", encoding);
-	if (escape_symbol.empty()) {
-		Output::Error("Invalid encoding: %s.", encoding.c_str());
-	}
-
-	std::string game_path = Main_Data::GetProjectPath();
-	std::string save_path = Main_Data::GetSavePath();
-	if (game_path == save_path) {
-		Output::Debug("Using %s as Game and Save directory", game_path.c_str());
-	} else {
-		Output::Debug("Using %s as Game directory", game_path.c_str());
-		Output::Debug("Using %s as Save directory", save_path.c_str());
-	}
-
-	LoadDatabase();
-
-	std::string ini_file = FileFinder::FindDefault(INI_NAME);
-
-	INIReader ini(ini_file);
-	if (ini.ParseError() != -1) {
-		std::string title = ini.Get("RPG_RT", "GameTitle", GAME_TITLE);
-		game_title = ReaderUtil::Recode(title, encoding);
-		no_rtp_flag = ini.Get("RPG_RT", "FullPackageFlag", "0") == "1"? true : no_rtp_flag;
-	}
-
-	std::stringstream title;
-	if (!game_title.empty()) {
-		Output::Debug("Loading game %s", game_title.c_str());
-		title << game_title << " - ";
-	} else {
-		Output::Warning("Could not read game title.");
-	}
-	title << GAME_TITLE;
-	DisplayUi->SetTitle(title.str());
+	GameLoader loader;
+	loader.Finish();
+}
 
+void Player::DetectEngine() {
 	if (engine == EngineNone) {
 		if (Data::system.ldb_id == 2003) {
 			engine = EngineRpg2k3;
@@ -669,12 +787,6 @@ void Player::CreateGameObjects() {
 		}
 	}
 	Output::Debug("Engine configured as: 2k=%d 2k3=%d 2k3Legacy=%d MajorUpdated=%d 2k3E=%d", Player::IsRPG2k(), Player::IsRPG2k3(), Player::IsRPG2k3Legacy(), Player::IsMajorUpdatedVersion(), Player::IsRPG2k3E());
-
-	if (!no_rtp_flag) {
-		FileFinder::InitRtpPaths();
-	}
-
-	ResetGameObjects();
 }
 
 void Player::ResetGameObjects() {
@@ -702,49 +814,6 @@ void Player::ResetGameObjects() {
 	FrameReset();
 }
 
-void Player::LoadDatabase() {
-	// Load Database
-	Data::Clear();
-
-	if (!FileFinder::IsRPG2kProject(*FileFinder::GetDirectoryTree()) &&
-		!FileFinder::IsEasyRpgProject(*FileFinder::GetDirectoryTree())) {
-		// Unlikely to happen because of the game browser only launches valid games
-
-		Output::Debug("%s is not a supported project", Main_Data::GetProjectPath().c_str());
-
-		Output::Error("%s\n\n%s\n\n%s\n\n%s","No valid game was found.",
-			"EasyRPG must be run from a game folder containing\nRPG_RT.ldb and RPG_RT.lmt.",
-			"This engine only supports RPG Maker 2000 and 2003\ngames.",
-			"RPG Maker XP, VX, VX Ace and MV are NOT supported.");
-	}
-
-	// Try loading EasyRPG project files first, then fallback to normal RPG Maker
-	std::string edb = FileFinder::FindDefault(DATABASE_NAME_EASYRPG);
-	std::string emt = FileFinder::FindDefault(TREEMAP_NAME_EASYRPG);
-
-	bool easyrpg_project = !edb.empty() && !emt.empty();
-
-	if (easyrpg_project) {
-		if (!LDB_Reader::LoadXml(edb)) {
-			Output::ErrorStr(LcfReader::GetError());
-		}
-		if (!LMT_Reader::LoadXml(emt)) {
-			Output::ErrorStr(LcfReader::GetError());
-		}
-	}
-	else {
-		std::string ldb = FileFinder::FindDefault(DATABASE_NAME);
-		std::string lmt = FileFinder::FindDefault(TREEMAP_NAME);
-
-		if (!LDB_Reader::Load(ldb, encoding)) {
-			Output::ErrorStr(LcfReader::GetError());
-		}
-		if (!LMT_Reader::Load(lmt, encoding)) {
-			Output::ErrorStr(LcfReader::GetError());
-		}
-	}
-}
-
 static void OnMapSaveFileReady(FileRequestResult*) {
 	Game_Actors::Fixup();
 
@@ -762,7 +831,7 @@ static void OnMapSaveFileReady(FileRequestResult*) {
 }
 
 void Player::LoadSavegame(const std::string& save_name) {
-	std::unique_ptr<RPG::Save> save = LSD_Reader::Load(save_name, encoding);
+	std::unique_ptr<RPG::Save> save = SaveCache::Load(save_name);
 
 	if (!save.get()) {
 		Output::Error("%s", LcfReader::GetError().c_str());
@@ -892,6 +961,17 @@ void Player::PrintUsage() {
 R"(EasyRPG Player - An open source interpreter for RPG Maker 2000/2003 games.
 Options:
       --battle-test N      Start a battle test with monster party N.
+      --benchmark          Replay the log of --replay-input as fast as possible,
+                           print frame time and memory statistics and exit.
+      --cache-path PATH    Store cache files in PATH. MIDI music is rendered
+                           once and played from the cache afterwards.
+                           The file list of the game directory is kept
+                           there as well to speed up the startup.
+                           The directory must exist.
+      --create-archive FILE
+                           Pack the game into the archive FILE and exit.
+                           Name it Game.pack and put it in an empty game
+                           directory to play the game from the archive.
       --disable-audio      Disable audio (in case you prefer your own music).
       --disable-rtp        Disable support for the Runtime Package (RTP).
       --encoding N         Instead of auto detecting the encoding or using
@@ -910,14 +990,25 @@ Options:
                            command menu.
       --load-game-id N     Skip the title scene and load SaveN.lsd
                            (N is padded to two digits).
+      --max-catchup N      When the game runs behind it speeds up for at most
+                           N frames to catch up, afterwards it slows down
+                           (default: 15).
+      --max-frameskip N    Skip drawing at most N frames in a row when the
+                           game runs behind (default: 5, 0 disables it).
       --new-game           Skip the title scene and start a new game directly.
       --project-path PATH  Instead of using the working directory the game in
                            PATH is used.
+      --record-input FILE  Write the pressed buttons of every frame and the
+                           random seed to FILE.
+      --replay-input FILE  Play back the buttons recorded in FILE instead of
+                           reading the keyboard. Use the same game, savegames
+                           and options as during the recording.
       --save-path PATH     Instead of storing save files in the game directory
                            they are stored in PATH. The directory must exist.
                            When using the game browser all games will share
                            the same save directory!
       --seed N             Seeds the random number generator with N.
+                           Ignored when replaying an input log.
       --start-map-id N     Overwrite the map used for new games and use.
                            MapN.lmu instead (N is padded to four digits).
                            Incompatible with --load-game-id.
@@ -928,6 +1019,8 @@ Options:
                            with IDs A, B, C...
                            Incompatible with --load-game-id.
       --test-play          Enable TestPlay mode.
+      --vsync              Wait for the vertical blank of the display.
+                           When the display runs at 60 Hz it paces the game.
       --window             Start in window mode.
   -v, --version            Display program version and exit.
   -h, --help               Display this help and exit.
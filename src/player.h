@@ -96,20 +96,31 @@ namespace Player {
 	void ParseCommandLine(int argc, char *argv[]);
 
 	/**
-	 * Initializes all game objects
+	 * Packs the game directory into archive_file, see GameArchive.
+	 * Runs instead of the game when --create-archive is passed.
+	 *
+	 * @return whether the archive was written
+	 */
+	bool CreateArchive();
+
+	/**
+	 * Loads the game in the project directory and initializes all game
+	 * objects. Blocks until the game is loaded, Scene_Logo uses GameLoader
+	 * directly to keep the main loop running while loading.
 	 */
 	void CreateGameObjects();
 
 	/**
-	 * Resets all game objects. Faster then CreateGameObjects because
-	 * the database is not reparsed.
+	 * Detects the engine from the database and the game directory unless
+	 * it was set on the command line.
 	 */
-	void ResetGameObjects();
+	void DetectEngine();
 
 	/**
-	 * Loads all databases.
+	 * Resets all game objects. Faster then CreateGameObjects because
+	 * the database is not reparsed.
 	 */
-	void LoadDatabase();
+	void ResetGameObjects();
 
 	/**
 	 * Loads savegame data.
@@ -184,6 +195,18 @@ namespace Player {
 	/** FPS flag, if true will display frames per second counter. */
 	extern bool fps_flag;
 
+	/** Vsync flag, if true the display waits for the vertical blank. */
+	extern bool vsync_flag;
+
+	/** Maximum number of frames in a row that are not rendered when the game runs behind. */
+	extern int max_frameskip;
+
+	/** Maximum number of frames the game logic catches up before it slows down. */
+	extern int max_catchup;
+
+	/** Benchmark flag, if true a replayed input log is measured without frame pacing. */
+	extern bool benchmark_flag;
+
 	/** Battle Test flag, if true will run battle test. */
 	extern bool battle_test_flag;
 
@@ -226,6 +249,9 @@ namespace Player {
 	/** Game title. */
 	extern std::string game_title;
 
+	/** Archive to create (--create-archive), the game is not run when set. */
+	extern std::string archive_file;
+
 #ifdef EMSCRIPTEN
 	/** Name of game emscripten uses */
 	extern std::string emscripten_game_name;
@@ -0,0 +1,271 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "profiler.h"
+#include "baseui.h"
+#include "bitmap.h"
+#include "filefinder.h"
+#include "main_data.h"
+#include "output.h"
+#include "utils.h"
+
+namespace {
+	/** Frames shown in the graph */
+	const size_t HISTORY_SIZE = 120;
+	/** Upper bound of the trace size, about 20 MB of JSON */
+	const size_t MAX_TRACE_EVENTS = 250000;
+	/** Height of the graph, covers two frames at 60 fps */
+	const int GRAPH_HEIGHT = 64;
+	const int64_t GRAPH_RANGE = 33333;
+	const int64_t FRAME_BUDGET = 16667;
+
+	struct Event {
+		const char* name;
+		int64_t start;
+		int64_t duration;
+	};
+
+	struct Frame {
+		int64_t duration = 0;
+		/** Time of the top level scopes */
+		std::vector<std::pair<const char*, int64_t>> parts;
+	};
+
+	bool enabled = false;
+
+	int64_t trace_start;
+	std::vector<Event> trace;
+	bool trace_full;
+
+	std::vector<Event> open_scopes;
+	Frame frame;
+	int64_t frame_start;
+	std::vector<Frame> history;
+	size_t history_pos;
+
+	/** Names of the top level scopes in order of appearance, decides the color */
+	std::vector<const char*> legend;
+
+	const Color palette[] = {
+		Color(80, 160, 255, 255),
+		Color(255, 160, 40, 255),
+		Color(100, 220, 100, 255),
+		Color(240, 80, 80, 255),
+		Color(200, 120, 255, 255),
+		Color(240, 230, 90, 255)
+	};
+	const size_t palette_size = sizeof(palette) / sizeof(palette[0]);
+
+	int64_t Now() {
+		return static_cast<int64_t>(DisplayUi->GetTicksMicro());
+	}
+
+	size_t LegendIndex(const char* name) {
+		auto it = std::find(legend.begin(), legend.end(), name);
+		if (it != legend.end()) {
+			return it - legend.begin();
+		}
+		legend.push_back(name);
+		return legend.size() - 1;
+	}
+
+	void Start() {
+		enabled = true;
+		trace.clear();
+		trace_full = false;
+		open_scopes.clear();
+		history.assign(HISTORY_SIZE, Frame());
+		history_pos = 0;
+		legend.clear();
+		frame = Frame();
+		frame_start = Now();
+		trace_start = frame_start;
+	}
+
+	void Stop() {
+		enabled = false;
+
+		int index = 0;
+		std::string file;
+		do {
+			file = FileFinder::MakePath(Main_Data::GetSavePath(),
+				"trace_" + Utils::ToString(index++) + ".json");
+		} while (FileFinder::Exists(file));
+
+		Profiler::WriteTrace(file);
+
+		trace.clear();
+		trace.shrink_to_fit();
+		history.clear();
+	}
+}
+
+void Profiler::Begin(const char* name) {
+	if (!enabled) {
+		return;
+	}
+
+	open_scopes.push_back({name, Now(), 0});
+}
+
+void Profiler::End() {
+	if (!enabled || open_scopes.empty()) {
+		return;
+	}
+
+	Event event = open_scopes.back();
+	open_scopes.pop_back();
+	event.duration = Now() - event.start;
+
+	if (open_scopes.empty()) {
+		auto it = std::find_if(frame.parts.begin(), frame.parts.end(),
+			[&](const std::pair<const char*, int64_t>& part) { return part.first == event.name; });
+		if (it != frame.parts.end()) {
+			it->second += event.duration;
+		} else {
+			frame.parts.push_back({event.name, event.duration});
+		}
+	}
+
+	if (trace.size() < MAX_TRACE_EVENTS) {
+		trace.push_back(event);
+	} else if (!trace_full) {
+		trace_full = true;
+		Output::Debug("Profiler: Trace is full, further scopes are not recorded");
+	}
+}
+
+void Profiler::BeginFrame() {
+	if (!enabled) {
+		return;
+	}
+
+	int64_t now = Now();
+	frame.duration = now - frame_start;
+	frame_start = now;
+
+	std::swap(history[history_pos], frame);
+	history_pos = (history_pos + 1) % HISTORY_SIZE;
+	frame.duration = 0;
+	frame.parts.clear();
+}
+
+void Profiler::Toggle() {
+	if (enabled) {
+		Stop();
+	} else {
+		Start();
+	}
+}
+
+bool Profiler::IsEnabled() {
+	return enabled;
+}
+
+void Profiler::Draw(Bitmap& dst) {
+	if (!enabled) {
+		return;
+	}
+
+	Scope scope("Profiler::Draw");
+
+	const int bar_width = 2;
+	int graph_width = static_cast<int>(HISTORY_SIZE) * bar_width;
+	int x0 = 2;
+	int y0 = dst.GetHeight() - GRAPH_HEIGHT - 2;
+
+	dst.FillRect(Rect(x0, y0, graph_width, GRAPH_HEIGHT), Color(0, 0, 0, 160));
+
+	auto to_pixels = [](int64_t time) {
+		return static_cast<int>(std::min<int64_t>(time * GRAPH_HEIGHT / GRAPH_RANGE, GRAPH_HEIGHT));
+	};
+
+	// Oldest frame left, busy time stacked by scope, rest of the frame gray
+	std::vector<int64_t> totals;
+	for (size_t i = 0; i < HISTORY_SIZE; ++i) {
+		const Frame& f = history[(history_pos + i) % HISTORY_SIZE];
+		int x = x0 + static_cast<int>(i) * bar_width;
+		int64_t time = 0;
+		int y = y0 + GRAPH_HEIGHT;
+
+		for (const auto& part : f.parts) {
+			size_t index = LegendIndex(part.first);
+			if (totals.size() <= index) {
+				totals.resize(index + 1);
+			}
+			totals[index] += part.second;
+
+			int h = to_pixels(time + part.second) - to_pixels(time);
+			time += part.second;
+			y -= h;
+			if (h > 0) {
+				dst.FillRect(Rect(x, y, bar_width, h), palette[index % palette_size]);
+			}
+		}
+
+		int h = to_pixels(f.duration) - to_pixels(time);
+		if (h > 0) {
+			dst.FillRect(Rect(x, y - h, bar_width, h), Color(128, 128, 128, 255));
+		}
+	}
+
+	// Frame budget at 60 fps
+	dst.FillRect(Rect(x0, y0 + GRAPH_HEIGHT - to_pixels(FRAME_BUDGET), graph_width, 1), Color(255, 255, 255, 255));
+
+	// Average time per frame of every top level scope
+	int y = y0 - 2;
+	for (size_t i = legend.size(); i > 0; --i) {
+		size_t index = i - 1;
+		int64_t avg = index < totals.size() ? totals[index] / static_cast<int64_t>(HISTORY_SIZE) : 0;
+		std::string text = std::string(legend[index]) + " " +
+			Utils::ToString(avg / 1000) + "." + Utils::ToString(avg / 100 % 10) + " ms";
+
+		Rect rect = dst.GetFont()->GetSize(text);
+		y -= rect.height;
+		dst.FillRect(Rect(x0, y, rect.width + 10, rect.height), Color(0, 0, 0, 160));
+		dst.FillRect(Rect(x0 + 1, y + rect.height / 2 - 2, 4, 4), palette[index % palette_size]);
+		dst.TextDraw(x0 + 8, y, Color(255, 255, 255, 255), text);
+	}
+}
+
+bool Profiler::WriteTrace(const std::string& file) {
+	std::shared_ptr<std::fstream> out = FileFinder::openUTF8(file,
+		std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if (!out) {
+		Output::Warning("Profiler: Could not write %s", file.c_str());
+		return false;
+	}
+
+	// Complete events ("ph":"X"), timestamps in us
+	*out << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < trace.size(); ++i) {
+		const Event& event = trace[i];
+		*out << "{\"name\":\"" << event.name
+			<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << (event.start - trace_start)
+			<< ",\"dur\":" << event.duration << "}"
+			<< (i + 1 < trace.size() ? ",\n" : "\n");
+	}
+	*out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+	Output::Debug("Profiler: Saved trace %s (%d scopes)", file.c_str(), static_cast<int>(trace.size()));
+	return true;
+}
@@ -0,0 +1,106 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_PROFILER_H
+#define EASYRPG_PROFILER_H
+
+// Headers
+#include <cstdint>
+#include <string>
+
+class Bitmap;
+
+/**
+ * Profiler namespace.
+ * Measures how long named scopes of the main loop take. While enabled the
+ * time of the top level scopes is shown as a graph on screen and all
+ * scopes are recorded. When it is disabled again the recording is written
+ * to the save directory as a Chrome trace (chrome://tracing).
+ * Scope names must be string literals. Only use it on the main thread.
+ */
+namespace Profiler {
+	/**
+	 * Measures the time until the end of the C++ scope.
+	 */
+	class Scope {
+	public:
+		explicit Scope(const char* name);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		bool active;
+	};
+
+	/**
+	 * Starts measuring a scope.
+	 *
+	 * @param name scope name.
+	 */
+	void Begin(const char* name);
+
+	/**
+	 * Ends the scope started last.
+	 */
+	void End();
+
+	/**
+	 * Starts a new frame, the time since the last call is the frame time.
+	 */
+	void BeginFrame();
+
+	/**
+	 * Enables or disables the profiler. Disabling it writes the trace.
+	 */
+	void Toggle();
+
+	/**
+	 * @return whether the profiler is enabled.
+	 */
+	bool IsEnabled();
+
+	/**
+	 * Draws the frame time graph.
+	 *
+	 * @param dst bitmap to draw on.
+	 */
+	void Draw(Bitmap& dst);
+
+	/**
+	 * Writes the recorded scopes as Chrome trace JSON.
+	 *
+	 * @param file file to write.
+	 * @return whether the file was written.
+	 */
+	bool WriteTrace(const std::string& file);
+}
+
+inline Profiler::Scope::Scope(const char* name) : active(IsEnabled()) {
+	if (active) {
+		Begin(name);
+	}
+}
+
+inline Profiler::Scope::~Scope() {
+	if (active) {
+		End();
+	}
+}
+
+#endif
@@ -91,6 +91,10 @@ void Psp2Ui::Sleep(uint32_t time) {
 	sceKernelDelayThread(usecs);
 }
 
+uint64_t Psp2Ui::GetTicksMicro() const {
+	return sceKernelGetProcessTimeWide() - starttick * 1000;
+}
+
 uint32_t Psp2Ui::GetTicks() const {
 	return (sceKernelGetProcessTimeWide() / 1000 - starttick);
 }
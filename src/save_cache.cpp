@@ -0,0 +1,330 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include "filefinder.h"
+#include "lsd_reader.h"
+#include "main_data.h"
+#include "output.h"
+#include "player.h"
+#include "save_cache.h"
+
+#ifdef USE_SDL
+#  include <SDL.h>
+#endif
+
+const char* const SaveCache::QUICK_SAVE_NAME = "SaveQuick.lsd";
+
+namespace {
+	using SaveCache::FileStamp;
+
+	/**
+	 * Holds the lock of the savegame parser while in scope. The static
+	 * state of liblcf is not thread-safe and titles are read on worker
+	 * threads.
+	 */
+	class LsdLock {
+	public:
+		LsdLock() {
+#ifdef USE_SDL
+			static SDL_mutex* const mutex = SDL_CreateMutex();
+			lsd_mutex = mutex;
+			SDL_LockMutex(lsd_mutex);
+#endif
+		}
+
+		~LsdLock() {
+#ifdef USE_SDL
+			SDL_UnlockMutex(lsd_mutex);
+#endif
+		}
+
+	private:
+#ifdef USE_SDL
+		SDL_mutex* lsd_mutex;
+#endif
+	};
+
+	struct TitleEntry {
+		FileStamp stamp;
+		bool corrupted = false;
+		RPG::SaveTitle title;
+	};
+
+	std::unordered_map<std::string, TitleEntry> titles;
+	bool titles_loaded = false;
+	bool titles_dirty = false;
+
+	std::string snapshot_file;
+	FileStamp snapshot_stamp;
+	std::unique_ptr<RPG::Save> snapshot;
+
+	const char TITLE_MAGIC[8] = { 'E', 'R', 'P', 'G', 'S', 'T', 'C', '1' };
+
+	FileStamp GetStamp(const std::string& filename) {
+		FileStamp stamp;
+		stamp.mtime = FileFinder::GetModificationTime(filename);
+		stamp.size = FileFinder::GetFileSize(filename);
+		return stamp;
+	}
+
+	std::string GetTitleCacheFilename() {
+		return FileFinder::MakePath(Main_Data::GetCachePath(), "save_titles.bin");
+	}
+
+	template <typename T>
+	void Write(std::string& out, T value) {
+		out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void Write(std::string& out, const std::string& value) {
+		Write<uint32_t>(out, (uint32_t) value.size());
+		out += value;
+	}
+
+	template <typename T>
+	bool Read(const uint8_t*& pos, const uint8_t* end, T& value) {
+		if ((size_t) (end - pos) < sizeof(T)) {
+			return false;
+		}
+		memcpy(&value, pos, sizeof(T));
+		pos += sizeof(T);
+		return true;
+	}
+
+	bool Read(const uint8_t*& pos, const uint8_t* end, std::string& value) {
+		uint32_t size;
+		if (!Read(pos, end, size) || (size_t) (end - pos) < size) {
+			return false;
+		}
+		value.assign(reinterpret_cast<const char*>(pos), size);
+		pos += size;
+		return true;
+	}
+
+	/**
+	 * Reads the titles stored by SaveTitles. Entries that are already
+	 * cached are not replaced.
+	 */
+	void LoadTitles() {
+		titles_loaded = true;
+
+		if (Main_Data::GetCachePath().empty()) {
+			return;
+		}
+
+		std::string filename = GetTitleCacheFilename();
+		if (!FileFinder::Exists(filename)) {
+			return;
+		}
+
+		FileSpanRef data = FileSpan::Map(filename);
+		if (!data || data->size() < sizeof(TITLE_MAGIC) ||
+			memcmp(data->data(), TITLE_MAGIC, sizeof(TITLE_MAGIC)) != 0) {
+			return;
+		}
+
+		const uint8_t* pos = data->data() + sizeof(TITLE_MAGIC);
+		const uint8_t* end = data->data() + data->size();
+		uint32_t count;
+		if (!Read(pos, end, count)) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < count; ++i) {
+			std::string filename;
+			TitleEntry entry;
+			RPG::SaveTitle& t = entry.title;
+			uint8_t corrupted;
+			if (!Read(pos, end, filename) || !Read(pos, end, entry.stamp.mtime) ||
+				!Read(pos, end, entry.stamp.size) || !Read(pos, end, corrupted) ||
+				!Read(pos, end, t.timestamp) || !Read(pos, end, t.hero_name) ||
+				!Read(pos, end, t.hero_level) || !Read(pos, end, t.hero_hp) ||
+				!Read(pos, end, t.face1_name) || !Read(pos, end, t.face1_id) ||
+				!Read(pos, end, t.face2_name) || !Read(pos, end, t.face2_id) ||
+				!Read(pos, end, t.face3_name) || !Read(pos, end, t.face3_id) ||
+				!Read(pos, end, t.face4_name) || !Read(pos, end, t.face4_id)) {
+				Output::Debug("Save title cache is corrupted");
+				return;
+			}
+			entry.corrupted = corrupted != 0;
+			titles.insert(std::make_pair(filename, entry));
+		}
+	}
+
+	void SaveTitles() {
+		if (Main_Data::GetCachePath().empty()) {
+			return;
+		}
+
+		std::string out(TITLE_MAGIC, sizeof(TITLE_MAGIC));
+		Write<uint32_t>(out, (uint32_t) titles.size());
+		for (auto& it : titles) {
+			const TitleEntry& entry = it.second;
+			const RPG::SaveTitle& t = entry.title;
+			Write(out, it.first);
+			Write(out, entry.stamp.mtime);
+			Write(out, entry.stamp.size);
+			Write<uint8_t>(out, entry.corrupted ? 1 : 0);
+			Write(out, t.timestamp);
+			Write(out, t.hero_name);
+			Write(out, t.hero_level);
+			Write(out, t.hero_hp);
+			Write(out, t.face1_name);
+			Write(out, t.face1_id);
+			Write(out, t.face2_name);
+			Write(out, t.face2_id);
+			Write(out, t.face3_name);
+			Write(out, t.face3_id);
+			Write(out, t.face4_name);
+			Write(out, t.face4_id);
+		}
+
+		// Write to a temporary file first, a partially written cache is
+		// never used
+		std::string filename = GetTitleCacheFilename();
+		std::string tmp_filename = filename + ".tmp";
+		FILE* file = FileFinder::fopenUTF8(tmp_filename, "wb");
+		if (!file) {
+			return;
+		}
+		bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+		ok = fclose(file) == 0 && ok;
+		std::remove(filename.c_str());
+		if (!ok || std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+			std::remove(tmp_filename.c_str());
+		}
+	}
+
+	void SetSnapshot(const std::string& filename, const FileStamp& stamp, const RPG::Save& save) {
+		snapshot_file = filename;
+		snapshot_stamp = stamp;
+		snapshot.reset(new RPG::Save(save));
+	}
+}
+
+bool SaveCache::GetTitle(const std::string& filename, RPG::SaveTitle& title) {
+	bool corrupted;
+	if (FindTitle(filename, title, corrupted)) {
+		return !corrupted;
+	}
+
+	FileStamp stamp;
+	corrupted = !ReadTitle(filename, title, stamp);
+	StoreTitle(filename, stamp, title, corrupted);
+	Flush();
+	return !corrupted;
+}
+
+bool SaveCache::FindTitle(const std::string& filename, RPG::SaveTitle& title, bool& corrupted) {
+	if (!titles_loaded) {
+		LoadTitles();
+	}
+
+	auto it = titles.find(filename);
+	if (it == titles.end() || !(it->second.stamp == GetStamp(filename))) {
+		return false;
+	}
+
+	title = it->second.title;
+	corrupted = it->second.corrupted;
+	return true;
+}
+
+bool SaveCache::ReadTitle(const std::string& filename, RPG::SaveTitle& title, FileStamp& stamp) {
+	// The stamp is taken first, a file changing while it is parsed is
+	// read again next time
+	stamp = GetStamp(filename);
+
+	std::unique_ptr<RPG::Save> save;
+	{
+		LsdLock lock;
+		save = LSD_Reader::Load(filename, Player::encoding);
+	}
+	if (!save) {
+		title = RPG::SaveTitle();
+		return false;
+	}
+
+	title = save->title;
+	return true;
+}
+
+void SaveCache::StoreTitle(const std::string& filename, const FileStamp& stamp, const RPG::SaveTitle& title, bool corrupted) {
+	TitleEntry entry;
+	entry.stamp = stamp;
+	entry.title = title;
+	entry.corrupted = corrupted;
+	titles[filename] = entry;
+	titles_dirty = true;
+}
+
+void SaveCache::Flush() {
+	if (titles_dirty) {
+		SaveTitles();
+		titles_dirty = false;
+	}
+}
+
+std::unique_ptr<RPG::Save> SaveCache::Load(const std::string& filename) {
+	FileStamp stamp = GetStamp(filename);
+
+	if (snapshot && snapshot_file == filename && snapshot_stamp == stamp) {
+		Output::Debug("Using snapshot of %s", filename.c_str());
+		return std::unique_ptr<RPG::Save>(new RPG::Save(*snapshot));
+	}
+
+	std::unique_ptr<RPG::Save> save;
+	{
+		LsdLock lock;
+		save = LSD_Reader::Load(filename, Player::encoding);
+	}
+	if (save) {
+		SetSnapshot(filename, stamp, *save);
+	}
+	return save;
+}
+
+bool SaveCache::Save(const std::string& filename, const RPG::Save& save) {
+	bool saved;
+	{
+		LsdLock lock;
+		saved = LSD_Reader::Save(filename, save, Player::encoding);
+	}
+	if (!saved) {
+		snapshot.reset();
+		return false;
+	}
+
+	// The timestamp is set by the writer, the title is read again
+	// the next time it is needed
+	titles.erase(filename);
+
+	SetSnapshot(filename, GetStamp(filename), save);
+	return true;
+}
+
+void SaveCache::Clear() {
+	titles.clear();
+	titles_loaded = false;
+	titles_dirty = false;
+	snapshot.reset();
+	snapshot_file.clear();
+}
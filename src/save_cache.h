@@ -0,0 +1,128 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_SAVE_CACHE_H
+#define EASYRPG_SAVE_CACHE_H
+
+// Headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "filefinder.h"
+#include "rpg_save.h"
+#include "rpg_savetitle.h"
+
+/**
+ * SaveCache avoids parsing savegames more often than necessary.
+ *
+ * The title of every savegame (party faces, hero name, level, HP and
+ * timestamp) is cached per file, so the save and load menus don't parse
+ * the full savegames. With a cache path (see Main_Data::GetCachePath) the
+ * titles are kept across sessions.
+ *
+ * The last savegame that was written or loaded is kept in memory as a
+ * snapshot. Loading it again (e.g. a quick load after a quick save) doesn't
+ * read the file.
+ *
+ * Cache entries are only used while the modification time and size of the
+ * savegame file match.
+ */
+namespace SaveCache {
+	/** Name of the quick save file in the save directory */
+	extern const char* const QUICK_SAVE_NAME;
+
+	/** Modification time and size of a savegame file */
+	struct FileStamp {
+		int64_t mtime = -1;
+		Offset size = -1;
+
+		bool operator==(const FileStamp& o) const {
+			return mtime == o.mtime && size == o.size;
+		}
+	};
+
+	/**
+	 * Gets the title of a savegame.
+	 *
+	 * @param filename path to the savegame
+	 * @param title filled with the title of the savegame
+	 * @return false when the savegame is corrupted
+	 */
+	bool GetTitle(const std::string& filename, RPG::SaveTitle& title);
+
+	/**
+	 * Looks up a cached title. Use ReadTitle and StoreTitle on a miss.
+	 *
+	 * @param filename path to the savegame
+	 * @param title filled with the title of the savegame
+	 * @param corrupted set when the savegame is corrupted
+	 * @return whether the title was cached
+	 */
+	bool FindTitle(const std::string& filename, RPG::SaveTitle& title, bool& corrupted);
+
+	/**
+	 * Reads the title of a savegame without using the cache.
+	 * This function is safe to call from worker threads, the savegames
+	 * are parsed one at a time.
+	 *
+	 * @param filename path to the savegame
+	 * @param title filled with the title of the savegame
+	 * @param stamp filled with the stamp of the file before it was read
+	 * @return false when the savegame is corrupted
+	 */
+	bool ReadTitle(const std::string& filename, RPG::SaveTitle& title, FileStamp& stamp);
+
+	/**
+	 * Adds a title to the cache. Call Flush afterwards.
+	 *
+	 * @param filename path to the savegame
+	 * @param stamp stamp returned by ReadTitle
+	 * @param title title of the savegame
+	 * @param corrupted whether the savegame is corrupted
+	 */
+	void StoreTitle(const std::string& filename, const FileStamp& stamp, const RPG::SaveTitle& title, bool corrupted);
+
+	/**
+	 * Writes changed titles to the cache path.
+	 */
+	void Flush();
+
+	/**
+	 * Loads a savegame.
+	 *
+	 * @param filename path to the savegame
+	 * @return savegame or null on error (see LcfReader::GetError)
+	 */
+	std::unique_ptr<RPG::Save> Load(const std::string& filename);
+
+	/**
+	 * Writes a savegame and keeps it as snapshot.
+	 *
+	 * @param filename path to the savegame
+	 * @param save savegame to write
+	 * @return whether writing succeeded
+	 */
+	bool Save(const std::string& filename, const RPG::Save& save);
+
+	/**
+	 * Drops the snapshot and all cached titles. The titles stored in the
+	 * cache path are kept.
+	 */
+	void Clear();
+}
+
+#endif
@@ -19,9 +19,11 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include "audio_stats.h"
 #include "baseui.h"
 #include "cache.h"
 #include "input.h"
+#include "memory_stats.h"
 #include "game_variables.h"
 #include "game_switches.h"
 #include "game_map.h"
@@ -46,6 +48,8 @@ void Scene_Debug::Start() {
 	CreateRangeWindow();
 	CreateVarListWindow();
 	CreateNumberInputWindow();
+	CreateAudioStatsWindow();
+	CreateMemoryStatsWindow();
 
 	range_window->SetActive(true);
 	var_window->SetActive(false);
@@ -89,6 +93,14 @@ void Scene_Debug::Update() {
 					case 1:
 						Scene::Push(std::make_shared<Scene_Load>());
 						break;
+					case 2:
+						AudioStats::Dump();
+						CreateAudioStatsWindow();
+						break;
+					case 3:
+						MemoryStats::Dump();
+						CreateMemoryStatsWindow();
+						break;
 					default:
 						break;
 				}
@@ -165,6 +177,18 @@ void Scene_Debug::Update() {
 	}
 
 	var_window->SetVisible(current_var_type != TypeGeneral);
+
+	bool show_audio = current_var_type == TypeGeneral && range_window->GetIndex() == 2;
+	if (show_audio && Player::GetFrames() % 60 == 0) {
+		CreateAudioStatsWindow();
+	}
+	audiostats_window->SetVisible(show_audio);
+
+	bool show_memory = current_var_type == TypeGeneral && range_window->GetIndex() == 3;
+	if (show_memory && Player::GetFrames() % 60 == 0) {
+		CreateMemoryStatsWindow();
+	}
+	memorystats_window->SetVisible(show_memory);
 }
 
 void Scene_Debug::CreateRangeWindow() {
@@ -184,7 +208,9 @@ void Scene_Debug::UpdateRangeListWindow() {
 			current_var_type != TypeInt) {
 		range_window->SetItemText(0, "Save");
 		range_window->SetItemText(1, "Load");
-		for (int i = 2; i < 10; i++){
+		range_window->SetItemText(2, "Audio");
+		range_window->SetItemText(3, "Memory");
+		for (int i = 4; i < 10; i++){
 			range_window->SetItemText(i, "");
 		}
 		return;
@@ -225,6 +251,28 @@ void Scene_Debug::CreateNumberInputWindow() {
 	numberinput_window->SetShowOperator(true);
 }
 
+void Scene_Debug::CreateAudioStatsWindow() {
+	bool visible = audiostats_window && audiostats_window->GetVisible();
+
+	audiostats_window.reset(new Window_Command(AudioStats::GetSummary(), 224));
+	audiostats_window->SetX(range_window->GetWidth());
+	audiostats_window->SetY(range_window->GetY());
+	audiostats_window->SetIndex(-1);
+	audiostats_window->SetActive(false);
+	audiostats_window->SetVisible(visible);
+}
+
+void Scene_Debug::CreateMemoryStatsWindow() {
+	bool visible = memorystats_window && memorystats_window->GetVisible();
+
+	memorystats_window.reset(new Window_Command(MemoryStats::GetSummary(), 224));
+	memorystats_window->SetX(range_window->GetWidth());
+	memorystats_window->SetY(range_window->GetY());
+	memorystats_window->SetIndex(-1);
+	memorystats_window->SetActive(false);
+	memorystats_window->SetVisible(visible);
+}
+
 int Scene_Debug::GetIndex() {
 	return (range_page * 100 + range_index * 10 + var_window->GetIndex() + 1);
 }
@@ -84,12 +84,22 @@ private:
 	/** Creates number input window. */
 	void CreateNumberInputWindow();
 
+	/** Creates or refreshes the audio statistics window. */
+	void CreateAudioStatsWindow();
+
+	/** Creates or refreshes the memory statistics window. */
+	void CreateMemoryStatsWindow();
+
 	/** Displays a range selection for current var type. */
 	std::unique_ptr<Window_Command> range_window;
 	/** Displays the vars inside the current range. */
 	std::unique_ptr<Window_VarList> var_window;
 	/** Number Editor. */
 	std::unique_ptr<Window_NumberInput> numberinput_window;
+	/** Displays the audio statistics. */
+	std::unique_ptr<Window_Command> audiostats_window;
+	/** Displays the memory statistics. */
+	std::unique_ptr<Window_Command> memorystats_window;
 };
 
 #endif
@@ -25,9 +25,10 @@
 #include "game_system.h"
 #include "game_party.h"
 #include "input.h"
-#include "lsd_reader.h"
 #include "player.h"
-#include "rpg_save.h"
+#include "rpg_savetitle.h"
+#include "save_cache.h"
+#include "worker_pool.h"
 #include "scene_file.h"
 #include "bitmap.h"
 #include "reader_util.h"
@@ -50,6 +51,7 @@ void Scene_File::Start() {
 		std::shared_ptr<Window_SaveFile>
 			w(new Window_SaveFile(0, 40 + i * 64, SCREEN_TARGET_WIDTH, 64));
 		w->SetIndex(i);
+		file_windows.push_back(w);
 
 		// Try to access file
 		std::stringstream ss;
@@ -58,55 +60,21 @@ void Scene_File::Start() {
 		std::string file = FileFinder::FindDefault(*tree, ss.str());
 
 		if (!file.empty()) {
-			// File found
-			std::unique_ptr<RPG::Save> savegame =
-				LSD_Reader::Load(file, Player::encoding);
-
-			if (savegame.get())	{
-				std::vector<std::pair<int, std::string> > party;
-
-				// When a face_name is empty the party list ends
-				int party_size =
-					savegame->title.face1_name.empty() ? 0 :
-					savegame->title.face2_name.empty() ? 1 :
-					savegame->title.face3_name.empty() ? 2 :
-					savegame->title.face4_name.empty() ? 3 : 4;
-
-				party.resize(party_size);
-
-				switch (party_size) {
-					case 4:
-						party[3].first = savegame->title.face4_id;
-						party[3].second = savegame->title.face4_name;
-					case 3:
-						party[2].first = savegame->title.face3_id;
-						party[2].second = savegame->title.face3_name;
-					case 2:
-						party[1].first = savegame->title.face2_id;
-						party[1].second = savegame->title.face2_name;
-					case 1:
-						party[0].first = savegame->title.face1_id;
-						party[0].second = savegame->title.face1_name;
-						break;
-					default:;
-				}
-
-				w->SetParty(party, savegame->title.hero_name, savegame->title.hero_hp,
-					savegame->title.hero_level);
-				w->SetHasSave(true);
+			// File found, the title is usually cached. Otherwise the savegame
+			// is parsed in the background and the slot shows a placeholder.
+			RPG::SaveTitle title;
+			bool corrupted;
 
-				if (savegame->title.timestamp > latest_time) {
-					latest_time = savegame->title.timestamp;
-					latest_slot = i;
-				}
+			if (SaveCache::FindTitle(file, title, corrupted)) {
+				SetSlot(i, *w, title, corrupted);
 			} else {
-				w->SetCorrupted(true);
+				w->SetHasSave(true);
+				w->SetLoading(true);
+				LoadSlot(i, file);
 			}
 		}
 
 		w->Refresh();
-
-		file_windows.push_back(w);
 	}
 
 	index = latest_slot;
@@ -114,6 +82,84 @@ void Scene_File::Start() {
 	Refresh();
 }
 
+void Scene_File::LoadSlot(int slot, const std::string& file) {
+	if (!binding) {
+		binding = std::make_shared<int>();
+	}
+	++pending_slots;
+
+	struct Result {
+		RPG::SaveTitle title;
+		SaveCache::FileStamp stamp;
+		bool corrupted;
+	};
+	std::shared_ptr<Result> result = std::make_shared<Result>();
+
+	WorkerPool::Run([result, file]() {
+		result->corrupted = !SaveCache::ReadTitle(file, result->title, result->stamp);
+	}, [this, result, slot, file]() {
+		SaveCache::StoreTitle(file, result->stamp, result->title, result->corrupted);
+		if (--pending_slots == 0) {
+			SaveCache::Flush();
+		}
+
+		Window_SaveFile& w = *file_windows[slot];
+		w.SetLoading(false);
+		SetSlot(slot, w, result->title, result->corrupted);
+		w.Refresh();
+	}, binding);
+}
+
+void Scene_File::SetSlot(int slot, Window_SaveFile& w, const RPG::SaveTitle& title, bool corrupted) {
+	if (corrupted) {
+		w.SetCorrupted(true);
+		return;
+	}
+
+	std::vector<std::pair<int, std::string> > party;
+
+	// When a face_name is empty the party list ends
+	int party_size =
+		title.face1_name.empty() ? 0 :
+		title.face2_name.empty() ? 1 :
+		title.face3_name.empty() ? 2 :
+		title.face4_name.empty() ? 3 : 4;
+
+	party.resize(party_size);
+
+	switch (party_size) {
+		case 4:
+			party[3].first = title.face4_id;
+			party[3].second = title.face4_name;
+		case 3:
+			party[2].first = title.face3_id;
+			party[2].second = title.face3_name;
+		case 2:
+			party[1].first = title.face2_id;
+			party[1].second = title.face2_name;
+		case 1:
+			party[0].first = title.face1_id;
+			party[0].second = title.face1_name;
+			break;
+		default:;
+	}
+
+	w.SetParty(party, title.hero_name, title.hero_hp,
+		title.hero_level);
+	w.SetHasSave(true);
+
+	if (title.timestamp > latest_time) {
+		latest_time = title.timestamp;
+		latest_slot = slot;
+
+		// Follow the latest savegame until the cursor was moved
+		if (select_latest && !cursor_moved) {
+			index = latest_slot;
+			Refresh();
+		}
+	}
+}
+
 void Scene_File::Refresh() {
 	for (unsigned int i = 0; (size_t) i < file_windows.size(); i++) {
 		Window_SaveFile *w = file_windows[i].get();
@@ -176,6 +222,10 @@ void Scene_File::Update() {
 
 	//top_index = std::min(top_index, std::max(top_index, index - 3 + 1));
 
+	if (index != old_index) {
+		cursor_moved = true;
+	}
+
 	if (top_index != old_top_index || index != old_index)
 		Refresh();
 
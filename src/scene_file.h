@@ -24,6 +24,8 @@
 #include "filefinder.h"
 #include "window_help.h"
 #include "window_savefile.h"
+#include "worker_pool.h"
+#include "rpg_savetitle.h"
 
 /**
  * Base class used by the save and load scenes.
@@ -48,6 +50,25 @@ public:
 protected:
 	void Refresh();
 
+	/**
+	 * Reads the title of a savegame on a worker thread and shows it in the
+	 * slot afterwards.
+	 *
+	 * @param slot slot index
+	 * @param file path to the savegame
+	 */
+	void LoadSlot(int slot, const std::string& file);
+
+	/**
+	 * Shows the title of a savegame in a slot.
+	 *
+	 * @param slot slot index
+	 * @param w window of the slot
+	 * @param title title of the savegame
+	 * @param corrupted whether the savegame is corrupted
+	 */
+	void SetSlot(int slot, Window_SaveFile& w, const RPG::SaveTitle& title, bool corrupted);
+
 	unsigned int index;
 	unsigned int top_index;
 	std::unique_ptr<Window_Help> help_window;
@@ -58,6 +79,14 @@ protected:
 
 	double latest_time;
 	int latest_slot;
+
+	/** Whether the cursor starts at the latest savegame */
+	bool select_latest = true;
+	bool cursor_moved = false;
+
+	/** Slots that are still read in the background */
+	int pending_slots = 0;
+	WorkerBinding binding;
 };
 
 #endif
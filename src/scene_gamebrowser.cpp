@@ -21,6 +21,8 @@
 #include "cache.h"
 #include "game_system.h"
 #include "input.h"
+#include "map_cache.h"
+#include "save_cache.h"
 #include "player.h"
 #include "scene_title.h"
 #include "bitmap.h"
@@ -54,6 +56,8 @@ void Scene_GameBrowser::Continue() {
 
 	Cache::Clear();
 	AudioSeCache::Clear();
+	MapCache::Clear();
+	SaveCache::Clear();
 
 	Data::Clear();
 	Player::ResetGameObjects();
@@ -70,6 +74,12 @@ void Scene_GameBrowser::Update() {
 		return;
 	}
 
+	// Games are added while the directory is scanned
+	if (!games_enabled && gamelist_window->HasValidGames()) {
+		command_window->EnableItem(GameList);
+		games_enabled = true;
+	}
+
 	command_window->Update();
 	gamelist_window->Update();
 
@@ -96,8 +106,9 @@ void Scene_GameBrowser::CreateWindows() {
 	gamelist_window.reset(new Window_GameList(60, 32, SCREEN_TARGET_WIDTH - 60, SCREEN_TARGET_HEIGHT - 32));
 	gamelist_window->Refresh();
 
-	if (!gamelist_window->HasValidGames()) {
-		command_window->DisableItem(0);
+	games_enabled = gamelist_window->HasValidGames();
+	if (!games_enabled) {
+		command_window->DisableItem(GameList);
 	}
 
 	help_window.reset(new Window_Help(0, 0, SCREEN_TARGET_WIDTH, 32));
@@ -176,9 +187,6 @@ void Scene_GameBrowser::BootGame() {
 		browser_dir = Main_Data::GetProjectPath();
 	Main_Data::SetProjectPath(path);
 
-	std::shared_ptr<FileFinder::DirectoryTree> tree = FileFinder::CreateDirectoryTree(path);
-	FileFinder::SetDirectoryTree(tree);
-
 	Player::CreateGameObjects();
 
 	Scene::Push(std::make_shared<Scene_Title>());
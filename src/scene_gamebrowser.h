@@ -86,6 +86,9 @@ private:
 
 	bool game_loading = false;
 
+	/** Whether the Games command was enabled after games were found */
+	bool games_enabled = false;
+
 	int old_gamelist_index = 0;
 };
 
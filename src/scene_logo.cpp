@@ -20,6 +20,7 @@
 #include "async_handler.h"
 #include "bitmap.h"
 #include "filefinder.h"
+#include "game_loader.h"
 #include "input.h"
 #include "player.h"
 #include "scene_map.h"
@@ -33,12 +34,24 @@ Scene_Logo::Scene_Logo() :
 	type = Scene::Logo;
 }
 
+namespace {
+	constexpr int progress_width = 160;
+	constexpr int progress_height = 4;
+}
+
 void Scene_Logo::Start() {
 	logo.reset(new Sprite());
 	if (!Player::debug_flag) {
 		logo_img = Bitmap::Create(easyrpg_logo, sizeof(easyrpg_logo), false);
 		logo->SetBitmap(logo_img);
 	}
+
+	progress.reset(new Sprite());
+	progress->SetBitmap(Bitmap::Create(progress_width, progress_height, false));
+	progress->SetX((SCREEN_TARGET_WIDTH - progress_width) / 2);
+	progress->SetY(SCREEN_TARGET_HEIGHT - 24);
+	progress->SetZ(1);
+	progress->SetVisible(false);
 }
 
 void Scene_Logo::Update() {
@@ -68,20 +81,31 @@ void Scene_Logo::Update() {
 		}
 
 		if (FileFinder::IsValidProject(*tree)) {
-			FileFinder::SetDirectoryTree(FileFinder::CreateDirectoryTree(Main_Data::GetProjectPath()));
-			Player::CreateGameObjects();
+			loader.reset(new GameLoader([this](int finished, int total) {
+				DrawProgress(finished, total);
+			}));
+			DrawProgress(0, 1);
 			is_valid = true;
 		}
 	}
 
+	if (loader && !loader->IsFinished()) {
+		loader->Update();
+	}
+
 	++frame_counter;
 
 	if (Player::debug_flag ||
-		frame_counter == 60 ||
+		frame_counter >= 60 ||
 		Input::IsTriggered(Input::DECISION) ||
 		Input::IsTriggered(Input::CANCEL)) {
 
 		if (is_valid) {
+			// The logo stays until the game is loaded
+			if (!loader->IsFinished()) {
+				return;
+			}
+
 			Scene::Push(std::make_shared<Scene_Title>(), true);
 			if (Player::load_game_id > 0) {
 				std::stringstream ss;
@@ -98,6 +122,16 @@ void Scene_Logo::Update() {
 	}
 }
 
+void Scene_Logo::DrawProgress(int finished, int total) {
+	BitmapRef bitmap = progress->GetBitmap();
+	int width = progress_width * finished / total;
+
+	bitmap->FillRect(Rect(0, 0, progress_width, progress_height), Color(64, 64, 64, 255));
+	bitmap->FillRect(Rect(0, 0, width, progress_height), Color(255, 255, 255, 255));
+
+	progress->SetVisible(finished < total);
+}
+
 void Scene_Logo::OnIndexReady(FileRequestResult*) {
 	async_ready = true;
 
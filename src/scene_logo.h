@@ -23,10 +23,13 @@
 #include "scene.h"
 #include "sprite.h"
 #include "async_handler.h"
+#include "game_loader.h"
 
 /**
  * Scene Logo class.
  * Displays the shiny EasyRPG logo on startup and inititalizes the game.
+ * The game is loaded by a GameLoader while the logo is shown, a progress bar
+ * is displayed below the logo.
  * When the startup directory does not contain a game it loads the Game Browser
  * instead.
  */
@@ -46,6 +49,17 @@ private:
 	BitmapRef logo_img;
 	int frame_counter;
 
+	std::unique_ptr<GameLoader> loader;
+	std::unique_ptr<Sprite> progress;
+
+	/**
+	 * Redraws the progress bar, invoked by the loader.
+	 *
+	 * @param finished number of finished steps
+	 * @param total number of steps
+	 */
+	void DrawProgress(int finished, int total);
+
 	void OnIndexReady(FileRequestResult* result);
 	FileRequestBinding request_id;
 	bool async_ready = false;
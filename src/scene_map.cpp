@@ -40,6 +40,9 @@
 #include "input.h"
 #include "screen.h"
 #include "scene_load.h"
+#include "filefinder.h"
+#include "output.h"
+#include "save_cache.h"
 
 Scene_Map::Scene_Map(bool from_save) :
 	from_save(from_save) {
@@ -179,6 +182,14 @@ void Scene_Map::Update() {
 	}
 
 	if (!Main_Data::game_player->IsMoving()) {
+		if (Input::IsTriggered(Input::QUICK_SAVE)) {
+			QuickSave();
+		}
+		else if (Input::IsTriggered(Input::QUICK_LOAD)) {
+			QuickLoad();
+			return;
+		}
+
 		if (Game_Temp::menu_calling) {
 			CallMenu();
 			return;
@@ -288,6 +299,41 @@ void Scene_Map::CallLoad() {
 	Scene::Push(std::make_shared<Scene_Load>());
 }
 
+void Scene_Map::QuickSave() {
+	if (!Game_System::GetAllowSave()) {
+		Game_System::SePlay(Game_System::GetSystemSE(Game_System::SFX_Buzzer));
+		return;
+	}
+
+	std::shared_ptr<FileFinder::DirectoryTree> tree = FileFinder::CreateSaveDirectoryTree();
+	std::string filename = FileFinder::MakePath(tree->directory_path, SaveCache::QUICK_SAVE_NAME);
+
+	Output::Debug("Quick saving to %s", filename.c_str());
+
+	if (Scene_Save::Save(filename, 0)) {
+		Game_System::SePlay(Game_System::GetSystemSE(Game_System::SFX_Decision));
+	} else {
+		Game_System::SePlay(Game_System::GetSystemSE(Game_System::SFX_Buzzer));
+	}
+}
+
+void Scene_Map::QuickLoad() {
+	std::shared_ptr<FileFinder::DirectoryTree> tree = FileFinder::CreateSaveDirectoryTree();
+	std::string filename = FileFinder::FindDefault(*tree, SaveCache::QUICK_SAVE_NAME);
+
+	if (filename.empty()) {
+		Game_System::SePlay(Game_System::GetSystemSE(Game_System::SFX_Buzzer));
+		return;
+	}
+
+	Output::Debug("Quick loading %s", filename.c_str());
+
+	Game_System::SePlay(Game_System::GetSystemSE(Game_System::SFX_Decision));
+	Player::LoadSavegame(filename);
+
+	Scene::Push(std::make_shared<Scene_Map>(true), true);
+}
+
 void Scene_Map::CallDebug() {
 	if (Player::debug_flag) {
 		Scene::Push(std::make_shared<Scene_Debug>());
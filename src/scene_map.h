@@ -51,6 +51,12 @@ public:
 	void CallLoad();
 	void CallDebug();
 
+	/** Saves to the quick save file (see SaveCache). */
+	void QuickSave();
+
+	/** Loads the quick save file, replacing this scene. */
+	void QuickLoad();
+
 	std::unique_ptr<Spriteset_Map> spriteset;
 
 private:
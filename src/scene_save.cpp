@@ -27,9 +27,9 @@
 #include "game_actor.h"
 #include "game_map.h"
 #include "game_party.h"
-#include "lsd_reader.h"
 #include "output.h"
 #include "player.h"
+#include "save_cache.h"
 #include "scene_save.h"
 #include "scene_file.h"
 #include "reader_util.h"
@@ -40,6 +40,7 @@ Scene_Save::Scene_Save() :
 }
 
 void Scene_Save::Start() {
+	select_latest = false;
 	Scene_File::Start();
 
 	for (int i = 0; i < 15; i++) {
@@ -58,6 +59,19 @@ void Scene_Save::Action(int index) {
 
 	Output::Debug("Saving to %s", ss.str().c_str());
 
+	std::string save_file = ss.str();
+	std::string filename = FileFinder::FindDefault(*tree, ss.str());
+
+	if (filename.empty()) {
+		filename = FileFinder::MakePath((*tree).directory_path, save_file);
+	}
+
+	Save(filename, index + 1);
+
+	Scene::Pop();
+}
+
+bool Scene_Save::Save(const std::string& filename, int slot_id) {
 	// TODO: Maybe find a better place to setup the save file?
 	RPG::SaveTitle title;
 
@@ -90,19 +104,14 @@ void Scene_Save::Action(int index) {
 
 	Main_Data::game_data.title = title;
 
-	Main_Data::game_data.system.save_slot = index + 1;
+	if (slot_id > 0) {
+		Main_Data::game_data.system.save_slot = slot_id;
+	}
 	Main_Data::game_data.system.save_count += 1;
 
 	Game_Map::PrepareSave();
 
-	std::string save_file = ss.str();
-	std::string filename = FileFinder::FindDefault(*tree, ss.str());
-
-	if (filename.empty()) {
-		filename = FileFinder::MakePath((*tree).directory_path, save_file);
-	}
-
-	LSD_Reader::Save(filename, Main_Data::game_data, Player::encoding);
+	bool result = SaveCache::Save(filename, Main_Data::game_data);
 
 #ifdef EMSCRIPTEN
 	// Save changed file system
@@ -112,7 +121,7 @@ void Scene_Save::Action(int index) {
 	);
 #endif
 
-	Scene::Pop();
+	return result;
 }
 
 bool Scene_Save::IsSlotValid(int) {
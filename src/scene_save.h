@@ -19,12 +19,13 @@
 #define _SCENE_SAVE_H_
 
 // Headers
+#include <string>
 #include <vector>
 #include "scene.h"
 #include "scene_file.h"
 
 /**
- * Scene_Item class.
+ * Scene_Save class.
  */
 class Scene_Save : public Scene_File {
 
@@ -38,6 +39,16 @@ public:
 
 	void Action(int index) override;
 	bool IsSlotValid(int index) override;
+
+	/**
+	 * Saves the current game state.
+	 *
+	 * @param filename path of the savegame
+	 * @param slot_id save slot (1-15) remembered in the savegame, 0 keeps the
+	 *                last one
+	 * @return whether saving succeeded
+	 */
+	static bool Save(const std::string& filename, int slot_id);
 };
 
 #endif
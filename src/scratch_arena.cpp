@@ -0,0 +1,106 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <vector>
+#include "scratch_arena.h"
+#include "system.h"
+
+#ifdef USE_SDL
+#  include <SDL.h>
+#endif
+
+namespace {
+	const size_t chunk_size = 256 * 1024;
+	/** Larger chunks are not kept after a frame that needed them */
+	const size_t max_chunk_size = 4 * 1024 * 1024;
+	const size_t alignment = 16;
+
+	struct Chunk {
+		std::unique_ptr<uint8_t[]> data;
+		size_t size;
+	};
+
+	bool initialized = false;
+#ifdef USE_SDL
+	SDL_threadID owner;
+#endif
+
+	std::vector<Chunk> chunks;
+	/** Offset of the next allocation in the last chunk */
+	size_t offset = 0;
+
+	void AddChunk(size_t size) {
+		chunks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+		offset = 0;
+	}
+}
+
+void ScratchArena::Init() {
+	initialized = true;
+#ifdef USE_SDL
+	owner = SDL_ThreadID();
+#endif
+}
+
+void ScratchArena::Quit() {
+	initialized = false;
+	chunks.clear();
+	offset = 0;
+}
+
+bool ScratchArena::IsAvailable() {
+#ifdef USE_SDL
+	return initialized && SDL_ThreadID() == owner;
+#else
+	// Without SDL there are no worker threads
+	return initialized;
+#endif
+}
+
+void* ScratchArena::Allocate(size_t bytes) {
+	bytes = (bytes + alignment - 1) & ~(alignment - 1);
+
+	if (chunks.empty() || offset + bytes > chunks.back().size) {
+		AddChunk(std::max(bytes, chunk_size));
+	}
+
+	void* ptr = chunks.back().data.get() + offset;
+	offset += bytes;
+	return ptr;
+}
+
+void ScratchArena::Release(void* ptr, size_t bytes) {
+	bytes = (bytes + alignment - 1) & ~(alignment - 1);
+
+	if (!chunks.empty() && static_cast<uint8_t*>(ptr) + bytes == chunks.back().data.get() + offset) {
+		offset -= bytes;
+	}
+}
+
+void ScratchArena::Reset() {
+	// A frame that needed more chunks gets one chunk large enough for all
+	if (chunks.size() > 1 || (!chunks.empty() && chunks.back().size > max_chunk_size)) {
+		size_t total = 0;
+		for (const Chunk& chunk : chunks) {
+			total += chunk.size;
+		}
+		chunks.clear();
+		AddChunk(std::min(total, max_chunk_size));
+	}
+	offset = 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_SCRATCH_ARENA_H
+#define EASYRPG_SCRATCH_ARENA_H
+
+// Headers
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+/**
+ * ScratchArena provides temporary memory for the current frame.
+ * Allocations are served from a few large chunks and are all freed at
+ * once by Reset at the end of Graphics::DrawFrame, so the temporary buffers
+ * of the blit and text functions don't cause heap churn.
+ * The arena belongs to the thread that called Init (the main thread),
+ * Buffer falls back to the heap on other threads.
+ */
+namespace ScratchArena {
+	/**
+	 * Binds the arena to the calling thread.
+	 */
+	void Init();
+
+	/**
+	 * Frees the memory of the arena.
+	 */
+	void Quit();
+
+	/**
+	 * Gets if the calling thread can use the arena.
+	 *
+	 * @return whether the arena is initialized and owned by this thread
+	 */
+	bool IsAvailable();
+
+	/**
+	 * Allocates memory that stays valid until the next Reset.
+	 * Must only be called when IsAvailable returns true.
+	 *
+	 * @param bytes size of the memory
+	 * @return memory aligned for any scalar type
+	 */
+	void* Allocate(size_t bytes);
+
+	/**
+	 * Returns memory before the frame ends. This only has an effect for
+	 * the most recent allocation, which makes nested buffers reuse memory.
+	 *
+	 * @param ptr memory returned by Allocate
+	 * @param bytes size passed to Allocate
+	 */
+	void Release(void* ptr, size_t bytes);
+
+	/**
+	 * Frees all allocations of the frame.
+	 */
+	void Reset();
+
+	/**
+	 * Temporary array of trivial values, taken from the arena when
+	 * available and from the heap otherwise.
+	 */
+	template <typename T>
+	class Buffer {
+		static_assert(std::is_trivial<T>::value, "Buffer only holds trivial types");
+	public:
+		explicit Buffer(size_t count) : count(count) {
+			if (IsAvailable()) {
+				items = static_cast<T*>(Allocate(count * sizeof(T)));
+			} else {
+				heap.reset(new T[count]);
+				items = heap.get();
+			}
+		}
+
+		Buffer(size_t count, T value) : Buffer(count) {
+			std::fill(items, items + count, value);
+		}
+
+		~Buffer() {
+			if (!heap) {
+				Release(items, count * sizeof(T));
+			}
+		}
+
+		Buffer(const Buffer&) = delete;
+		Buffer& operator=(const Buffer&) = delete;
+
+		T* data() { return items; }
+		size_t size() const { return count; }
+		T* begin() { return items; }
+		T* end() { return items + count; }
+		T& operator[](size_t i) { return items[i]; }
+
+	private:
+		size_t count;
+		T* items;
+		std::unique_ptr<T[]> heap;
+	};
+}
+
+#endif
@@ -194,6 +194,41 @@ uint32_t SdlUi::GetTicks() const {
 	return SDL_GetTicks();
 }
 
+uint64_t SdlUi::GetTicksMicro() const {
+#if SDL_MAJOR_VERSION==1
+	return BaseUi::GetTicksMicro();
+#else
+	static const uint64_t frequency = SDL_GetPerformanceFrequency();
+	uint64_t counter = SDL_GetPerformanceCounter();
+	return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+#endif
+}
+
+bool SdlUi::IsFrameRateSynchronized() const {
+#if SDL_MAJOR_VERSION==1
+	return false;
+#else
+	return frame_rate_synchronized;
+#endif
+}
+
+#if SDL_MAJOR_VERSION>1
+void SdlUi::UpdateFrameRateSynchronized() {
+	frame_rate_synchronized = false;
+	if (!vsync) {
+		return;
+	}
+
+	// Only a display at the game frame rate can pace the game
+	SDL_DisplayMode mode;
+	if (SDL_GetWindowDisplayMode(sdl_window, &mode) != 0) {
+		return;
+	}
+	int fps = Graphics::GetDefaultFps();
+	frame_rate_synchronized = mode.refresh_rate >= fps - 1 && mode.refresh_rate <= fps + 1;
+}
+#endif
+
 void SdlUi::Sleep(uint32_t time) {
 #ifndef EMSCRIPTEN
 	SDL_Delay(time);
@@ -434,12 +469,16 @@ bool SdlUi::RefreshDisplayMode() {
 		#if defined(__APPLE__) && defined(__MACH__)
 			uint32_t rendered_flag = SDL_RENDERER_PRESENTVSYNC;
 		#else
-			uint32_t rendered_flag = 0;
+			uint32_t rendered_flag = Player::vsync_flag ? SDL_RENDERER_PRESENTVSYNC : 0;
 		#endif
 
 		sdl_renderer = SDL_CreateRenderer(sdl_window, -1, rendered_flag);
 		if (!sdl_renderer)
 			return false;
+
+		SDL_RendererInfo renderer_info;
+		vsync = SDL_GetRendererInfo(sdl_renderer, &renderer_info) == 0 &&
+			(renderer_info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
 		SDL_RenderSetLogicalSize(sdl_renderer, SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT);
 
 		uint32_t const texture_format =
@@ -520,6 +559,8 @@ bool SdlUi::RefreshDisplayMode() {
 		main_surface = Bitmap::Create(
 			SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, Color(0, 0, 0, 255));
 	}
+
+	UpdateFrameRateSynchronized();
 #endif
 
 	return true;
@@ -623,6 +664,12 @@ void SdlUi::Blit2X(Bitmap const& src, SDL_Surface* dst_surf) {
 void SdlUi::ProcessEvent(SDL_Event &evnt) {
 	switch (evnt.type) {
 		case SDL_WINDOWEVENT:
+#if SDL_MAJOR_VERSION>1
+			// The window may now be on a display with another refresh rate
+			if (evnt.window.event == SDL_WINDOWEVENT_MOVED) {
+				UpdateFrameRateSynchronized();
+			}
+#endif
 			ProcessActiveEvent(evnt);
 			return;
 
@@ -76,7 +76,9 @@ public:
 	bool IsFullscreen() override;
 
 	uint32_t GetTicks() const override;
+	uint64_t GetTicksMicro() const override;
 	void Sleep(uint32_t time_milli) override;
+	bool IsFrameRateSynchronized() const override;
 
 #ifdef SUPPORT_AUDIO
 	AudioInterface& GetAudio() override;
@@ -95,6 +97,14 @@ private:
 	 */
 	bool RefreshDisplayMode();
 
+#if SDL_MAJOR_VERSION>1
+	/**
+	 * Checks whether vsync paces the game at its frame rate on the
+	 * display of the window. Called when the window or display changes.
+	 */
+	void UpdateFrameRateSynchronized();
+#endif
+
 	/**
 	 * Processes a SDL Event.
 	 */
@@ -154,6 +164,12 @@ private:
 	SDL_Texture* sdl_texture;
 	SDL_Window* sdl_window;
 	SDL_Renderer* sdl_renderer;
+
+	/** Whether the renderer waits for the vertical blank */
+	bool vsync = false;
+
+	/** Cached result of IsFrameRateSynchronized */
+	bool frame_rate_synchronized = false;
 #endif
 
 	std::unique_ptr<AudioInterface> audio_;
@@ -81,6 +81,12 @@ void Sprite::BlitScreen() {
 
 	Rect rect = src_rect_effect.GetSubRect(src_rect);
 
+	if (BlitScreenAnimated(rect)) {
+		bitmap_changed = false;
+		needs_refresh = false;
+		return;
+	}
+
 	BitmapRef draw_bitmap = Refresh(rect);
 
 	bitmap_changed = false;
@@ -104,6 +110,40 @@ void Sprite::BlitScreenIntern(Bitmap const& draw_bitmap,
 					 waver_effect_depth, waver_effect_phase);
 }
 
+bool Sprite::BlitScreenAnimated(Rect rect) {
+	if (zoom_x_effect != 1.0 || zoom_y_effect != 1.0 || angle_effect != 0.0 || waver_effect_depth != 0) {
+		return false;
+	}
+
+	bool no_effects = tone_effect == Tone() && flash_effect.alpha == 0 && !flipx_effect && !flipy_effect;
+	bool effects_changed = tone_effect != current_tone ||
+		flash_effect != current_flash ||
+		flipx_effect != current_flip_x ||
+		flipy_effect != current_flip_y;
+
+	// Unchanged effects are rendered once into bitmap_effects by Refresh
+	if (no_effects || !effects_changed) {
+		return false;
+	}
+
+	current_tone = tone_effect;
+	current_flash = flash_effect;
+	current_flip_x = flipx_effect;
+	current_flip_y = flipy_effect;
+	bitmap_effects_valid = false;
+
+	rect.Adjust(bitmap->GetWidth(), bitmap->GetHeight());
+	if (rect.IsEmpty()) {
+		return true;
+	}
+
+	BitmapRef dst = DisplayUi->GetDisplaySurface();
+	dst->ToneBlendFlipBlit(x - ox, y - oy, *bitmap, rect, tone_effect, flash_effect,
+		flipx_effect, flipy_effect, Opacity(opacity_top_effect, opacity_bottom_effect, bush_effect));
+
+	return true;
+}
+
 BitmapRef Sprite::Refresh(Rect& rect) {
 	if (zoom_x_effect != 1.0 && zoom_y_effect != 1.0 && angle_effect != 0.0 && waver_effect_depth != 0) {
 		// TODO: Out of bounds check adjustments for zoom, angle and waver
@@ -153,8 +193,10 @@ BitmapRef Sprite::Refresh(Rect& rect) {
 		bitmap_effects.reset();
 		}
 
-		if (!bitmap_effects)
+		if (!bitmap_effects) {
 			bitmap_effects = Bitmap::Create(bitmap->GetWidth(), bitmap->GetHeight(), true);
+			bitmap_effects->SetMemoryCategory(MemoryStats::Category_SpriteEffects);
+		}
 
 		bitmap_effects->Clear();
 		if (no_tone && no_flash)
@@ -290,7 +332,7 @@ int Sprite::GetZ() const {
 	return z;
 }
 void Sprite::SetZ(int nz) {
-	if (z != nz) Graphics::UpdateZCallback();
+	if (z != nz) Graphics::UpdateZCallback(this);
 	z = nz;
 }
 
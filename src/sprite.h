@@ -132,6 +132,16 @@ private:
 	bool current_flip_y;
 
 	void BlitScreen();
+
+	/**
+	 * Draws the sprite with ToneBlendFlipBlit when the tone, flash or flip
+	 * effects changed since the last frame. Re-rendering bitmap_effects
+	 * for every frame of a tint or flash transition is skipped this way.
+	 *
+	 * @param rect source rectangle
+	 * @return false when the sprite must be drawn by BlitScreenIntern
+	 */
+	bool BlitScreenAnimated(Rect rect);
 	void BlitScreenIntern(Bitmap const& draw_bitmap,
 							Rect const& src_rect, int opacity_split) const;
 	BitmapRef Refresh(Rect& rect);
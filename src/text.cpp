@@ -21,6 +21,7 @@
 #include "output.h"
 #include "utils.h"
 #include "bitmap.h"
+#include "bitmap_pool.h"
 #include "font.h"
 #include "text.h"
 #include "game_system.h"
@@ -48,9 +49,9 @@ void Text::Draw(Bitmap& dest, int x, int y, int color, std::string const& text,
 	dst_rect.width += 1; dst_rect.height += 1; // Need place for shadow
 	if (dst_rect.IsOutOfBounds(dest.GetWidth(), dest.GetHeight())) return;
 
-	BitmapRef text_surface; // Complete text will be on this surface
-	text_surface = Bitmap::Create(dst_rect.width, dst_rect.height, true);
-	text_surface->Clear();
+	// Complete text will be on this surface, it is cleared by the pool
+	BitmapRef text_surface = BitmapPool::Get(dst_rect.width, dst_rect.height, true);
+	text_surface->SetMemoryCategory(MemoryStats::Category_Text);
 
 	BitmapRef system = Cache::System();
 
@@ -95,16 +96,14 @@ void Text::Draw(Bitmap& dest, int x, int y, int color, std::string const& text,
 		}
 	}
 
-	BitmapRef text_bmp = Bitmap::Create(*text_surface, text_surface->GetRect());
-
 	Rect src_rect(0, 0, dst_rect.width, dst_rect.height);
 	int iy = dst_rect.y;
-	if (dst_rect.height > text_bmp->GetHeight()) {
-		iy += ((dst_rect.height - text_bmp->GetHeight()) / 2);
+	if (dst_rect.height > text_surface->GetHeight()) {
+		iy += ((dst_rect.height - text_surface->GetHeight()) / 2);
 	}
 	int ix = dst_rect.x;
 
-	dest.Blit(ix, iy, *text_bmp, src_rect, 255);
+	dest.Blit(ix, iy, *text_surface, src_rect, 255);
 }
 
 void Text::Draw(Bitmap& dest, int x, int y, Color color, std::string const& text) {
@@ -535,6 +535,7 @@ void TilemapLayer::GenerateAutotileD(short ID) {
 BitmapRef TilemapLayer::GenerateAutotiles(int count, const std::map<uint32_t, TileXY>& map) {
 	int rows = (count + TILES_PER_ROW - 1) / TILES_PER_ROW;
 	BitmapRef tiles = Bitmap::Create(TILES_PER_ROW * TILE_SIZE, rows * TILE_SIZE);
+	tiles->SetMemoryCategory(MemoryStats::Category_Tilemap);
 	tiles->Clear();
 	Rect rect(0, 0, TILE_SIZE/2, TILE_SIZE/2);
 
@@ -600,6 +601,7 @@ BitmapRef const& TilemapLayer::GetChipset() const {
 void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
 	chipset = nchipset;
 	chipset_effect = Bitmap::Create(chipset->width(), chipset->height());
+	chipset_effect->SetMemoryCategory(MemoryStats::Category_Tilemap);
 	chipset_tone_tiles.clear();
 
 	if (autotiles_ab_next != 0 && autotiles_d_screen != nullptr && layer == 0) {
@@ -608,6 +610,8 @@ void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
 
 		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
 		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
+		autotiles_ab_screen_effect->SetMemoryCategory(MemoryStats::Category_Tilemap);
+		autotiles_d_screen_effect->SetMemoryCategory(MemoryStats::Category_Tilemap);
 
 		autotiles_ab_screen_tone_tiles.clear();
 		autotiles_d_screen_tone_tiles.clear();
@@ -650,6 +654,8 @@ void TilemapLayer::SetMapData(const std::vector<short>& nmap_data) {
 
 		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
 		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
+		autotiles_ab_screen_effect->SetMemoryCategory(MemoryStats::Category_Tilemap);
+		autotiles_d_screen_effect->SetMemoryCategory(MemoryStats::Category_Tilemap);
 
 		autotiles_ab_screen_tone_tiles.clear();
 		autotiles_d_screen_tone_tiles.clear();
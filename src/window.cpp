@@ -24,6 +24,7 @@
 #include "util_macro.h"
 #include "window.h"
 #include "bitmap.h"
+#include "bitmap_pool.h"
 
 Window::Window():
 	type(TypeWindow),
@@ -190,7 +191,7 @@ void Window::Draw() {
 void Window::RefreshBackground() {
 	background_needs_refresh = false;
 
-	BitmapRef bitmap = Bitmap::Create(width, height, false);
+	BitmapRef bitmap = BitmapPool::Get(width, height, false);
 
 	if (stretch) {
 		bitmap->StretchBlit(*windowskin, Rect(0, 0, 32, 32), 255);
@@ -204,8 +205,8 @@ void Window::RefreshBackground() {
 void Window::RefreshFrame() {
 	frame_needs_refresh = false;
 
-	BitmapRef up_bitmap = Bitmap::Create(width, 8);
-	BitmapRef down_bitmap = Bitmap::Create(width, 8);
+	BitmapRef up_bitmap = BitmapPool::Get(width, 8);
+	BitmapRef down_bitmap = BitmapPool::Get(width, 8);
 
 	up_bitmap->Clear();
 	down_bitmap->Clear();
@@ -238,8 +239,8 @@ void Window::RefreshFrame() {
 	frame_down = down_bitmap;
 
 	if (height > 16) {
-		BitmapRef left_bitmap = Bitmap::Create(8, height - 16);
-		BitmapRef right_bitmap = Bitmap::Create(8, height - 16);
+		BitmapRef left_bitmap = BitmapPool::Get(8, height - 16);
+		BitmapRef right_bitmap = BitmapPool::Get(8, height - 16);
 
 		left_bitmap->Clear();
 		right_bitmap->Clear();
@@ -268,8 +269,8 @@ void Window::RefreshCursor() {
 	int cw = cursor_rect.width;
 	int ch = cursor_rect.height;
 
-	BitmapRef cursor1_bitmap = Bitmap::Create(cw, ch);
-	BitmapRef cursor2_bitmap = Bitmap::Create(cw, ch);
+	BitmapRef cursor1_bitmap = BitmapPool::Get(cw, ch);
+	BitmapRef cursor2_bitmap = BitmapPool::Get(cw, ch);
 
 	cursor1_bitmap->Clear();
 	cursor2_bitmap->Clear();
@@ -450,7 +451,7 @@ int Window::GetZ() const {
 	return z;
 }
 void Window::SetZ(int nz) {
-	if (z != nz) Graphics::UpdateZCallback();
+	if (z != nz) Graphics::UpdateZCallback(this);
 	z = nz;
 }
 
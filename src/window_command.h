@@ -52,6 +52,13 @@ public:
 	 */
 	void DisableItem(int index);
 
+	/**
+	 * Enables a command that was disabled before.
+	 *
+	 * @param index command index.
+	 */
+	void EnableItem(int index);
+
 	/**
 	 * Replaces the text of an item.
 	 *
@@ -16,12 +16,32 @@
  */
 
 // Headers
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 #include "window_gamelist.h"
 #include "game_party.h"
 #include "bitmap.h"
 #include "font.h"
+#include "main_data.h"
+#include "output.h"
+#include "utils.h"
+
+namespace {
+	/** Number of directories validated by one worker task */
+	constexpr size_t SCAN_CHUNK_SIZE = 8;
+
+	const char* const CACHE_HEADER = "EasyRPG Player game list 1";
+
+	bool CompareNames(const std::string& s, const std::string& s2) {
+		return strcmp(Utils::LowerCase(s).c_str(), Utils::LowerCase(s2).c_str()) < 0;
+	}
+}
 
 Window_GameList::Window_GameList(int ix, int iy, int iwidth, int iheight) :
 	Window_Selectable(ix, iy, iwidth, iheight) {
@@ -29,23 +49,135 @@ Window_GameList::Window_GameList(int ix, int iy, int iwidth, int iheight) :
 }
 
 void Window_GameList::Refresh() {
-	tree = FileFinder::CreateDirectoryTree(Main_Data::GetProjectPath(), false);
+	base_path = Main_Data::GetProjectPath();
 	game_directories.clear();
+	item_max = 0;
 
-	// Find valid game diectories
-	for (auto dir : tree.get()->directories) {
-		std::shared_ptr<FileFinder::DirectoryTree> subtree = FileFinder::CreateDirectoryTree(FileFinder::MakePath(Main_Data::GetProjectPath(), dir.second), false);
-		if (FileFinder::IsValidProject(*subtree)) {
-			game_directories.push_back(dir.second);
+	// Results of a previous scan are dropped
+	scan_binding = std::make_shared<int>();
+	scanning = true;
+	pending_scans = 0;
+
+	LoadCache();
+	DrawList();
+
+	auto dirs = std::make_shared<std::vector<std::pair<std::string, int64_t>>>();
+	std::string path = base_path;
+
+	WorkerPool::Run([dirs, path]() {
+		FileFinder::Directory mem = FileFinder::GetDirectoryMembers(path, FileFinder::DIRECTORIES);
+		for (auto& dir : mem.directories) {
+			int64_t mtime = FileFinder::GetDirectoryModificationTime(FileFinder::MakePath(path, dir.second));
+			dirs->push_back(std::make_pair(dir.second, mtime));
+		}
+	}, [this, dirs]() {
+		OnDirectoriesListed(*dirs);
+	}, scan_binding);
+}
+
+bool Window_GameList::IsScanning() const {
+	return scanning;
+}
+
+void Window_GameList::OnDirectoriesListed(const std::vector<std::pair<std::string, int64_t>>& dirs) {
+	// Changes within the same second would go unnoticed
+	int64_t now = (int64_t) time(nullptr);
+
+	Cache listed;
+	std::vector<std::string> games;
+	std::vector<std::pair<std::string, int64_t>> changed;
+
+	for (auto& dir : dirs) {
+		auto it = cache.find(dir.first);
+		if (it != cache.end() && dir.second >= 0 && it->second.mtime == dir.second) {
+			listed.insert(*it);
+			if (it->second.valid) {
+				games.push_back(dir.first);
+			}
+		} else {
+			changed.push_back(dir);
 		}
 	}
-	
-	// Sort game list in place
-	std::sort(game_directories.begin(), game_directories.end(),
-			  [](const std::string& s, const std::string& s2) {
-				  return strcmp(Utils::LowerCase(s).c_str(), Utils::LowerCase(s2).c_str()) <= 0;
-			  });
-	
+
+	// Directories that were removed are dropped from the cache
+	cache_dirty |= listed.size() != cache.size();
+	cache.swap(listed);
+
+	AddGames(games);
+
+	// Held until all tasks are queued, tasks may finish synchronously
+	++pending_scans;
+
+	std::string path = base_path;
+	for (size_t i = 0; i < changed.size(); i += SCAN_CHUNK_SIZE) {
+		auto chunk = std::make_shared<std::vector<std::pair<std::string, int64_t>>>(
+			changed.begin() + i, changed.begin() + std::min(i + SCAN_CHUNK_SIZE, changed.size()));
+		auto valid = std::make_shared<std::vector<bool>>();
+
+		++pending_scans;
+		WorkerPool::Run([chunk, valid, path]() {
+			for (auto& dir : *chunk) {
+				valid->push_back(FileFinder::IsValidProjectDirectory(FileFinder::MakePath(path, dir.first)));
+			}
+		}, [this, chunk, valid, now]() {
+			std::vector<std::string> games;
+			for (size_t i = 0; i < chunk->size(); ++i) {
+				const std::string& name = (*chunk)[i].first;
+				int64_t mtime = (*chunk)[i].second;
+
+				if (mtime >= 0 && now - mtime >= 2) {
+					cache[name] = CacheEntry { mtime, (*valid)[i] };
+					cache_dirty = true;
+				}
+				if ((*valid)[i]) {
+					games.push_back(name);
+				}
+			}
+
+			AddGames(games);
+
+			if (--pending_scans == 0) {
+				OnScanFinished();
+			}
+		}, scan_binding);
+	}
+
+	if (--pending_scans == 0) {
+		OnScanFinished();
+	}
+}
+
+void Window_GameList::OnScanFinished() {
+	scanning = false;
+	SaveCache();
+	DrawList();
+}
+
+void Window_GameList::AddGames(const std::vector<std::string>& games) {
+	if (games.empty()) {
+		return;
+	}
+
+	// Keep the cursor on the selected game
+	std::string selected;
+	if (index >= 0 && index < (int) game_directories.size()) {
+		selected = game_directories[index];
+	}
+
+	for (auto& game : games) {
+		game_directories.insert(std::upper_bound(game_directories.begin(),
+			game_directories.end(), game, CompareNames), game);
+	}
+
+	if (!selected.empty()) {
+		index = std::lower_bound(game_directories.begin(), game_directories.end(),
+			selected, CompareNames) - game_directories.begin();
+	}
+
+	DrawList();
+}
+
+void Window_GameList::DrawList() {
 	if (HasValidGames()) {
 		item_max = game_directories.size();
 
@@ -56,11 +188,102 @@ void Window_GameList::Refresh() {
 		for (int i = 0; i < item_max; ++i) {
 			DrawItem(i);
 		}
+
+		if (index >= 0) {
+			UpdateCursorRect();
+		}
 	}
 	else {
+		item_max = 0;
+
 		SetContents(Bitmap::Create(width - 16, height - 16));
 
-		DrawErrorText();
+		if (scanning) {
+			contents->TextDraw(0, 2, Font::ColorDefault, "Searching for games...");
+		} else {
+			DrawErrorText();
+		}
+	}
+}
+
+std::string Window_GameList::GetCacheFile() const {
+	// FNV-1a hash of the directory path
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : base_path) {
+		hash ^= (uint8_t) c;
+		hash *= 1099511628211ULL;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "games_%08x%08x.txt",
+		(unsigned)(hash >> 32), (unsigned)(hash & 0xFFFFFFFF));
+	return FileFinder::MakePath(Main_Data::GetCachePath(), name);
+}
+
+/*
+ * Game list format, one line per entry after the header and the path:
+ *  mtime valid name: directory with modification time and whether it
+ *                    contains a game (0 or 1)
+ */
+void Window_GameList::LoadCache() {
+	cache.clear();
+	cache_dirty = false;
+
+	if (Main_Data::GetCachePath().empty()) {
+		return;
+	}
+
+	std::shared_ptr<std::fstream> in = FileFinder::openUTF8(GetCacheFile(), std::ios_base::in | std::ios_base::binary);
+	if (!in) {
+		return;
+	}
+
+	std::string line;
+	if (!std::getline(*in, line) || line != CACHE_HEADER ||
+		!std::getline(*in, line) || line != base_path) {
+		return;
+	}
+
+	while (std::getline(*in, line)) {
+		size_t tab = line.find('\t');
+		size_t tab2 = tab == std::string::npos ? tab : line.find('\t', tab + 1);
+		if (tab2 == std::string::npos) {
+			continue;
+		}
+
+		CacheEntry entry;
+		entry.mtime = atoll(line.substr(0, tab).c_str());
+		entry.valid = line.substr(tab + 1, tab2 - tab - 1) == "1";
+		cache[line.substr(tab2 + 1)] = entry;
+	}
+}
+
+void Window_GameList::SaveCache() {
+	if (!cache_dirty || Main_Data::GetCachePath().empty()) {
+		return;
+	}
+	cache_dirty = false;
+
+	std::string cache_file = GetCacheFile();
+	std::string tmp_file = cache_file + ".tmp";
+	std::shared_ptr<std::fstream> out = FileFinder::openUTF8(tmp_file,
+		std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if (!out) {
+		Output::Debug("Could not write game list %s", cache_file.c_str());
+		return;
+	}
+
+	*out << CACHE_HEADER << "\n" << base_path << "\n";
+	for (auto& i : cache) {
+		*out << i.second.mtime << "\t" << (i.second.valid ? 1 : 0) << "\t" << i.first << "\n";
+	}
+
+	bool ok = out->good();
+	out.reset();
+
+	std::remove(cache_file.c_str());
+	if (!ok || std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+		std::remove(tmp_file.c_str());
 	}
 }
 
@@ -114,5 +337,5 @@ bool Window_GameList::HasValidGames()
 }
 
 std::string Window_GameList::GetGamePath() {
-	return FileFinder::MakePath(tree.get()->directory_path, game_directories[GetIndex()]);
+	return FileFinder::MakePath(base_path, game_directories[GetIndex()]);
 }
@@ -19,10 +19,13 @@
 #define _WINDOW_GAMELIST_H_
 
 // Headers
+#include <cstdint>
+#include <map>
 #include <vector>
 #include "window_help.h"
 #include "window_selectable.h"
 #include "filefinder.h"
+#include "worker_pool.h"
 
 /**
  * Window_GameList class.
@@ -37,9 +40,18 @@ public:
 
 	/**
 	 * Refreshes the item list.
+	 * The directory is scanned on worker threads, games are added to the
+	 * list while the scan is running (see IsScanning).
+	 * Which directories contain a game is cached by their modification time
+	 * in the cache directory.
 	 */
 	void Refresh();
 
+	/**
+	 * @return true while the game directory is scanned
+	 */
+	bool IsScanning() const;
+
 	/**
 	 * Draws an item together with the quantity.
 	 *
@@ -60,8 +72,46 @@ public:
 	std::string GetGamePath();
 
 private:
-	std::shared_ptr<FileFinder::DirectoryTree> tree;
+	struct CacheEntry {
+		int64_t mtime;
+		bool valid;
+	};
+	using Cache = std::map<std::string, CacheEntry>;
+
+	/**
+	 * Adds the cached games and queues the validation of all directories
+	 * that are new or changed.
+	 *
+	 * @param dirs sub directories of the scanned path with modification time
+	 */
+	void OnDirectoriesListed(const std::vector<std::pair<std::string, int64_t>>& dirs);
+
+	/**
+	 * Called when all directories are validated.
+	 */
+	void OnScanFinished();
+
+	/**
+	 * Adds games to the list and redraws it.
+	 *
+	 * @param games game directory names
+	 */
+	void AddGames(const std::vector<std::string>& games);
+
+	void DrawList();
+
+	std::string GetCacheFile() const;
+	void LoadCache();
+	void SaveCache();
+
+	std::string base_path;
 	std::vector<std::string> game_directories;
+
+	Cache cache;
+	bool cache_dirty = false;
+	bool scanning = false;
+	int pending_scans = 0;
+	WorkerBinding scan_binding;
 };
 
 #endif
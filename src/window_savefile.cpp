@@ -27,7 +27,7 @@
 
 Window_SaveFile::Window_SaveFile(int ix, int iy, int iwidth, int iheight) :
 	Window_Base(ix, iy, iwidth, iheight),
-	index(0), hero_hp(0), hero_level(0), corrupted(false), has_save(false) {
+	index(0), hero_hp(0), hero_level(0), corrupted(false), has_save(false), loading(false) {
 
 	SetContents(Bitmap::Create(width - 8, height - 16));
 	SetZ(9999);
@@ -64,8 +64,12 @@ void Window_SaveFile::SetCorrupted(bool corrupted) {
 	this->corrupted = corrupted;
 }
 
+void Window_SaveFile::SetLoading(bool loading) {
+	this->loading = loading;
+}
+
 bool Window_SaveFile::IsValid() {
-	return has_save && !corrupted;
+	return has_save && !corrupted && !loading;
 }
 
 void Window_SaveFile::SetHasSave(bool valid) {
@@ -79,6 +83,11 @@ void Window_SaveFile::Refresh() {
 	out << Data::terms.file << std::setw(2) << std::setfill(' ') << index + 1;
 	contents->TextDraw(4, 2, has_save ? Font::ColorDefault : Font::ColorDisabled, out.str());
 
+	if (loading) {
+		contents->TextDraw(8, 16 + 2, Font::ColorDisabled, "...");
+		return;
+	}
+
 	if (corrupted) {
 		contents->TextDraw(4, 16 + 2, Font::ColorKnockout, "Savegame corrupted");
 		return;
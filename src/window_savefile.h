@@ -75,6 +75,12 @@ public:
 	 */
 	void SetCorrupted(bool corrupted);
 
+	/**
+	 * Sets if the savegame is still being read.
+	 * Displays a placeholder in that case.
+	 */
+	void SetLoading(bool loading);
+
 	void Update() override;
 
 protected:
@@ -87,6 +93,7 @@ protected:
 	int hero_level;
 	bool corrupted;
 	bool has_save;
+	bool loading;
 };
 
 #endif
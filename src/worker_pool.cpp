@@ -0,0 +1,227 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <vector>
+#include "system.h"
+#include "worker_pool.h"
+
+#ifdef USE_SDL
+#  include <SDL.h>
+#endif
+
+namespace {
+	struct Job {
+		int id;
+		std::function<void()> task;
+		std::function<void()> done;
+		WorkerBindingWeak binding;
+	};
+
+	int next_id = 0;
+
+	void Finish(Job& job) {
+		if (job.done && job.binding.lock()) {
+			job.done();
+		}
+	}
+
+#ifdef USE_SDL
+	const int max_workers = 4;
+
+	std::vector<SDL_Thread*> workers;
+	SDL_mutex* mutex = nullptr;
+	SDL_cond* job_cond = nullptr;
+	SDL_cond* finished_cond = nullptr;
+	std::deque<Job> jobs;
+	std::vector<Job> finished;
+	// Ids of the queued and running jobs
+	std::set<int> pending;
+	bool quit = false;
+
+	int WorkerThread(void*) {
+		for (;;) {
+			SDL_LockMutex(mutex);
+			while (jobs.empty() && !quit) {
+				SDL_CondWait(job_cond, mutex);
+			}
+			if (quit) {
+				SDL_UnlockMutex(mutex);
+				return 0;
+			}
+			Job job = std::move(jobs.front());
+			jobs.pop_front();
+			SDL_UnlockMutex(mutex);
+
+			job.task();
+
+			SDL_LockMutex(mutex);
+			pending.erase(job.id);
+			finished.push_back(std::move(job));
+			SDL_CondBroadcast(finished_cond);
+			SDL_UnlockMutex(mutex);
+		}
+	}
+
+	/** @return whether worker threads are available */
+	bool StartWorkers() {
+		if (!workers.empty()) {
+			return true;
+		}
+
+		mutex = SDL_CreateMutex();
+		job_cond = SDL_CreateCond();
+		finished_cond = SDL_CreateCond();
+		quit = false;
+
+		// Leave one core to the main thread
+		int count = std::min(std::max(SDL_GetCPUCount() - 1, 1), max_workers);
+		for (int i = 0; i < count; ++i) {
+#if SDL_MAJOR_VERSION>1
+			SDL_Thread* thread = SDL_CreateThread(WorkerThread, "Worker", nullptr);
+#else
+			SDL_Thread* thread = SDL_CreateThread(WorkerThread, nullptr);
+#endif
+			if (!thread) {
+				break;
+			}
+			workers.push_back(thread);
+		}
+
+		if (workers.empty()) {
+			SDL_DestroyCond(finished_cond);
+			SDL_DestroyCond(job_cond);
+			SDL_DestroyMutex(mutex);
+			finished_cond = nullptr;
+			job_cond = nullptr;
+			mutex = nullptr;
+			return false;
+		}
+		return true;
+	}
+#endif
+}
+
+int WorkerPool::Run(std::function<void()> task, std::function<void()> done, const WorkerBindingWeak& binding) {
+	Job job = { ++next_id, std::move(task), std::move(done), binding };
+
+#ifdef USE_SDL
+	if (StartWorkers()) {
+		SDL_LockMutex(mutex);
+		pending.insert(job.id);
+		jobs.push_back(std::move(job));
+		SDL_CondSignal(job_cond);
+		SDL_UnlockMutex(mutex);
+		return next_id;
+	}
+#endif
+
+	job.task();
+	Finish(job);
+	return next_id;
+}
+
+void WorkerPool::Update() {
+#ifdef USE_SDL
+	if (workers.empty()) {
+		return;
+	}
+
+	std::vector<Job> done;
+	SDL_LockMutex(mutex);
+	done.swap(finished);
+	SDL_UnlockMutex(mutex);
+
+	for (Job& job : done) {
+		Finish(job);
+	}
+#endif
+}
+
+void WorkerPool::Wait(int id) {
+#ifdef USE_SDL
+	if (workers.empty()) {
+		return;
+	}
+
+	SDL_LockMutex(mutex);
+	while (pending.count(id) > 0) {
+		SDL_CondWait(finished_cond, mutex);
+	}
+
+	// Not found when Update already handled it
+	auto it = std::find_if(finished.begin(), finished.end(), [id](const Job& job) { return job.id == id; });
+	if (it == finished.end()) {
+		SDL_UnlockMutex(mutex);
+		return;
+	}
+	Job job = std::move(*it);
+	finished.erase(it);
+	SDL_UnlockMutex(mutex);
+
+	Finish(job);
+#else
+	(void)id;
+#endif
+}
+
+void WorkerPool::WaitAll() {
+#ifdef USE_SDL
+	if (workers.empty()) {
+		return;
+	}
+
+	SDL_LockMutex(mutex);
+	while (!pending.empty()) {
+		SDL_CondWait(finished_cond, mutex);
+	}
+	SDL_UnlockMutex(mutex);
+
+	Update();
+#endif
+}
+
+void WorkerPool::Quit() {
+#ifdef USE_SDL
+	if (workers.empty()) {
+		return;
+	}
+
+	SDL_LockMutex(mutex);
+	quit = true;
+	jobs.clear();
+	SDL_CondBroadcast(job_cond);
+	SDL_UnlockMutex(mutex);
+
+	for (SDL_Thread* thread : workers) {
+		SDL_WaitThread(thread, nullptr);
+	}
+	workers.clear();
+	finished.clear();
+	pending.clear();
+
+	SDL_DestroyCond(finished_cond);
+	SDL_DestroyCond(job_cond);
+	SDL_DestroyMutex(mutex);
+	finished_cond = nullptr;
+	job_cond = nullptr;
+	mutex = nullptr;
+#endif
+}
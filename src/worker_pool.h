@@ -0,0 +1,77 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EASYRPG_WORKER_POOL_H
+#define EASYRPG_WORKER_POOL_H
+
+// Headers
+#include <functional>
+#include <memory>
+
+using WorkerBinding = std::shared_ptr<int>;
+using WorkerBindingWeak = std::weak_ptr<int>;
+
+/**
+ * WorkerPool runs tasks on background threads, so slow IO and parsing
+ * doesn't block the main loop.
+ *
+ * A task must not touch state that is used by the main thread. Its results
+ * are handed over in the done handler, which is invoked on the main thread
+ * by Update. Like the handlers of AsyncHandler the done handler is only
+ * invoked while the caller holds a reference to the binding.
+ *
+ * On platforms without threads the task and the done handler run
+ * immediately when the task is queued.
+ */
+namespace WorkerPool {
+	/**
+	 * Queues a task.
+	 *
+	 * @param task invoked on a worker thread
+	 * @param done invoked on the main thread after task finished
+	 * @param binding done is skipped when the binding expired
+	 * @return id of the task, see Wait
+	 */
+	int Run(std::function<void()> task, std::function<void()> done, const WorkerBindingWeak& binding);
+
+	/**
+	 * Invokes the done handlers of finished tasks.
+	 * Called once per frame by the main loop.
+	 */
+	void Update();
+
+	/**
+	 * Returns when the task finished and its done handler was invoked.
+	 * The done handlers of other tasks are not invoked.
+	 *
+	 * @param id id returned by Run
+	 */
+	void Wait(int id);
+
+	/**
+	 * Returns when all queued tasks finished and their done handlers were
+	 * invoked.
+	 */
+	void WaitAll();
+
+	/**
+	 * Drops the queued tasks and stops the worker threads.
+	 */
+	void Quit();
+}
+
+#endif
@@ -0,0 +1,73 @@
+#include <cassert>
+#include <cstdlib>
+#include "frame_pacer.h"
+
+static const int64_t interval = 16000;
+
+static void OnTime() {
+	FramePacer pacer(interval, 3, 10);
+	pacer.Reset(0);
+
+	// Frame takes 4 ms, sleep for the rest of the slot
+	assert(pacer.BeginFrame(0));
+	assert(pacer.EndFrame(4000) == 12000);
+	assert(pacer.BeginFrame(16000));
+	assert(pacer.EndFrame(20000) == 12000);
+	assert(pacer.GetSkippedFrames() == 0);
+}
+
+static void FrameSkip() {
+	FramePacer pacer(interval, 2, 100);
+	pacer.Reset(0);
+
+	// Every frame takes 20 ms, the logic falls behind and frames are
+	// skipped, but never more than max_frameskip in a row
+	int64_t now = 0;
+	int skips = 0;
+	for (int i = 0; i < 20; ++i) {
+		if (pacer.BeginFrame(now)) {
+			skips = 0;
+		} else {
+			++skips;
+			assert(skips <= 2);
+		}
+		now += 20000;
+		assert(pacer.EndFrame(now) == 0);
+	}
+	assert(pacer.GetSkippedFrames() > 0);
+}
+
+static void CatchUp() {
+	FramePacer pacer(interval, 5, 4);
+	pacer.Reset(0);
+
+	// A long stall drops the backlog, afterwards the schedule is on time
+	assert(pacer.BeginFrame(0));
+	assert(pacer.EndFrame(1000000) == 0);
+	assert(pacer.BeginFrame(1000000));
+	assert(pacer.EndFrame(1004000) == 12000);
+	assert(pacer.GetSkippedFrames() == 0);
+}
+
+static void Vsync() {
+	FramePacer pacer(interval, 5, 10);
+	pacer.SetVsync(true);
+	pacer.Reset(0);
+
+	// Presenting waits, no sleep and slightly late frames are rendered
+	assert(pacer.BeginFrame(0));
+	assert(pacer.EndFrame(4000) == 0);
+	assert(pacer.BeginFrame(17000));
+	assert(pacer.EndFrame(33500) == 0);
+	assert(pacer.BeginFrame(33500));
+	assert(pacer.GetSkippedFrames() == 0);
+}
+
+extern "C" int main(int, char**) {
+	OnTime();
+	FrameSkip();
+	CatchUp();
+	Vsync();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include "scratch_arena.h"
+
+static void Fallback() {
+	// Without Init the heap is used
+	assert(!ScratchArena::IsAvailable());
+
+	ScratchArena::Buffer<int> buffer(16, 7);
+	assert(buffer.size() == 16);
+	assert(buffer[0] == 7 && buffer[15] == 7);
+}
+
+static void Nested() {
+	ScratchArena::Init();
+	assert(ScratchArena::IsAvailable());
+
+	uint8_t* first;
+	{
+		ScratchArena::Buffer<uint8_t> outer(3, 1);
+		ScratchArena::Buffer<uint32_t> inner(5, 2);
+		first = outer.data();
+		assert(reinterpret_cast<uintptr_t>(inner.data()) % 16 == 0);
+		assert(static_cast<void*>(inner.data()) != static_cast<void*>(outer.data()));
+		assert(outer[2] == 1 && inner[4] == 2);
+	}
+
+	// Released buffers are reused
+	ScratchArena::Buffer<uint8_t> again(3);
+	assert(again.data() == first);
+
+	ScratchArena::Quit();
+}
+
+static void Reset() {
+	ScratchArena::Init();
+
+	// Allocations beyond the first chunk still work and are kept until Reset
+	void* small = ScratchArena::Allocate(64);
+	void* large = ScratchArena::Allocate(1024 * 1024);
+	assert(small != large);
+	ScratchArena::Reset();
+
+	// Afterwards both fit into one chunk
+	void* a = ScratchArena::Allocate(64);
+	void* b = ScratchArena::Allocate(1024 * 1024);
+	assert(static_cast<uint8_t*>(b) == static_cast<uint8_t*>(a) + 64);
+
+	ScratchArena::Quit();
+}
+
+extern "C" int main(int, char**) {
+	Fallback();
+	Nested();
+	Reset();
+
+	return EXIT_SUCCESS;
+}